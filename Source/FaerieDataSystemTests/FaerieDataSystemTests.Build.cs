@@ -23,8 +23,11 @@ public class FaerieDataSystemTests : ModuleRules
             {
                 "CoreUObject",
                 "Engine",
+                "FaerieItemGenerator",
                 "GameplayTags"
             }
         );
+
+        SetupIrisSupport(Target);
     }
 }
\ No newline at end of file
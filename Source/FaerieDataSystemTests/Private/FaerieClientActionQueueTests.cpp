@@ -0,0 +1,134 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieItem.h"
+#include "FaerieItemStorage.h"
+#include "Actions/FaerieInventoryClient.h"
+#include "Actions/FaerieClientActionBase.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeExit.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieClientActionQueueTests, "FDS.FaerieClientActionQueueTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+namespace Faerie::Tests::ActionQueue
+{
+	// Client actions are not exported, so the tests make them by reflection.
+	TInstancedStruct<FFaerieClientActionBase> MakeMoveEntry(UFaerieItemStorage* From, UFaerieItemStorage* To, const FFaerieAddress Address)
+	{
+		const UScriptStruct* MoveStruct = FindObject<UScriptStruct>(nullptr, TEXT("/Script/FaerieInventory.FaerieClientAction_RequestMoveEntry"));
+		check(MoveStruct);
+
+		TInstancedStruct<FFaerieClientActionBase> Action;
+		Action.InitializeAsScriptStruct(MoveStruct);
+		void* Memory = Action.GetMutablePtr();
+		*MoveStruct->FindPropertyByName(TEXT("Storage"))->ContainerPtrToValuePtr<TObjectPtr<UFaerieItemStorage>>(Memory) = From;
+		*MoveStruct->FindPropertyByName(TEXT("ToStorage"))->ContainerPtrToValuePtr<TObjectPtr<UFaerieItemStorage>>(Memory) = To;
+		*MoveStruct->FindPropertyByName(TEXT("Address"))->ContainerPtrToValuePtr<FFaerieAddress>(Memory) = Address;
+		return Action;
+	}
+
+	// Call the Blueprint entry point the way Blueprints do, as it is protected.
+	void RequestAction(UFaerieInventoryClient* Client, const TInstancedStruct<FFaerieClientActionBase>& Action)
+	{
+		TInstancedStruct<FFaerieClientActionBase> Params = Action;
+		Client->ProcessEvent(Client->FindFunctionChecked(TEXT("RequestExecuteAction")), &Params);
+	}
+}
+
+bool FaerieClientActionQueueTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests::ActionQueue;
+
+	IConsoleVariable* CoalesceActions = IConsoleManager::Get().FindConsoleVariable(TEXT("fae.Client.CoalesceActions"));
+	IConsoleVariable* MaxActionsPerBatch = IConsoleManager::Get().FindConsoleVariable(TEXT("fae.Client.MaxActionsPerBatch"));
+	if (!TestNotNull("CoalesceActions cvar", CoalesceActions) ||
+		!TestNotNull("MaxActionsPerBatch cvar", MaxActionsPerBatch))
+	{
+		return false;
+	}
+
+	const bool PreviousCoalesce = CoalesceActions->GetBool();
+	const int32 PreviousBatchSize = MaxActionsPerBatch->GetInt();
+	CoalesceActions->Set(true);
+	MaxActionsPerBatch->Set(2);
+
+	// A world is needed for the queue, but it is never ticked, so actions only leave it when flushed here.
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	ON_SCOPE_EXIT
+	{
+		World->DestroyWorld(false);
+		CoalesceActions->Set(PreviousCoalesce);
+		MaxActionsPerBatch->Set(PreviousBatchSize);
+	};
+
+	// Requests from an actor without authority are queued. In a standalone world, the RPCs then run locally.
+	AActor* ClientActor = World->SpawnActor<AActor>();
+	ClientActor->SetRole(ROLE_SimulatedProxy);
+	UFaerieInventoryClient* Client = NewObject<UFaerieInventoryClient>(ClientActor);
+
+	UFaerieItemStorage* From = NewObject<UFaerieItemStorage>(ClientActor);
+	UFaerieItemStorage* To = NewObject<UFaerieItemStorage>(ClientActor);
+
+	constexpr int32 ItemCount = 5;
+	TArray<const UFaerieItem*> Items;
+	for (int32 i = 0; i < ItemCount; ++i)
+	{
+		// Mutable items never stack, so each add makes its own entry.
+		const UFaerieItem* Item = UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable);
+		From->AddEntryFromItemObject(Item, EFaerieStorageAddStackBehavior::AddToAnyStack);
+		Items.Add(Item);
+	}
+
+	TArray<FFaerieAddress> Addresses;
+	From->GetAllAddresses(Addresses);
+	if (!TestEqual("Address count", Addresses.Num(), ItemCount))
+	{
+		return false;
+	}
+
+	// Moved entries get increasing keys in the target storage, so its key order is the order the moves ran in.
+	const TArray<int32> Order = { 4, 2, 0, 3, 1 };
+	for (const int32 Index : Order)
+	{
+		RequestAction(Client, MakeMoveEntry(From, To, Addresses[Index]));
+	}
+
+	TestEqual("Nothing runs until flushed", To->GetEntryCount(), 0);
+
+	TestEqual("Queue is split by fae.Client.MaxActionsPerBatch", Client->FlushQueuedActions(), 3);
+	TestEqual("Flushing an empty queue sends nothing", Client->FlushQueuedActions(), 0);
+
+	TestEqual("All moves ran", To->GetEntryCount(), ItemCount);
+	TestEqual("Source emptied", From->GetEntryCount(), 0);
+
+	TArray<FEntryKey> Keys;
+	To->GetAllKeys(Keys);
+	if (TestEqual("Target key count", Keys.Num(), ItemCount))
+	{
+		for (int32 i = 0; i < Keys.Num(); ++i)
+		{
+			TestTrue(*FString::Printf(TEXT("Move %d ran in request order"), i), To->ViewItem(Keys[i]) == Items[Order[i]]);
+		}
+	}
+
+	// A queue that fits in one batch is sent in one RPC.
+	{
+		TArray<FFaerieAddress> Moved;
+		To->GetAllAddresses(Moved);
+		for (int32 i = 0; i < 2; ++i)
+		{
+			RequestAction(Client, MakeMoveEntry(To, From, Moved[i]));
+		}
+
+		TestEqual("Queue within the batch size is sent once", Client->FlushQueuedActions(), 1);
+		TestEqual("Both moves ran", From->GetEntryCount(), 2);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,141 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieItem.h"
+#include "FaerieItemEditHandle.h"
+#include "FaerieItemToken.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeExit.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieCopyOnWriteTokenTests, "FDS.FaerieCopyOnWriteTokenTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+namespace Faerie::Tests::CopyOnWrite
+{
+	// The uses token is the only one that allows copy-on-write, and lives in a module this one does not depend on, so the
+	// tests reach it by reflection.
+	UClass* GetUsesTokenClass()
+	{
+		return FindObject<UClass>(nullptr, TEXT("/Script/FaerieItemGenerator.FaerieItemUsesToken"));
+	}
+
+	int32& UsesRemaining(const UFaerieItemToken* Token)
+	{
+		return *GetUsesTokenClass()->FindPropertyByName(TEXT("UsesRemaining"))->ContainerPtrToValuePtr<int32>(const_cast<UFaerieItemToken*>(Token));
+	}
+
+	// A static template item, like one compiled into an asset, holding a uses token.
+	UFaerieItem* MakeStaticTemplate(const bool StableName)
+	{
+		UFaerieItemToken* Token = NewObject<UFaerieItemToken>(GetTransientPackage(), GetUsesTokenClass());
+		UsesRemaining(Token) = 5;
+
+		// Tokens loaded from a package have stable names, which is required to share them.
+		if (StableName)
+		{
+			Token->SetFlags(RF_WasLoaded);
+		}
+
+		UFaerieItem* Template = UFaerieItem::CreateNewInstance({ Token });
+		EFaerieItemMutabilityFlags& Flags = *UFaerieItem::StaticClass()->FindPropertyByName(TEXT("MutabilityFlags"))->ContainerPtrToValuePtr<EFaerieItemMutabilityFlags>(Template);
+		EnumRemoveFlags(Flags, EFaerieItemMutabilityFlags::InstanceMutability);
+		return Template;
+	}
+}
+
+bool FaerieCopyOnWriteTokenTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests::CopyOnWrite;
+
+	UClass* UsesClass = GetUsesTokenClass();
+	if (!TestNotNull("Uses token class", UsesClass))
+	{
+		return false;
+	}
+
+	IConsoleVariable* CVar = IConsoleManager::Get().FindConsoleVariable(TEXT("fae.Item.CopyOnWriteTokens"));
+	if (!TestNotNull("Copy-on-write cvar", CVar))
+	{
+		return false;
+	}
+	const bool CVarBefore = CVar->GetBool();
+	CVar->Set(true);
+	ON_SCOPE_EXIT { CVar->Set(CVarBefore); };
+
+	UFaerieItem* Template = MakeStaticTemplate(true);
+	const UFaerieItemToken* TemplateToken = Template->GetOwnedTokens()[0];
+	TestFalse("Template is static", Template->IsInstanceMutable());
+	TestNull("Tokens of a static item cannot be edited in place", TemplateToken->MutateCast());
+
+	// Duplicates share the template's token until they are mutated.
+	{
+		UFaerieItem* Duplicate = Template->CreateDuplicate();
+		TestTrue("Duplicate can mutate", Duplicate->CanMutate());
+		TestTrue("Duplicate shares the token", Duplicate->GetOwnedTokens()[0] == TemplateToken);
+		TestTrue("Const lookup returns the shared token", Duplicate->GetToken(UsesClass) == TemplateToken);
+
+		int32 TokenAdds = 0;
+		Duplicate->GetNotifyOwnerOfSelfMutation().BindLambda(
+			[&TokenAdds](TNotNull<const UFaerieItem*>, TNotNull<const UFaerieItemToken*>, const FGameplayTag Tag)
+			{
+				if (Tag == Faerie::Token::Tags::TokenAdd)
+				{
+					TokenAdds++;
+				}
+			});
+
+		UFaerieItemToken* Materialized = Duplicate->GetMutableToken(UsesClass);
+		if (TestNotNull("Mutable access materializes the token", Materialized))
+		{
+			TestTrue("Materialized token is a copy", Materialized != TemplateToken);
+			TestTrue("Materialized token is owned by the duplicate", Materialized->GetOuter() == Duplicate);
+			TestTrue("Materialized token replaces the shared one", Duplicate->GetOwnedTokens()[0] == Materialized);
+			TestEqual("Materialized token keeps the template's data", UsesRemaining(Materialized), 5);
+			TestNotNull("Materialized token can be edited", Materialized->MutateCast());
+			TestEqual("Owner is told about the new token", TokenAdds, 1);
+
+			UsesRemaining(Materialized) = 2;
+			TestEqual("Editing the copy leaves the template alone", UsesRemaining(TemplateToken), 5);
+		}
+
+		TestTrue("Materializing again is a no-op", Duplicate->GetMutableToken(UsesClass) == Materialized);
+		TestEqual("Owner is only told once", TokenAdds, 1);
+	}
+
+	// Other duplicates keep sharing, and edit handles materialize too.
+	{
+		UFaerieItem* Duplicate = Template->CreateDuplicate();
+		TestTrue("Second duplicate still shares the token", Duplicate->GetOwnedTokens()[0] == TemplateToken);
+
+		const FFaerieItemEditHandle Handle(Duplicate);
+		TestTrue("Edit handle materializes the token", Duplicate->GetOwnedTokens()[0] != TemplateToken);
+		TestTrue("Edit handle token is owned by the duplicate", Duplicate->GetOwnedTokens()[0]->GetOuter() == Duplicate);
+	}
+
+	// Tokens whose names are not stable for networking are copied eagerly.
+	{
+		UFaerieItem* UnstableTemplate = MakeStaticTemplate(false);
+		const UFaerieItem* Duplicate = UnstableTemplate->CreateDuplicate();
+		TestTrue("Unstable token is copied eagerly", Duplicate->GetOwnedTokens()[0]->GetOuter() == Duplicate);
+	}
+
+	// Duplicates of instances never share tokens, since their tokens may be edited.
+	{
+		UFaerieItem* Instance = Template->CreateDuplicate();
+		(void)Instance->GetMutableToken(UsesClass);
+		const UFaerieItem* Duplicate = Instance->CreateDuplicate();
+		TestTrue("Duplicate of an instance owns its token", Duplicate->GetOwnedTokens()[0]->GetOuter() == Duplicate);
+	}
+
+	// Copy-on-write can be disabled.
+	{
+		CVar->Set(false);
+		const UFaerieItem* Duplicate = Template->CreateDuplicate();
+		TestTrue("Disabled copy-on-write copies eagerly", Duplicate->GetOwnedTokens()[0]->GetOuter() == Duplicate);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,197 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "BinarySearchOptimizedArray.h"
+#include "FaerieItemContainerStructs.h"
+#include "Math/RandomStream.h"
+
+namespace Faerie::Tests
+{
+	struct FKeyedTestElement
+	{
+		FEntryKey Key;
+		int32 Payload = 0;
+	};
+
+	// Array that always looks up keys with binary search.
+	struct FBinarySearchTestArray : TBinarySearchOptimizedArray<FBinarySearchTestArray, FKeyedTestElement>
+	{
+		TArray<FKeyedTestElement> Elements;
+		TArray<FKeyedTestElement>& GetArray() { return Elements; }
+	};
+
+	// Array that looks up keys with a dense key table.
+	struct FKeyTableTestArray : TBinarySearchOptimizedArray<FKeyTableTestArray, FKeyedTestElement>
+	{
+		TArray<FKeyedTestElement> Elements;
+		mutable FDenseKeyTable KeyTable;
+		TArray<FKeyedTestElement>& GetArray() { return Elements; }
+		FDenseKeyTable& GetDenseKeyTable() const { return KeyTable; }
+	};
+
+	static_assert(!CDenseKeyTableArray<FBinarySearchTestArray>);
+	static_assert(CDenseKeyTableArray<FKeyTableTestArray>);
+
+	// Fill an array with sequential keys, leaving a gap every so often, like an inventory that has had items removed.
+	template <typename TArrayType>
+	void FillTestArray(TArrayType& Array, const int32 Num, const int32 GapEvery)
+	{
+		int32 KeyValue = 100;
+		for (int32 i = 0; i < Num; ++i)
+		{
+			if (++KeyValue % GapEvery == 0)
+			{
+				++KeyValue;
+			}
+			Array.Insert({ FEntryKey(KeyValue), i });
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieDenseKeyTableTests, "FDS.FaerieDenseKeyTableTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieDenseKeyTableTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests;
+
+	FBinarySearchTestArray Expected;
+	FKeyTableTestArray Actual;
+	FillTestArray(Expected, 1000, 10);
+	FillTestArray(Actual, 1000, 10);
+
+	auto CompareAll = [&](const TCHAR* What)
+	{
+		const int32 MaxKey = Expected.Elements.Last().Key.Value() + 10;
+		for (int32 KeyValue = 90; KeyValue < MaxKey; ++KeyValue)
+		{
+			const FEntryKey Key(KeyValue);
+			if (Expected.IndexOf(Key) != Actual.IndexOf(Key))
+			{
+				AddError(FString::Printf(TEXT("%s: Index mismatch for key %i"), What, KeyValue));
+				return;
+			}
+		}
+	};
+
+	CompareAll(TEXT("AfterFill"));
+
+	// Remove from the front, middle and back, which shifts indices and forces the table to rebase.
+	for (const int32 KeyValue : { 101, 102, 500, 501, 502, Expected.Elements.Last().Key.Value() })
+	{
+		Expected.Remove(FEntryKey(KeyValue));
+		Actual.Remove(FEntryKey(KeyValue));
+	}
+	TestTrue("Table patched on remove", Actual.KeyTable.IsValidFor(Actual.Elements.Num()));
+	CompareAll(TEXT("AfterRemove"));
+
+	// Append new keys past the end.
+	for (int32 i = 0; i < 50; ++i)
+	{
+		const FEntryKey Key(Expected.Elements.Last().Key.Value() + 1);
+		Expected.Insert({ Key, i });
+		Actual.Insert({ Key, i });
+	}
+	CompareAll(TEXT("AfterAppend"));
+
+	TestTrue("Table is in use", Actual.KeyTable.IsUsable());
+
+	// Edit the array directly, without telling the table. The change in element count should trigger a rebuild.
+	Actual.Elements.RemoveAt(0);
+	Expected.Elements.RemoveAt(0);
+	CompareAll(TEXT("AfterUntrackedEdit"));
+
+	// Rekey the last element without changing the element count. The table cannot notice this, and must not report
+	// the new key as missing.
+	const FEntryKey RekeyedKey(Actual.Elements.Last().Key.Value() + 5);
+	Actual.Elements.Last().Key = RekeyedKey;
+	Expected.Elements.Last().Key = RekeyedKey;
+	TestEqual("Stale table miss falls back", Actual.IndexOf(RekeyedKey), Actual.Elements.Num() - 1);
+	CompareAll(TEXT("AfterRekey"));
+
+	// Very sparse keys should disable the table, and fall back to binary search.
+	FKeyTableTestArray Sparse;
+	for (int32 i = 0; i < 10; ++i)
+	{
+		Sparse.Insert({ FEntryKey(100 + i * 1000), i });
+	}
+	TestTrue("Sparse lookup", Sparse.IndexOf(FEntryKey(5100)) == 5);
+	TestFalse("Sparse table disabled", Sparse.KeyTable.IsUsable());
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieDenseKeyTableBenchmark, "FDS.Perf.FaerieDenseKeyTableBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FaerieDenseKeyTableBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests;
+
+	static constexpr int32 NumLookups = 1000000;
+
+	for (const int32 NumEntries : { 1000, 10000, 100000 })
+	{
+		FBinarySearchTestArray BinarySearchArray;
+		FKeyTableTestArray KeyTableArray;
+		FillTestArray(BinarySearchArray, NumEntries, 10);
+		FillTestArray(KeyTableArray, NumEntries, 10);
+
+		// Split the lookups into hits and misses, so that each search path is timed on its own. A key table miss
+		// falls back to binary search, so misses are expected to cost about the same for both.
+		FRandomStream Stream(NumEntries);
+		TArray<FEntryKey> Hits;
+		TArray<FEntryKey> Misses;
+		Hits.Reserve(NumLookups);
+		Misses.Reserve(NumLookups);
+		for (int32 i = 0; i < NumLookups; ++i)
+		{
+			Hits.Add(BinarySearchArray.Elements[Stream.RandHelper(NumEntries)].Key);
+			Misses.Add(FEntryKey(BinarySearchArray.Elements[Stream.RandHelper(NumEntries)].Key.Value() + 1));
+		}
+		Misses.RemoveAll([&](const FEntryKey Key) { return BinarySearchArray.IndexOf_BinarySearch(Key) != INDEX_NONE; });
+
+		// Build the table outside the timed sections.
+		(void)KeyTableArray.IndexOf(Hits[0]);
+
+		auto TimeLookups = [](const TArray<FEntryKey>& Keys, auto&& Lookup, int64& OutSum)
+		{
+			OutSum = 0;
+			const double Start = FPlatformTime::Seconds();
+			for (const FEntryKey Key : Keys)
+			{
+				OutSum += Lookup(Key);
+			}
+			return FPlatformTime::Seconds() - Start;
+		};
+
+		auto BinarySearch = [&](const FEntryKey Key) { return BinarySearchArray.IndexOf_BinarySearch(Key); };
+		auto KeyTable = [&](const FEntryKey Key) { return KeyTableArray.IndexOf(Key); };
+
+		struct FLookupSet
+		{
+			const TCHAR* Name;
+			const TArray<FEntryKey>* Keys;
+		};
+
+		for (const FLookupSet& Set : { FLookupSet{ TEXT("Hits"), &Hits }, FLookupSet{ TEXT("Misses"), &Misses } })
+		{
+			int64 BinarySearchSum, KeyTableSum;
+			const double BinarySearchTime = TimeLookups(*Set.Keys, BinarySearch, BinarySearchSum);
+			const double KeyTableTime = TimeLookups(*Set.Keys, KeyTable, KeyTableSum);
+
+			TestEqual(FString::Printf(TEXT("%s match (%i entries)"), Set.Name, NumEntries), KeyTableSum, BinarySearchSum);
+
+			AddInfo(FString::Printf(TEXT("%i entries, %i %s: BinarySearch %.3f ms, KeyTable %.3f ms (%.2fx)"),
+				NumEntries, Set.Keys->Num(), Set.Name, BinarySearchTime * 1000.0, KeyTableTime * 1000.0,
+				KeyTableTime > 0.0 ? BinarySearchTime / KeyTableTime : 0.0));
+		}
+
+		AddInfo(FString::Printf(TEXT("%i entries: KeyTable memory %llu bytes"),
+			NumEntries, static_cast<uint64>(KeyTableArray.KeyTable.GetAllocatedSize())));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,137 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieItem.h"
+#include "FaerieItemDataFilter.h"
+#include "FaerieItemDataFilterMemo.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeExit.h"
+#include "Tokens/FaerieInfoToken.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieFilterMemoTests, "FDS.FaerieFilterMemoTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+namespace Faerie::Tests::FilterMemo
+{
+	// The basic filter rules are not exported, so they are made by class name, and configured through reflection.
+	UFaerieItemDataFilter* MakeHasInfoFilter()
+	{
+		UClass* Class = FindObject<UClass>(nullptr, TEXT("/Script/FaerieInventoryContent.FilterRule_HasTokens"));
+		check(Class);
+		UFaerieItemDataFilter* Filter = NewObject<UFaerieItemDataFilter>(GetTransientPackage(), Class);
+		*FindFProperty<FProperty>(Class, TEXT("TokenClasses"))->ContainerPtrToValuePtr<TArray<TSubclassOf<UFaerieItemToken>>>(Filter) = { UFaerieInfoToken::StaticClass() };
+		*FindFProperty<FProperty>(Class, TEXT("IncludeDefaultReferences"))->ContainerPtrToValuePtr<bool>(Filter) = false;
+		return Filter;
+	}
+
+	UFaerieItemToken* MakeInfo()
+	{
+		return UFaerieInfoToken::CreateInstance(FFaerieAssetInfo());
+	}
+}
+
+bool FaerieFilterMemoTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests::FilterMemo;
+
+	const UFaerieItemDataFilter* Filter = MakeHasInfoFilter();
+	const UFaerieItemDataFilter* OtherFilter = MakeHasInfoFilter();
+
+	Faerie::ItemData::FFilterMemo Memo;
+	int32 Evals = 0;
+
+	// Runs the filter through the memo, counting how often it actually runs.
+	auto Exec = [&Memo, &Evals](const UFaerieItemDataFilter* InFilter, const FFaerieItemStackView& View)
+		{
+			return Memo.Exec(InFilter, View,
+				[InFilter, &View, &Evals]
+				{
+					Evals++;
+					return InFilter->Exec(View);
+				});
+		};
+
+	// Results for an unchanged item are remembered.
+	UFaerieItem* Immutable = UFaerieItem::CreateNewInstance({ MakeInfo() });
+	{
+		const FFaerieItemStackView View(Immutable, 1);
+		TestTrue("First run passes", Exec(Filter, View));
+		TestTrue("Second run passes", Exec(Filter, View));
+		TestEqual("Filter only runs once", Evals, 1);
+		TestEqual("Hits", Memo.GetHits(), 1ull);
+		TestEqual("Misses", Memo.GetMisses(), 1ull);
+	}
+
+	// Results are kept apart by filter, and by copies.
+	{
+		Evals = 0;
+		TestTrue("Other filter passes", Exec(OtherFilter, FFaerieItemStackView(Immutable, 1)));
+		TestTrue("Other copies pass", Exec(Filter, FFaerieItemStackView(Immutable, 2)));
+		TestEqual("Each new key runs the filter", Evals, 2);
+		TestEqual("One result per key", Memo.Num(), 3);
+	}
+
+	// Editing an item invalidates its results.
+	{
+		UFaerieItem* Mutable = UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable);
+		const FFaerieItemStackView View(Mutable, 1);
+
+		Evals = 0;
+		TestFalse("Fails without an info token", Exec(Filter, View));
+		TestFalse("Remembered failure", Exec(Filter, View));
+		TestEqual("Unedited item runs once", Evals, 1);
+
+		const int32 NumBefore = Memo.Num();
+		TestTrue("Add info token", Mutable->AddToken(MakeInfo()));
+		TestTrue("Edited item is run again", Exec(Filter, View));
+		TestEqual("Edit caused a new run", Evals, 2);
+		TestEqual("Stale result is replaced, not added", Memo.Num(), NumBefore);
+		TestTrue("New result is remembered", Exec(Filter, View));
+		TestEqual("No run after the new result", Evals, 2);
+	}
+
+	// Invalid items are never remembered.
+	{
+		Evals = 0;
+		const int32 NumBefore = Memo.Num();
+		for (int32 i = 0; i < 2; ++i)
+		{
+			Memo.Exec(Filter, FFaerieItemStackView(), [&Evals] { Evals++; return false; });
+		}
+		TestEqual("Invalid item is run every time", Evals, 2);
+		TestEqual("Invalid item is not remembered", Memo.Num(), NumBefore);
+	}
+
+	// Reset forgets everything.
+	{
+		Memo.Reset();
+		TestEqual("Reset empties the memo", Memo.Num(), 0);
+
+		Evals = 0;
+		Exec(Filter, FFaerieItemStackView(Immutable, 1));
+		TestEqual("Reset results are run again", Evals, 1);
+	}
+
+	// Memory is bounded, by flushing a full memo.
+	{
+		IConsoleVariable* CVar = IConsoleManager::Get().FindConsoleVariable(TEXT("fae.Filter.MemoCapacity"));
+		if (TestNotNull("Capacity cvar", CVar))
+		{
+			const int32 CapacityBefore = CVar->GetInt();
+			CVar->Set(4);
+			ON_SCOPE_EXIT { CVar->Set(CapacityBefore); };
+
+			Memo.Reset();
+			for (int32 Copies = 1; Copies <= 10; ++Copies)
+			{
+				Exec(Filter, FFaerieItemStackView(Immutable, Copies));
+				TestTrue(*FString::Printf(TEXT("Memo within capacity after %d results"), Copies), Memo.Num() <= 4);
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif
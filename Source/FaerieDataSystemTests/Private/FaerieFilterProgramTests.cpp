@@ -0,0 +1,182 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieItem.h"
+#include "FaerieItemDataFilter.h"
+#include "FaerieItemDataFilterProgram.h"
+#include "Tokens/FaerieInfoToken.h"
+#include "UObject/Package.h"
+
+namespace Faerie::Tests
+{
+	// The basic filter rules are not exported, so they are made by class name, and configured through reflection.
+	class FFilterBuilder
+	{
+	public:
+		explicit FFilterBuilder(UObject* Outer)
+		  : Outer(Outer) {}
+
+		UFaerieItemDataFilter* Make(const TCHAR* ClassName) const
+		{
+			UClass* Class = FindObject<UClass>(nullptr, *FString::Printf(TEXT("/Script/FaerieInventoryContent.%s"), ClassName));
+			check(Class);
+			return NewObject<UFaerieItemDataFilter>(Outer, Class);
+		}
+
+		template <typename T>
+		static void Set(UFaerieItemDataFilter* Filter, const TCHAR* PropertyName, const T& Value)
+		{
+			const FProperty* Property = FindFProperty<FProperty>(Filter->GetClass(), PropertyName);
+			check(Property && Property->GetElementSize() == sizeof(T));
+			*Property->ContainerPtrToValuePtr<T>(Filter) = Value;
+		}
+
+		UFaerieItemDataFilter* Copies(const uint8 Operator, const int32 Amount) const
+		{
+			UFaerieItemDataFilter* Filter = Make(TEXT("FilterRule_Copies"));
+			Set<uint8>(Filter, TEXT("Operator"), Operator);
+			Set<int32>(Filter, TEXT("AmountToCompare"), Amount);
+			return Filter;
+		}
+
+		UFaerieItemDataFilter* Mutability(const bool RequireMutable) const
+		{
+			UFaerieItemDataFilter* Filter = Make(TEXT("FilterRule_Mutability"));
+			Set<bool>(Filter, TEXT("RequireMutable"), RequireMutable);
+			return Filter;
+		}
+
+		UFaerieItemDataFilter* HasInfo() const
+		{
+			UFaerieItemDataFilter* Filter = Make(TEXT("FilterRule_HasTokens"));
+			Set<TArray<TSubclassOf<UFaerieItemToken>>>(Filter, TEXT("TokenClasses"), { UFaerieInfoToken::StaticClass() });
+			Set<bool>(Filter, TEXT("IncludeDefaultReferences"), false);
+			return Filter;
+		}
+
+		UFaerieItemDataFilter* Junction(const TCHAR* ClassName, const TArray<TObjectPtr<UFaerieItemDataFilter>>& Rules) const
+		{
+			UFaerieItemDataFilter* Filter = Make(ClassName);
+			Set<TArray<TObjectPtr<UFaerieItemDataFilter>>>(Filter, TEXT("Rules"), Rules);
+			return Filter;
+		}
+
+		UFaerieItemDataFilter* Not(UFaerieItemDataFilter* Rule) const
+		{
+			UFaerieItemDataFilter* Filter = Make(TEXT("FilterRule_LogicalNot"));
+			Set<TObjectPtr<UFaerieItemDataFilter>>(Filter, TEXT("InvertedRule"), Rule);
+			return Filter;
+		}
+
+		UFaerieItemDataFilter* Condition(UFaerieItemDataFilter* Rule, UFaerieItemDataFilter* TrueBranch, const bool FalseBranch) const
+		{
+			UFaerieItemDataFilter* Filter = Make(TEXT("FilterRule_Condition"));
+			Set<TObjectPtr<UFaerieItemDataFilter>>(Filter, TEXT("ConditionRule"), Rule);
+			Set<TObjectPtr<UFaerieItemDataFilter>>(Filter, TEXT("TrueBranch"), TrueBranch);
+			Set<bool>(Filter, TEXT("FalseBranch"), FalseBranch);
+			return Filter;
+		}
+
+		UFaerieItemDataFilter* Ternary(UFaerieItemDataFilter* Rule, UFaerieItemDataFilter* TrueBranch, UFaerieItemDataFilter* FalseBranch) const
+		{
+			UFaerieItemDataFilter* Filter = Make(TEXT("FilterRule_Ternary"));
+			Set<TObjectPtr<UFaerieItemDataFilter>>(Filter, TEXT("ConditionRule"), Rule);
+			Set<TObjectPtr<UFaerieItemDataFilter>>(Filter, TEXT("TrueBranch"), TrueBranch);
+			Set<TObjectPtr<UFaerieItemDataFilter>>(Filter, TEXT("FalseBranch"), FalseBranch);
+			return Filter;
+		}
+
+	private:
+		UObject* Outer;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieFilterProgramTests, "FDS.FaerieFilterProgramTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieFilterProgramTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests;
+	using namespace Faerie::ItemData;
+
+	// Only filters that belong to an asset are compiled, so build them in a package of their own.
+	const FFilterBuilder Asset(CreatePackage(TEXT("/Temp/FaerieFilterProgramTests")));
+
+	// ECopiesCompareOperator values.
+	static constexpr uint8 Less = 0;
+	static constexpr uint8 Greater = 2;
+
+	// And/Or children are listed most expensive first, so that the compiler reorders them.
+	TArray<TPair<FString, UFaerieItemDataFilter*>> Cases;
+	Cases.Emplace(TEXT("Copies"), Asset.Copies(Greater, 2));
+	Cases.Emplace(TEXT("Not"), Asset.Not(Asset.Mutability(true)));
+	Cases.Emplace(TEXT("And"), Asset.Junction(TEXT("FilterRule_LogicalAnd"), { Asset.HasInfo(), Asset.Copies(Greater, 2) }));
+	Cases.Emplace(TEXT("Or"), Asset.Junction(TEXT("FilterRule_LogicalOr"), { Asset.HasInfo(), Asset.Mutability(true), Asset.Copies(Less, 2) }));
+	Cases.Emplace(TEXT("EmptyAnd"), Asset.Junction(TEXT("FilterRule_LogicalAnd"), {}));
+	Cases.Emplace(TEXT("EmptyOr"), Asset.Junction(TEXT("FilterRule_LogicalOr"), {}));
+	Cases.Emplace(TEXT("ConditionFalse"), Asset.Condition(Asset.HasInfo(), Asset.Copies(Greater, 2), false));
+	Cases.Emplace(TEXT("ConditionTrue"), Asset.Condition(Asset.HasInfo(), Asset.Copies(Greater, 2), true));
+	Cases.Emplace(TEXT("Ternary"), Asset.Ternary(Asset.Copies(Less, 3), Asset.HasInfo(), Asset.Not(Asset.HasInfo())));
+
+	// Selects nested inside junctions, so that jumps have to skip over whole branches.
+	Cases.Emplace(TEXT("Nested"), Asset.Junction(TEXT("FilterRule_LogicalOr"), {
+		Asset.Junction(TEXT("FilterRule_LogicalAnd"), {
+			Asset.Ternary(Asset.HasInfo(), Asset.Copies(Greater, 1), Asset.Copies(Less, 2)),
+			Asset.Not(Asset.Condition(Asset.Copies(Greater, 3), Asset.HasInfo(), false)) }),
+		Asset.Condition(Asset.Mutability(false), Asset.Junction(TEXT("FilterRule_LogicalAnd"), { Asset.HasInfo(), Asset.Copies(Greater, 3) }), false) }));
+
+	const FFaerieAssetInfo TestInfo{
+		FText::FromString(TEXT("TestObjectName")),
+		FText::FromString(TEXT("TestObjectShortDescription")),
+		FText::FromString(TEXT("TestObjectLongDescription")),
+		nullptr
+	};
+
+	// Every combination of item data that the rules above look at.
+	TArray<FFaerieItemStackView> Views;
+	for (const EFaerieItemInstancingMutability Mutability : { EFaerieItemInstancingMutability::Mutable, EFaerieItemInstancingMutability::Immutable })
+	{
+		for (const bool WithInfo : { false, true })
+		{
+			TArray<UFaerieItemToken*> Tokens;
+			if (WithInfo)
+			{
+				Tokens.Add(UFaerieInfoToken::CreateInstance(TestInfo));
+			}
+			const UFaerieItem* Item = UFaerieItem::CreateNewInstance(Tokens, Mutability);
+			for (int32 Copies = 1; Copies <= 5; ++Copies)
+			{
+				Views.Emplace(Item, Copies);
+			}
+		}
+	}
+
+	for (const TPair<FString, UFaerieItemDataFilter*>& Case : Cases)
+	{
+		const FFilterProgram Program = FFilterProgram::Compile(Case.Value);
+		if (!TestFalse(*FString::Printf(TEXT("%s compiled"), *Case.Key), Program.IsEmpty()))
+		{
+			continue;
+		}
+
+		for (int32 i = 0; i < Views.Num(); ++i)
+		{
+			if (Program.Exec(Views[i]) != Case.Value->Exec(Views[i]))
+			{
+				AddError(FString::Printf(TEXT("%s: Program does not match Exec for view %i"), *Case.Key, i));
+				break;
+			}
+		}
+	}
+
+	// Filters made at runtime may be edited after compiling, so they must not be compiled.
+	const FFilterBuilder Transient(GetTransientPackage());
+	TestTrue("Runtime filter is not compiled", FFilterProgram::Compile(Transient.Copies(Greater, 2)).IsEmpty());
+	TestTrue("Asset filter with a runtime child is not compiled",
+		FFilterProgram::Compile(Asset.Junction(TEXT("FilterRule_LogicalAnd"), { Asset.HasInfo(), Transient.HasInfo() })).IsEmpty());
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,83 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieHashStatics.h"
+#include "GameplayTagContainer.h"
+#include "HAL/IConsoleManager.h"
+#include "Tokens/FaerieGuidToken.h"
+#include "Tokens/FaerieTagToken.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieHashPlanBenchmark, "FDS.Perf.FaerieHashPlanBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FaerieHashPlanBenchmark::RunTest(const FString& Parameters)
+{
+	static constexpr int32 NumRuns = 100000;
+
+	IConsoleVariable* UsePlansCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("fae.Hash.UsePlans"));
+	if (!TestNotNull("Use plans console variable", UsePlansCVar))
+	{
+		return false;
+	}
+
+	const bool OriginalUsePlans = UsePlansCVar->GetBool();
+
+	const FTransform Transform(FRotator(10.0, 20.0, 30.0), FVector(1.0, 2.0, 3.0), FVector(1.5));
+	const FLinearColor Color(0.1f, 0.2f, 0.3f, 0.4f);
+	const FGuid Guid = FGuid::NewGuid();
+
+	FGameplayTagContainer Tags;
+	Tags.AddTag(FGameplayTag::RequestGameplayTag(TEXT("Fae.Token.PrimaryIdentifier")));
+
+	const UFaerieGuidToken* GuidToken = UFaerieGuidToken::CreateInstance(&Guid);
+	const UFaerieTagToken* TagToken = UFaerieTagToken::CreateInstance(Tags);
+
+	struct FCase
+	{
+		const TCHAR* Name;
+		TFunction<uint32()> Hash;
+	};
+
+	const FCase Cases[] = {
+		{ TEXT("FTransform"), [&] { return Faerie::Hash::HashStructByProps(&Transform, TBaseStructure<FTransform>::Get(), true); } },
+		{ TEXT("FLinearColor"), [&] { return Faerie::Hash::HashStructByProps(&Color, TBaseStructure<FLinearColor>::Get(), true); } },
+		{ TEXT("FGuid"), [&] { return Faerie::Hash::HashStructByProps(&Guid, TBaseStructure<FGuid>::Get(), true); } },
+		{ TEXT("FGameplayTagContainer"), [&] { return Faerie::Hash::HashStructByProps(&Tags, FGameplayTagContainer::StaticStruct(), true); } },
+		{ TEXT("UFaerieGuidToken"), [&] { return Faerie::Hash::HashObjectByProps(GuidToken, true); } },
+		{ TEXT("UFaerieTagToken"), [&] { return Faerie::Hash::HashObjectByProps(TagToken, true); } }
+	};
+
+	for (const FCase& Case : Cases)
+	{
+		auto TimeHash = [&](const bool UsePlans, uint32& OutHash)
+		{
+			UsePlansCVar->Set(UsePlans, ECVF_SetByCode);
+			OutHash = Case.Hash();
+			const double Start = FPlatformTime::Seconds();
+			for (int32 Run = 0; Run < NumRuns; ++Run)
+			{
+				OutHash = Case.Hash();
+			}
+			return (FPlatformTime::Seconds() - Start) / NumRuns;
+		};
+
+		uint32 WalkedHash = 0;
+		uint32 PlannedHash = 0;
+		const double WalkedTime = TimeHash(false, WalkedHash);
+		const double PlannedTime = TimeHash(true, PlannedHash);
+
+		// Plans must never change the value of a hash, as they may have been saved.
+		TestEqual(FString::Printf(TEXT("%s hash is unchanged"), Case.Name), PlannedHash, WalkedHash);
+
+		AddInfo(FString::Printf(TEXT("%s: Walked %.1f ns, Planned %.1f ns (%.2fx)"),
+			Case.Name, WalkedTime * 1e9, PlannedTime * 1e9,
+			PlannedTime > 0.0 ? WalkedTime / PlannedTime : 0.0));
+	}
+
+	UsePlansCVar->Set(OriginalUsePlans, ECVF_SetByCode);
+
+	return true;
+}
+
+#endif
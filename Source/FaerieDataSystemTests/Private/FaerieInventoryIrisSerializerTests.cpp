@@ -0,0 +1,124 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS && UE_WITH_IRIS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieInventoryNetSerializers.h"
+#include "FaerieItemContainerStructs.h"
+#include "InventoryDataStructs.h"
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializationContext.h"
+
+namespace Faerie::Tests
+{
+	// Send a value through an Iris serializer the way a replication system would, but into a local buffer instead of a
+	// connection: quantize, write, read, and dequantize. Returns the number of bits written, or INDEX_NONE on error.
+	template <typename T>
+	int32 IrisLoopback(const UE::Net::FNetSerializer& Serializer, const T& Source, T& OutTarget)
+	{
+		using namespace UE::Net;
+
+		alignas(16) uint8 SentState[64] = {};
+		alignas(16) uint8 ReceivedState[64] = {};
+		alignas(16) uint8 Buffer[64] = {};
+		check(Serializer.QuantizedTypeSize <= sizeof(SentState));
+
+		FNetBitStreamWriter Writer;
+		Writer.InitBytes(Buffer, sizeof(Buffer));
+		FNetSerializationContext WriteContext(&Writer);
+
+		FNetQuantizeArgs QuantizeArgs;
+		QuantizeArgs.NetSerializerConfig = Serializer.DefaultConfig;
+		QuantizeArgs.Source = NetSerializerValuePointer(&Source);
+		QuantizeArgs.Target = NetSerializerValuePointer(SentState);
+		Serializer.Quantize(WriteContext, QuantizeArgs);
+
+		FNetSerializeArgs SerializeArgs;
+		SerializeArgs.NetSerializerConfig = Serializer.DefaultConfig;
+		SerializeArgs.Source = NetSerializerValuePointer(SentState);
+		Serializer.Serialize(WriteContext, SerializeArgs);
+
+		Writer.CommitWrites();
+		if (WriteContext.HasErrorOrOverflow())
+		{
+			return INDEX_NONE;
+		}
+		const uint32 NumBits = Writer.GetPosBits();
+
+		FNetBitStreamReader Reader;
+		Reader.InitBits(Buffer, NumBits);
+		FNetSerializationContext ReadContext(&Reader);
+
+		FNetDeserializeArgs DeserializeArgs;
+		DeserializeArgs.NetSerializerConfig = Serializer.DefaultConfig;
+		DeserializeArgs.Target = NetSerializerValuePointer(ReceivedState);
+		Serializer.Deserialize(ReadContext, DeserializeArgs);
+
+		FNetDequantizeArgs DequantizeArgs;
+		DequantizeArgs.NetSerializerConfig = Serializer.DefaultConfig;
+		DequantizeArgs.Source = NetSerializerValuePointer(ReceivedState);
+		DequantizeArgs.Target = NetSerializerValuePointer(&OutTarget);
+		Serializer.Dequantize(ReadContext, DequantizeArgs);
+
+		if (ReadContext.HasErrorOrOverflow() || Reader.GetPosBits() != NumBits)
+		{
+			return INDEX_NONE;
+		}
+		return static_cast<int32>(NumBits);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieInventoryIrisSerializerTests, "FDS.FaerieInventoryIrisSerializerTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieInventoryIrisSerializerTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie;
+
+	const UE::Net::FNetSerializer& KeySerializer = UE_NET_GET_SERIALIZER(UE::Net::FFaerieItemKeyNetSerializer);
+	const UE::Net::FNetSerializer& StackSerializer = UE_NET_GET_SERIALIZER(UE::Net::FKeyedStackNetSerializer);
+	const UE::Net::FNetSerializer& AddressSerializer = UE_NET_GET_SERIALIZER(UE::Net::FFaerieAddressNetSerializer);
+
+	const int32 FirstKey = Inventory::TKeyGen<FEntryKey>::InitialPosition + 1;
+
+	// Keys, including the invalid key, and ones far from where generators start.
+	for (const int32 KeyValue : { FirstKey, FirstKey + 1000, INDEX_NONE, 0, MAX_int32, MIN_int32 })
+	{
+		const FEntryKey Sent(KeyValue);
+		FEntryKey Received;
+		const int32 Bits = Tests::IrisLoopback(KeySerializer, Sent, Received);
+		TestTrue(FString::Printf(TEXT("Key %i was written"), KeyValue), Bits > 0);
+		TestEqual(FString::Printf(TEXT("Key %i round-trips"), KeyValue), Received.Value(), KeyValue);
+	}
+
+	// The first key made by a generator should cost far less than a full int.
+	{
+		FEntryKey Received;
+		TestTrue(TEXT("First key is packed"), Tests::IrisLoopback(KeySerializer, FEntryKey(FirstKey), Received) < 16);
+	}
+
+	// Stacks, with a negative amount to make sure copies are signed.
+	for (const int32 Copies : { 1, 64, 100000, -3 })
+	{
+		const FKeyedStack Sent{ FStackKey(FirstKey), Copies };
+		FKeyedStack Received;
+		const int32 Bits = Tests::IrisLoopback(StackSerializer, Sent, Received);
+		TestTrue(FString::Printf(TEXT("Stack of %i was written"), Copies), Bits > 0);
+		TestTrue(FString::Printf(TEXT("Stack of %i round-trips"), Copies), Received == Sent);
+	}
+
+	// Addresses, which must keep both halves intact, including a negative stack key in the low half.
+	for (const int32 StackValue : { FirstKey, FirstKey + 7, INDEX_NONE })
+	{
+		FFaerieAddress Sent;
+		Sent.Address = (static_cast<int64>(FirstKey + 2) << 32) | static_cast<uint32>(StackValue);
+		FFaerieAddress Received;
+		const int32 Bits = Tests::IrisLoopback(AddressSerializer, Sent, Received);
+		TestTrue(FString::Printf(TEXT("Address with stack %i was written"), StackValue), Bits > 0);
+		TestEqual(FString::Printf(TEXT("Address with stack %i round-trips"), StackValue), Received.Address, Sent.Address);
+	}
+
+	return true;
+}
+
+#endif
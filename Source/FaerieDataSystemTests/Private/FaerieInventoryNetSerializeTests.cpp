@@ -0,0 +1,175 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "InventoryDataStructs.h"
+#include "Math/RandomStream.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+namespace Faerie::Tests
+{
+	// Make stacks the way an entry does, with keys from a generator, optionally leaving gaps as if stacks were removed.
+	TArray<FKeyedStack> MakeTestStacks(const TConstArrayView<int32> Copies, const int32 GapEvery = 0)
+	{
+		Inventory::TKeyGen<FStackKey> KeyGen;
+		TArray<FKeyedStack> Stacks;
+		for (int32 i = 0; i < Copies.Num(); ++i)
+		{
+			FStackKey Key = KeyGen.NextKey();
+			if (GapEvery > 0 && i % GapEvery == 0)
+			{
+				Key = KeyGen.NextKey();
+			}
+			Stacks.Add({ Key, Copies[i] });
+		}
+		return Stacks;
+	}
+
+	// Write an entry key and its stacks, and return the number of bits written.
+	int64 WriteTestEntry(FBitWriter& Writer, FEntryKey Key, TArray<FKeyedStack>& Stacks)
+	{
+		const int64 Start = Writer.GetNumBits();
+		int32 KeyValue = Key.Value();
+		Inventory::Net::SerializePackedInt(Writer, KeyValue);
+		Inventory::Net::SerializeStacks(Writer, Stacks);
+		return Writer.GetNumBits() - Start;
+	}
+
+	// The cost of the same data with property replication: 32-bit ints, and a 16-bit array count.
+	int64 DefaultEntryBits(const TConstArrayView<FKeyedStack> Stacks)
+	{
+		return 32 + 16 + Stacks.Num() * (32 + 32);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieInventoryEntryNetSerializeTests, "FDS.FaerieInventoryEntryNetSerializeTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieInventoryEntryNetSerializeTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests;
+
+	// Packed ints must survive the whole range, including the negative values used by invalid keys.
+	for (const int32 Value : { 0, 1, -1, 63, 64, -64, 127, 128, 100000, INDEX_NONE, MAX_int32, MIN_int32 })
+	{
+		FBitWriter Writer(0, true);
+		int32 Written = Value;
+		Faerie::Inventory::Net::SerializePackedInt(Writer, Written);
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		int32 Read = 0;
+		Faerie::Inventory::Net::SerializePackedInt(Reader, Read);
+
+		TestFalse(FString::Printf(TEXT("Packed %i has no error"), Value), Reader.IsError());
+		TestEqual(FString::Printf(TEXT("Packed %i round-trips"), Value), Read, Value);
+	}
+
+	struct FCase
+	{
+		const TCHAR* Name;
+		TArray<FKeyedStack> Stacks;
+	};
+
+	TArray<FCase> Cases;
+	Cases.Add({ TEXT("Empty"), {} });
+	Cases.Add({ TEXT("Single"), MakeTestStacks({ 1 }) });
+	Cases.Add({ TEXT("SingleLarge"), MakeTestStacks({ 1000000 }) });
+	Cases.Add({ TEXT("Several"), MakeTestStacks({ 99, 99, 99, 12 }) });
+	Cases.Add({ TEXT("WithGaps"), MakeTestStacks({ 5, 10, 15, 20, 25, 30 }, 2) });
+	Cases.Add({ TEXT("Unordered"), { { FStackKey(150), 3 }, { FStackKey(101), 7 }, { FStackKey(INDEX_NONE), 1 } } });
+
+	for (FCase& Case : Cases)
+	{
+		FBitWriter Writer(0, true);
+		const FEntryKey Key(12345);
+		WriteTestEntry(Writer, Key, Case.Stacks);
+		TestFalse(FString::Printf(TEXT("%s write has no error"), Case.Name), Writer.IsError());
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		int32 ReadKey = 0;
+		Faerie::Inventory::Net::SerializePackedInt(Reader, ReadKey);
+
+		// Start with junk, to check that reading replaces it.
+		TArray<FKeyedStack> ReadStacks = MakeTestStacks({ 1, 2 });
+		const bool Success = Faerie::Inventory::Net::SerializeStacks(Reader, ReadStacks);
+
+		TestTrue(FString::Printf(TEXT("%s read succeeded"), Case.Name), Success);
+		TestEqual(FString::Printf(TEXT("%s entry key round-trips"), Case.Name), ReadKey, Key.Value());
+		TestTrue(FString::Printf(TEXT("%s stacks round-trip"), Case.Name), ReadStacks == Case.Stacks);
+		TestEqual(FString::Printf(TEXT("%s read all bits"), Case.Name), Reader.GetPosBits(), Writer.GetNumBits());
+	}
+
+	// A corrupt array count must fail cleanly, instead of allocating.
+	{
+		FBitWriter Writer(0, true);
+		uint8 SingleStack = 0;
+		Writer.SerializeBits(&SingleStack, 1);
+		uint32 NumStacks = MAX_uint32;
+		Writer.SerializeIntPacked(NumStacks);
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		TArray<FKeyedStack> ReadStacks;
+		TestFalse(TEXT("Corrupt count fails"), Faerie::Inventory::Net::SerializeStacks(Reader, ReadStacks));
+		TestTrue(TEXT("Corrupt count reads nothing"), ReadStacks.IsEmpty());
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieInventoryEntryNetSerializeSize, "FDS.Perf.FaerieInventoryEntryNetSerializeSize", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FaerieInventoryEntryNetSerializeSize::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests;
+
+	static constexpr int32 NumEntries = 10000;
+
+	// A synthetic storage: most entries hold a single stack, some hold several full stacks and a remainder.
+	FRandomStream Random(1234);
+	Faerie::Inventory::TKeyGen<FEntryKey> EntryKeyGen;
+
+	FBitWriter Writer(0, true);
+	int64 PackedBits = 0;
+	int64 DefaultBits = 0;
+
+	for (int32 i = 0; i < NumEntries; ++i)
+	{
+		// Leave gaps, as if entries had been removed.
+		FEntryKey Key = EntryKeyGen.NextKey();
+		if (Random.FRand() < 0.1f)
+		{
+			Key = EntryKeyGen.NextKey();
+		}
+
+		TArray<int32> Copies;
+		if (Random.FRand() < 0.8f)
+		{
+			Copies.Add(Random.RandRange(1, 20));
+		}
+		else
+		{
+			const int32 NumFull = Random.RandRange(1, 5);
+			for (int32 j = 0; j < NumFull; ++j)
+			{
+				Copies.Add(99);
+			}
+			Copies.Add(Random.RandRange(1, 98));
+		}
+
+		TArray<FKeyedStack> Stacks = MakeTestStacks(Copies, Random.RandRange(0, 3));
+		PackedBits += WriteTestEntry(Writer, Key, Stacks);
+		DefaultBits += DefaultEntryBits(Stacks);
+	}
+
+	TestFalse(TEXT("Writer has no error"), Writer.IsError());
+	TestTrue(TEXT("Packed entries are smaller"), PackedBits < DefaultBits);
+
+	AddInfo(FString::Printf(TEXT("%i entries, excluding item references: Default %lld bytes, Packed %lld bytes (%.2fx smaller)"),
+		NumEntries, DefaultBits / 8, PackedBits / 8,
+		PackedBits > 0 ? static_cast<double>(DefaultBits) / PackedBits : 0.0));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,103 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieItem.h"
+#include "FaerieItemInterningSubsystem.h"
+#include "FaerieItemStack.h"
+#include "Engine/World.h"
+#include "Misc/ScopeExit.h"
+#include "Tokens/FaerieInfoToken.h"
+#include "UObject/StrongObjectPtr.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieItemInterningTests, "FDS.FaerieItemInterningTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+namespace Faerie::Tests::Interning
+{
+	UFaerieItem* MakeItem(const TCHAR* Name, const EFaerieItemInstancingMutability Mutability = EFaerieItemInstancingMutability::Automatic)
+	{
+		UFaerieItemToken* Info = UFaerieInfoToken::CreateInstance(FFaerieAssetInfo{ FText::FromString(Name), FText::GetEmpty(), FText::GetEmpty(), nullptr });
+		return UFaerieItem::CreateNewInstance(MakeArrayView(&Info, 1), Mutability);
+	}
+}
+
+bool FaerieItemInterningTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests::Interning;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	ON_SCOPE_EXIT { World->DestroyWorld(false); };
+
+	UFaerieItemInterningSubsystem* Interning = World->GetSubsystem<UFaerieItemInterningSubsystem>();
+	if (!TestNotNull("Interning subsystem", Interning))
+	{
+		return false;
+	}
+
+	// Content-identical immutable items share the first instance interned.
+	const TStrongObjectPtr<UFaerieItem> First(MakeItem(TEXT("Ore")));
+	const TStrongObjectPtr<UFaerieItem> Same(MakeItem(TEXT("Ore")));
+	const TStrongObjectPtr<UFaerieItem> Other(MakeItem(TEXT("Gem")));
+	{
+		TestFalse("Test item is immutable", First->IsDataMutable());
+		TestTrue("First item is interned as itself", Interning->Intern(First.Get()) == First.Get());
+		TestTrue("Interning again returns the same instance", Interning->Intern(First.Get()) == First.Get());
+		TestTrue("Identical item returns the interned instance", Interning->Intern(Same.Get()) == First.Get());
+		TestTrue("Different item is interned as itself", Interning->Intern(Other.Get()) == Other.Get());
+		TestEqual("Interned item count", Interning->GetNumInternedItems(), 2);
+	}
+
+	// Only immutable runtime instances are interned.
+	{
+		const UFaerieItem* MutableA = MakeItem(TEXT("Ore"), EFaerieItemInstancingMutability::Mutable);
+		const UFaerieItem* MutableB = MakeItem(TEXT("Ore"), EFaerieItemInstancingMutability::Mutable);
+		TestTrue("Mutable item is returned as is", Interning->Intern(MutableA) == MutableA);
+		TestTrue("Identical mutable items are not shared", Interning->Intern(MutableB) == MutableB);
+
+		// Static items, such as those in assets, are already shared, and so are left alone.
+		UFaerieItem* Static = MakeItem(TEXT("Ore"));
+		EFaerieItemMutabilityFlags& Flags = *UFaerieItem::StaticClass()->FindPropertyByName(TEXT("MutabilityFlags"))->ContainerPtrToValuePtr<EFaerieItemMutabilityFlags>(Static);
+		EnumRemoveFlags(Flags, EFaerieItemMutabilityFlags::InstanceMutability);
+		TestTrue("Static item is returned as is", Interning->Intern(Static) == Static);
+
+		TestNull("Null is returned as is", Interning->Intern(nullptr));
+		TestEqual("Nothing new was interned", Interning->GetNumInternedItems(), 2);
+	}
+
+	// Stacks are interned, and stacks that end up sharing an item are merged.
+	{
+		TArray<FFaerieItemStack> Stacks;
+		Stacks.Emplace(MakeItem(TEXT("Ore")), 2);
+		Stacks.Emplace(Other.Get(), 1);
+		Stacks.Emplace(MakeItem(TEXT("Ore")), 3);
+		Stacks.Emplace(MakeItem(TEXT("Ore"), EFaerieItemInstancingMutability::Mutable), 1);
+		Interning->InternStacks(Stacks);
+
+		if (TestEqual("Stacks after merge", Stacks.Num(), 3))
+		{
+			TestTrue("Merged stack uses the interned item", Stacks[0].Item == First.Get());
+			TestEqual("Merged stack copies", Stacks[0].Copies, 5);
+			TestTrue("Other stack is kept", Stacks[1].Item == Other.Get());
+			TestTrue("Mutable stack is kept apart", Stacks[2].Item->IsDataMutable());
+		}
+	}
+
+	// Only weak references are held, so collected items are dropped.
+	{
+		const UFaerieItem* Transient = MakeItem(TEXT("Dust"));
+		TestTrue("Transient item is interned", Interning->Intern(Transient) == Transient);
+		TestEqual("Interned item count with transient", Interning->GetNumInternedItems(), 3);
+
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		TestEqual("Collected item is no longer interned", Interning->GetNumInternedItems(), 2);
+
+		const UFaerieItem* Replacement = MakeItem(TEXT("Dust"));
+		TestTrue("Identical item after collection is interned as itself", Interning->Intern(Replacement) == Replacement);
+		TestTrue("Kept items are still interned", Interning->Intern(Same.Get()) == First.Get());
+	}
+
+	return true;
+}
+
+#endif
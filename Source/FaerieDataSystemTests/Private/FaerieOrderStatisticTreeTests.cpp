@@ -0,0 +1,182 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Algo/BinarySearch.h"
+#include "FaerieContainerQuery.h"
+#include "FaerieItemDataComparator.h"
+#include "FaerieItemStorage.h"
+#include "OrderStatisticTree.h"
+#include "Math/RandomStream.h"
+#include "Tokens/FaerieInfoToken.h"
+
+namespace Faerie::Tests
+{
+	// Elements carry an id, so that the order of equal values can be checked.
+	struct FTreeTestElement
+	{
+		int32 Value = 0;
+		int32 Id = 0;
+	};
+
+	// Check that the tree holds exactly Expected, in order, and that rank and select agree for every element.
+	bool TreeMatches(FAutomationTestBase& Test, const TCHAR* What, const TOrderStatisticTree<FTreeTestElement>& Tree,
+					 const TArray<FTreeTestElement>& Expected, const TMap<int32, int32>& Handles)
+	{
+		if (!Test.TestEqual(FString::Printf(TEXT("%s: Num"), What), Tree.Num(), Expected.Num()))
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < Expected.Num(); ++i)
+		{
+			const int32 Handle = Tree.HandleAt(i);
+			if (Tree.Get(Handle).Id != Expected[i].Id ||
+				Tree.IndexOf(Handles[Expected[i].Id]) != i ||
+				Handles[Expected[i].Id] != Handle)
+			{
+				Test.AddError(FString::Printf(TEXT("%s: Mismatch at index %i"), What, i));
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieOrderStatisticTreeTests, "FDS.FaerieOrderStatisticTreeTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieOrderStatisticTreeTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests;
+
+	auto Less = [](const FTreeTestElement& A, const FTreeTestElement& B) { return A.Value < B.Value; };
+
+	TOrderStatisticTree<FTreeTestElement> Tree;
+	TArray<FTreeTestElement> Expected;
+	TMap<int32, int32> Handles;
+
+	TestTrue("Starts empty", Tree.IsEmpty());
+
+	// Insert values with many duplicates. Equal values must land after those already present, like a stable sort.
+	FRandomStream Stream(1234);
+	for (int32 Id = 0; Id < 2000; ++Id)
+	{
+		const FTreeTestElement Element{ Stream.RandRange(0, 99), Id };
+		Handles.Add(Id, Tree.Insert(Element, Less));
+		Expected.Insert(Element, Algo::UpperBoundBy(Expected, Element.Value, &FTreeTestElement::Value));
+	}
+	TreeMatches(*this, TEXT("AfterInsert"), Tree, Expected, Handles);
+
+	// Erase a random half, by handle.
+	for (int32 i = 0; i < 1000; ++i)
+	{
+		const int32 Index = Stream.RandRange(0, Expected.Num() - 1);
+		const int32 Id = Expected[Index].Id;
+		Tree.Remove(Handles.FindAndRemoveChecked(Id));
+		Expected.RemoveAt(Index);
+	}
+	TreeMatches(*this, TEXT("AfterErase"), Tree, Expected, Handles);
+
+	// Erased handles are invalid, and are reused by later inserts.
+	const int32 NumNodesBefore = Tree.Num();
+	for (int32 Id = 2000; Id < 2100; ++Id)
+	{
+		const FTreeTestElement Element{ Stream.RandRange(0, 99), Id };
+		const int32 Handle = Tree.Insert(Element, Less);
+		TestTrue("Reused handle is below the original count", Handle < 2000);
+		Handles.Add(Id, Handle);
+		Expected.Insert(Element, Algo::UpperBoundBy(Expected, Element.Value, &FTreeTestElement::Value));
+	}
+	TestEqual("Num after reinsert", Tree.Num(), NumNodesBefore + 100);
+	TreeMatches(*this, TEXT("AfterReinsert"), Tree, Expected, Handles);
+
+	// Range reads follow select.
+	TArray<int32> RangeIds;
+	Tree.ForEachInRange(10, 20, [&RangeIds](const FTreeTestElement& Element) { RangeIds.Add(Element.Id); });
+	TestEqual("Range length", RangeIds.Num(), 20);
+	for (int32 i = 0; i < RangeIds.Num(); ++i)
+	{
+		TestEqual("Range matches select", RangeIds[i], Tree[10 + i].Id);
+	}
+
+	// Empty the tree entirely.
+	for (const TPair<int32, int32>& Handle : Handles)
+	{
+		Tree.Remove(Handle.Value);
+	}
+	TestTrue("Empty after erasing everything", Tree.IsEmpty());
+
+	// Sorted input is the worst case for an unbalanced tree. A treap should stay within a few times log2(n) high.
+	TOrderStatisticTree<FTreeTestElement> Sorted;
+	static constexpr int32 NumSorted = 16384;
+	for (int32 i = 0; i < NumSorted; ++i)
+	{
+		Sorted.Add({ i, i });
+	}
+	const int32 Height = Sorted.GetHeight();
+	AddInfo(FString::Printf(TEXT("Height after %i sorted appends: %i"), NumSorted, Height));
+	TestTrue("Sorted appends stay balanced", Height <= 4 * FMath::CeilLogTwo(NumSorted));
+	TestEqual("Select after sorted appends", Sorted[NumSorted / 2].Value, NumSorted / 2);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieQuerySortTiesTests, "FDS.FaerieQuerySortTiesTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieQuerySortTiesTests::RunTest(const FString& Parameters)
+{
+	// The basic comparators are not exported, so find the Name comparator by name.
+	UClass* ComparatorClass = FindObject<UClass>(nullptr, TEXT("/Script/FaerieInventoryContent.ComparatorRule_Name"));
+	if (!TestNotNull("Name comparator class", ComparatorClass))
+	{
+		return false;
+	}
+	const UFaerieItemDataComparator* Comparator = NewObject<UFaerieItemDataComparator>(GetTransientPackage(), ComparatorClass);
+
+	// Only some items are named, so most of them tie.
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+	for (int32 i = 0; i < 64; ++i)
+	{
+		UFaerieItem* Item = UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable);
+		if (i % 4 == 0)
+		{
+			Item->AddToken(UFaerieInfoToken::CreateInstance({ FText::FromString(i % 8 == 0 ? TEXT("A") : TEXT("B")), {}, {}, nullptr }));
+		}
+		Storage->AddEntryFromItemObject(Item, EFaerieStorageAddStackBehavior::AddToAnyStack);
+	}
+
+	UFaerieContainerQuery* KeyQuery = NewObject<UFaerieContainerQuery>();
+	KeyQuery->SetSortByObject(Comparator);
+
+	UFaerieContainerQuery* CompareQuery = NewObject<UFaerieContainerQuery>();
+	CompareQuery->SetSort(Faerie::ItemData::FViewComparator::CreateUObject(Comparator, &UFaerieItemDataComparator::Exec), Comparator);
+
+	for (const bool Invert : { false, true })
+	{
+		KeyQuery->SetInvertSort(Invert);
+		CompareQuery->SetInvertSort(Invert);
+
+		TArray<FFaerieAddress> KeySorted;
+		TArray<FFaerieAddress> CompareSorted;
+		KeyQuery->QueryAllAddresses(Storage, KeySorted);
+		CompareQuery->QueryAllAddresses(Storage, CompareSorted);
+
+		TestTrue(FString::Printf(TEXT("Key and comparator sorts agree (Invert: %i)"), Invert), KeySorted == CompareSorted);
+
+		// Live results insert with CompareAddresses, so a full sort must be strictly ordered by it, ties included.
+		for (int32 i = 1; i < KeySorted.Num(); ++i)
+		{
+			if (!KeyQuery->CompareAddresses(Storage, KeySorted[i - 1], KeySorted[i]) ||
+				KeyQuery->CompareAddresses(Storage, KeySorted[i], KeySorted[i - 1]))
+			{
+				AddError(FString::Printf(TEXT("Full sort disagrees with CompareAddresses at %i (Invert: %i)"), i, Invert));
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,94 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieContainerQuery.h"
+#include "FaerieItemDataFilter.h"
+#include "FaerieItemStorage.h"
+#include "HAL/IConsoleManager.h"
+#include "Tokens/FaerieInfoToken.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieQueryParallelFilterBenchmark, "FDS.Perf.FaerieQueryParallelFilterBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FaerieQueryParallelFilterBenchmark::RunTest(const FString& Parameters)
+{
+	static constexpr int32 NumRuns = 10;
+
+	IConsoleVariable* ThresholdCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("fae.Query.ParallelFilterThreshold"));
+	if (!TestNotNull("Threshold console variable", ThresholdCVar))
+	{
+		return false;
+	}
+
+	// The basic filter rules are not exported, so find the Has Tokens rule by name, and give it a token class to look for.
+	UClass* FilterClass = FindObject<UClass>(nullptr, TEXT("/Script/FaerieInventoryContent.FilterRule_HasTokens"));
+	if (!TestNotNull("Has Tokens filter class", FilterClass))
+	{
+		return false;
+	}
+
+	UFaerieItemDataFilter* Filter = NewObject<UFaerieItemDataFilter>(GetTransientPackage(), FilterClass);
+	if (FArrayProperty* TokenClassesProperty = FindFProperty<FArrayProperty>(FilterClass, TEXT("TokenClasses")))
+	{
+		TokenClassesProperty->ContainerPtrToValuePtr<TArray<TSubclassOf<UFaerieItemToken>>>(Filter)->Add(UFaerieInfoToken::StaticClass());
+	}
+	TestTrue("Filter is thread safe", Filter->IsThreadSafe());
+
+	UFaerieContainerQuery* Query = NewObject<UFaerieContainerQuery>();
+	Query->SetFilterByObject(Filter);
+
+	const FFaerieAssetInfo TestInfo{
+		FText::FromString(TEXT("TestObjectName")),
+		FText::FromString(TEXT("TestObjectShortDescription")),
+		FText::FromString(TEXT("TestObjectLongDescription")),
+		nullptr
+	};
+
+	const int32 OriginalThreshold = ThresholdCVar->GetInt();
+
+	for (const int32 NumEntries : { 256, 1024, 4096, 16384, 65536 })
+	{
+		UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+		for (int32 i = 0; i < NumEntries; ++i)
+		{
+			// Give every other item an info token, so half of them pass the filter.
+			UFaerieItem* Item = UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable);
+			if (i % 2 == 0)
+			{
+				Item->AddToken(UFaerieInfoToken::CreateInstance(TestInfo));
+			}
+			Storage->AddEntryFromItemObject(Item, EFaerieStorageAddStackBehavior::AddToAnyStack);
+		}
+
+		auto TimeQuery = [&](const int32 Threshold, TArray<FFaerieAddress>& OutAddresses)
+		{
+			ThresholdCVar->Set(Threshold, ECVF_SetByCode);
+			const double Start = FPlatformTime::Seconds();
+			for (int32 Run = 0; Run < NumRuns; ++Run)
+			{
+				Query->QueryAllAddresses(Storage, OutAddresses);
+			}
+			return (FPlatformTime::Seconds() - Start) / NumRuns;
+		};
+
+		// A threshold no container can reach forces the serial fallback.
+		TArray<FFaerieAddress> SerialAddresses;
+		TArray<FFaerieAddress> ParallelAddresses;
+		const double SerialTime = TimeQuery(MAX_int32, SerialAddresses);
+		const double ParallelTime = TimeQuery(0, ParallelAddresses);
+
+		TestTrue(FString::Printf(TEXT("Results match (%i entries)"), NumEntries), ParallelAddresses == SerialAddresses);
+		TestEqual(FString::Printf(TEXT("Half of the entries pass (%i entries)"), NumEntries), SerialAddresses.Num(), NumEntries / 2);
+
+		AddInfo(FString::Printf(TEXT("%i entries: Serial %.3f ms, Parallel %.3f ms (%.2fx)"),
+			NumEntries, SerialTime * 1000.0, ParallelTime * 1000.0,
+			ParallelTime > 0.0 ? SerialTime / ParallelTime : 0.0));
+	}
+
+	ThresholdCVar->Set(OriginalThreshold, ECVF_SetByCode);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,78 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieItem.h"
+#include "FaerieItemStorage.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieStackProxyPoolTests, "FDS.FaerieStackProxyPoolTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieStackProxyPoolTests::RunTest(const FString& Parameters)
+{
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+
+	// Mutable items never stack, so each add makes its own entry.
+	Storage->AddEntryFromItemObject(UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable), EFaerieStorageAddStackBehavior::AddToAnyStack);
+	Storage->AddEntryFromItemObject(UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable), EFaerieStorageAddStackBehavior::AddToAnyStack);
+
+	TArray<FFaerieAddress> Addresses;
+	Storage->GetAllAddresses(Addresses);
+	if (!TestEqual("Address count", Addresses.Num(), 2))
+	{
+		return false;
+	}
+
+	FFaerieStackProxyLease LeaseA = Storage->AcquireStackProxy(Addresses[0]);
+	if (!TestTrue("Lease A is valid", LeaseA.IsValid()))
+	{
+		return false;
+	}
+	TestTrue("Lease A storage", LeaseA.GetStorage() == Storage);
+
+	// A second acquire of the same address shares the proxy, and keeps it bound after the first release.
+	FFaerieStackProxyLease LeaseA2 = Storage->AcquireStackProxy(Addresses[0]);
+	TestTrue("Same address shares a proxy", LeaseA2.Proxy == LeaseA.Proxy);
+
+	const FFaerieStackProxyLease StaleA = LeaseA;
+	UFaerieItemStackProxy* ProxyA = LeaseA.Proxy;
+
+	TestTrue("Release A", Storage->ReleaseStackProxy(LeaseA));
+	TestFalse("Released lease is reset", LeaseA.IsValid());
+	TestTrue("Proxy still bound while A2 holds it", StaleA.IsValid());
+	TestTrue("Release A2", Storage->ReleaseStackProxy(LeaseA2));
+	TestFalse("Proxy unbound once every holder released it", StaleA.IsValid());
+
+	// The released proxy is recycled for the next request.
+	FFaerieStackProxyLease LeaseB = Storage->AcquireStackProxy(Addresses[1]);
+	TestTrue("Lease B is valid", LeaseB.IsValid());
+	TestTrue("Released proxy is reused", LeaseB.Proxy == ProxyA);
+
+	// A copy of the old lease must not release the proxy out from under its new holder.
+	FFaerieStackProxyLease StaleCopy = StaleA;
+	TestFalse("Stale lease is rejected", Storage->ReleaseStackProxy(StaleCopy));
+	TestTrue("Lease B survives stale release", LeaseB.IsValid());
+
+	TestTrue("Release B", Storage->ReleaseStackProxy(LeaseB));
+	TestFalse("Double release is rejected", Storage->ReleaseStackProxy(LeaseB));
+
+	// Proxies handed out by Proxy may be held by anything, so they must never be the leased proxy, nor recycled.
+	const FFaerieItemProxy SharedProxy = Storage->Proxy(Addresses[0]);
+	FFaerieStackProxyLease LeaseC = Storage->AcquireStackProxy(Addresses[0]);
+	TestTrue("Lease C is valid", LeaseC.IsValid());
+	TestTrue("Leased proxy is not the shared proxy", SharedProxy.GetObject() != LeaseC.Proxy);
+	TestFalse("Shared proxy cannot be leased", UFaerieItemStorage::AcquireExistingStackProxy(SharedProxy).IsValid());
+
+	// A leased proxy passed around as a generic proxy can be leased again, which keeps it bound.
+	FFaerieStackProxyLease LeaseC2 = UFaerieItemStorage::AcquireExistingStackProxy(FFaerieItemProxy(LeaseC.Proxy));
+	TestTrue("Existing leased proxy can be leased", LeaseC2.IsValid() && LeaseC2.Proxy == LeaseC.Proxy);
+	TestTrue("Release C", Storage->ReleaseStackProxy(LeaseC));
+	TestTrue("Lease C2 keeps the proxy bound", LeaseC2.IsValid());
+	TestTrue("Release C2", Storage->ReleaseStackProxy(LeaseC2));
+
+	TestTrue("Shared proxy stays bound", SharedProxy.IsValid() && SharedProxy->GetCopies() == 1);
+
+	return true;
+}
+
+#endif
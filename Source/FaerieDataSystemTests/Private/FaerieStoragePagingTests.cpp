@@ -0,0 +1,241 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieItem.h"
+#include "FaerieItemStorage.h"
+#include "ItemContainerEvent.h"
+#include "Actions/FaerieInventoryClient.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Misc/ScopeExit.h"
+#include "UObject/UObjectHash.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieStoragePagingTests, "FDS.FaerieStoragePagingTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+namespace Faerie::Tests::Paging
+{
+	// Paging settings are only editable on assets, and pages are not exported, so the tests reach them by reflection.
+	void SetPaged(UFaerieItemStorage* Storage, const int32 PageSize)
+	{
+		CastFieldChecked<FBoolProperty>(UFaerieItemStorage::StaticClass()->FindPropertyByName(TEXT("PagedReplication")))->SetPropertyValue_InContainer(Storage, true);
+		CastFieldChecked<FIntProperty>(UFaerieItemStorage::StaticClass()->FindPropertyByName(TEXT("PageSize")))->SetPropertyValue_InContainer(Storage, PageSize);
+	}
+
+	UClass* GetPageClass()
+	{
+		return FindObject<UClass>(nullptr, TEXT("/Script/FaerieInventory.FaerieStoragePage"));
+	}
+
+	UFaerieStoragePage* FindPage(const UFaerieItemStorage* Storage, const int32 PageNumber)
+	{
+		UFaerieStoragePage* Found = nullptr;
+		ForEachObjectWithOuter(Storage,
+			[&Found, PageNumber](UObject* Object)
+			{
+				if (Object->IsA(GetPageClass()) &&
+					static_cast<UFaerieStoragePage*>(Object)->GetPageIndex() == PageNumber)
+				{
+					Found = static_cast<UFaerieStoragePage*>(Object);
+				}
+			}, false);
+		return Found;
+	}
+
+	int32 NumPages(const UFaerieItemStorage* Storage)
+	{
+		return UFaerieItemStorage::StaticClass()->FindPropertyByName(TEXT("Pages"))->ContainerPtrToValuePtr<TMap<int32, TObjectPtr<UFaerieStoragePage>>>(Storage)->Num();
+	}
+
+	// Stand-in for replication: copy the index, which every client receives, and a server page to the client, and run the
+	// page's rep notify.
+	void ReplicatePage(const UFaerieItemStorage* Server, UFaerieItemStorage* Client, const int32 PageNumber)
+	{
+		*UFaerieItemStorage::StaticClass()->FindPropertyByName(TEXT("PageIndex"))->ContainerPtrToValuePtr<FFaerieStorageIndex>(Client) = Server->GetPageIndex();
+
+		const UFaerieStoragePage* ServerPage = FindPage(Server, PageNumber);
+		if (!ServerPage)
+		{
+			return;
+		}
+
+		UClass* PageClass = GetPageClass();
+		UFaerieStoragePage* ClientPage = FindPage(Client, PageNumber);
+		if (!ClientPage)
+		{
+			ClientPage = static_cast<UFaerieStoragePage*>(NewObject<UObject>(Client, PageClass));
+			CastFieldChecked<FIntProperty>(PageClass->FindPropertyByName(TEXT("PageIndex")))->SetPropertyValue_InContainer(ClientPage, PageNumber);
+		}
+
+		*PageClass->FindPropertyByName(TEXT("Entries"))->ContainerPtrToValuePtr<TArray<FInventoryEntry>>(ClientPage) = TArray<FInventoryEntry>(ServerPage->GetEntries());
+		ClientPage->ProcessEvent(ClientPage->FindFunctionChecked(TEXT("OnRep_Entries")), nullptr);
+	}
+}
+
+bool FaerieStoragePagingTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests::Paging;
+
+	if (!TestNotNull("Page class", GetPageClass()))
+	{
+		return false;
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	ON_SCOPE_EXIT { World->DestroyWorld(false); };
+
+	AActor* ServerActor = World->SpawnActor<AActor>();
+	AActor* ClientActor = World->SpawnActor<AActor>();
+	ClientActor->SetRole(ROLE_SimulatedProxy);
+
+	constexpr int32 PageSize = 4;
+	constexpr int32 EntryCount = 10;
+
+	UFaerieItemStorage* Server = NewObject<UFaerieItemStorage>(ServerActor);
+	SetPaged(Server, PageSize);
+	Server->InitializeNetObject(ServerActor);
+
+	UFaerieItemStorage* Client = NewObject<UFaerieItemStorage>(ClientActor);
+	SetPaged(Client, PageSize);
+
+	// Mutable items never stack, so each add makes its own entry.
+	for (int32 i = 0; i < EntryCount; ++i)
+	{
+		Server->AddItemStack(FFaerieItemStack(UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable), 3), EFaerieStorageAddStackBehavior::AddToAnyStack);
+	}
+
+	TArray<FEntryKey> Keys;
+	Server->GetAllKeys(Keys);
+	if (!TestEqual("Key count", Keys.Num(), EntryCount))
+	{
+		return false;
+	}
+
+	// Server side: page layout
+	{
+		for (int32 i = 0; i < Keys.Num(); ++i)
+		{
+			TestEqual(*FString::Printf(TEXT("Page of key %d"), i), Server->GetPageOfKey(Keys[i]), i / PageSize);
+		}
+
+		TestEqual("Indexed entry count", Server->GetIndexedEntryCount(), EntryCount);
+		TestEqual("Indexed page count", Server->GetIndexedPageCount(), 3);
+		TestTrue("Server always has every page", Server->IsPageResident(2));
+
+		TArray<int32> PagesInRange;
+		Server->GetPagesInIndexRange(2, 4, PagesInRange);
+		TestTrue("Range spanning two pages", PagesInRange == TArray<int32>{ 0, 1 });
+
+		PagesInRange.Reset();
+		Server->GetPagesInIndexRange(0, 100, PagesInRange);
+		TestTrue("Range past the end is clamped", PagesInRange == TArray<int32>{ 0, 1, 2 });
+
+		PagesInRange.Reset();
+		Server->GetPagesInIndexRange(-5, 6, PagesInRange);
+		TestTrue("Range before the start is clamped", PagesInRange == TArray<int32>{ 0 });
+
+		PagesInRange.Reset();
+		Server->GetPagesInIndexRange(EntryCount, 5, PagesInRange);
+		TestTrue("Range outside the index is empty", PagesInRange.IsEmpty());
+	}
+
+	// Client side: pages are only applied while resident
+	{
+		TestFalse("Client page not resident yet", Client->IsPageResident(0));
+
+		ReplicatePage(Server, Client, 1);
+		TestEqual("Non-resident page is not applied", Client->GetEntryCount(), 0);
+
+		Client->Client_SetPageResident(0, true);
+		ReplicatePage(Server, Client, 0);
+		TestTrue("Client page resident", Client->IsPageResident(0));
+		TestEqual("Received page adds its entries", Client->GetEntryCount(), PageSize);
+
+		// Making a page resident that was received before applies it right away.
+		Client->Client_SetPageResident(1, true);
+		TestEqual("Cached page is applied when made resident", Client->GetEntryCount(), PageSize * 2);
+	}
+
+	// Client side: changes and removals within a page
+	{
+		TestTrue("Remove entry on server", Server->RemoveEntry(Keys[1], Faerie::Inventory::Tags::RemovalDeletion));
+		TestTrue("Remove copies on server", Server->RemoveEntry(Keys[2], Faerie::Inventory::Tags::RemovalDeletion, 1));
+		ReplicatePage(Server, Client, 0);
+
+		TestFalse("Removed entry leaves the client", Client->ContainsKey(Keys[1]));
+		TestEqual("Changed entry updates on the client", Client->GetStack(Keys[2]), Server->GetStack(Keys[2]));
+		TestEqual("Changed entry copies", Client->GetStack(Keys[2]), 2);
+		TestEqual("Client count after page change", Client->GetEntryCount(), PageSize * 2 - 1);
+		TestEqual("Server index after removal", Server->GetIndexedEntryCount(), EntryCount - 1);
+	}
+
+	// Client side: eviction removes a page's entries, and viewing it again restores them
+	{
+		Client->Client_SetPageResident(0, false);
+		TestFalse("Evicted page is not resident", Client->IsPageResident(0));
+		TestFalse("Evicted entries are removed", Client->ContainsKey(Keys[0]));
+		TestEqual("Client count after eviction", Client->GetEntryCount(), PageSize);
+		TestTrue("Other pages are kept", Client->ContainsKey(Keys[PageSize]));
+
+		Client->Client_SetPageResident(0, true);
+		TestTrue("Re-viewed page is restored", Client->ContainsKey(Keys[0]));
+		TestEqual("Client count after re-view", Client->GetEntryCount(), PageSize * 2 - 1);
+	}
+
+	// Inventory client: least recently viewed pages are evicted first
+	{
+		Client->Client_SetPageResident(0, false);
+		Client->Client_SetPageResident(1, false);
+
+		UFaerieInventoryClient* InventoryClient = NewObject<UFaerieInventoryClient>(ClientActor);
+		CastFieldChecked<FIntProperty>(UFaerieInventoryClient::StaticClass()->FindPropertyByName(TEXT("MaxResidentStoragePages")))->SetPropertyValue_InContainer(InventoryClient, 2);
+
+		InventoryClient->ViewStoragePages(Client, { 0, 1 });
+		TestTrue("LRU: page 0 resident", Client->IsPageResident(0));
+		TestTrue("LRU: page 1 resident", Client->IsPageResident(1));
+
+		// Touch page 0, so that page 1 is now the least recently viewed.
+		InventoryClient->ViewStoragePages(Client, { 0 });
+		InventoryClient->ViewStoragePages(Client, { 2 });
+		TestTrue("LRU: recently viewed page kept", Client->IsPageResident(0));
+		TestFalse("LRU: least recently viewed page evicted", Client->IsPageResident(1));
+		TestTrue("LRU: new page resident", Client->IsPageResident(2));
+		TestFalse("LRU: evicted entries are removed", Client->ContainsKey(Keys[PageSize]));
+
+		// Requesting more pages than may be resident keeps only the last ones.
+		InventoryClient->ViewStoragePages(Client, { 0, 1, 2 });
+		TestFalse("LRU: oversized request drops its first pages", Client->IsPageResident(0));
+		TestTrue("LRU: oversized request keeps page 1", Client->IsPageResident(1));
+		TestTrue("LRU: oversized request keeps page 2", Client->IsPageResident(2));
+
+		InventoryClient->ReleaseStoragePages(Client);
+		TestFalse("Release: page 1 evicted", Client->IsPageResident(1));
+		TestFalse("Release: page 2 evicted", Client->IsPageResident(2));
+		TestEqual("Release: no entries left", Client->GetEntryCount(), 0);
+	}
+
+	// Server side: emptied pages are removed once no player is viewing them
+	{
+		ReplicatePage(Server, Client, 2);
+		const int32 PagesBefore = NumPages(Server);
+
+		TestTrue("Empty page 2 (first)", Server->RemoveEntry(Keys[8], Faerie::Inventory::Tags::RemovalDeletion));
+		TestEqual("Page with entries left is kept", NumPages(Server), PagesBefore);
+		TestTrue("Empty page 2 (second)", Server->RemoveEntry(Keys[9], Faerie::Inventory::Tags::RemovalDeletion));
+		TestEqual("Emptied page is removed", NumPages(Server), PagesBefore - 1);
+		TestEqual("Index no longer covers the removed page", Server->GetIndexedPageCount(), 2);
+
+		// The client only has its stale copy of the page, which is dropped rather than shown.
+		ReplicatePage(Server, Client, 0);
+		Client->Client_SetPageResident(2, true);
+		TestFalse("Stale page is not applied", Client->ContainsKey(Keys[8]));
+		Client->Client_SetPageResident(2, false);
+	}
+
+	Server->DeinitializeNetObject(ServerActor);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,121 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieItem.h"
+#include "FaerieItemStorage.h"
+#include "FaerieItemStorageTransaction.h"
+#include "ItemContainerEvent.h"
+#include "Extensions/ItemContainerExtensionEvents.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieStorageTransactionTests, "FDS.FaerieStorageTransactionTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+namespace Faerie::Tests::Transaction
+{
+	struct FPostedBatch
+	{
+		FFaerieInventoryTag Type;
+		int32 Events;
+	};
+
+	// Entries are not exposed by the storage, so the tests reach them by reflection.
+	const FInventoryEntry& GetEntry(const UFaerieItemStorage* Storage, const FEntryKey Key)
+	{
+		const FInventoryContent& Content = *UFaerieItemStorage::StaticClass()->FindPropertyByName(TEXT("EntryMap"))->ContainerPtrToValuePtr<FInventoryContent>(Storage);
+		return Content[Key];
+	}
+
+	void AddMutable(UFaerieItemStorage* Storage, const int32 Copies)
+	{
+		Storage->AddItemStack(FFaerieItemStack(UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable), Copies), EFaerieStorageAddStackBehavior::AddToAnyStack);
+	}
+}
+
+bool FaerieStorageTransactionTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests::Transaction;
+	namespace Tags = Faerie::Inventory::Tags;
+
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+
+	UItemContainerExtensionEvents* Events = NewObject<UItemContainerExtensionEvents>(Storage);
+	Events->SetIdentifier();
+	if (!TestTrue("Add events extension", Storage->AddExtension(Events)))
+	{
+		return false;
+	}
+
+	TArray<FPostedBatch> Posted;
+	Events->GetOnPostEventBatch().AddLambda(
+		[&Posted](TNotNull<const UFaerieItemContainerBase*>, const Faerie::Inventory::FEventLogBatch& Batch)
+		{
+			Posted.Add({ Batch.Type, Batch.Data.Num() });
+		});
+
+	// Outside a transaction, every edit is posted on its own.
+	{
+		AddMutable(Storage, 3);
+		AddMutable(Storage, 3);
+		TestEqual("Untransacted adds post one batch each", Posted.Num(), 2);
+	}
+
+	TArray<FEntryKey> Keys;
+	Storage->GetAllKeys(Keys);
+	if (!TestEqual("Key count", Keys.Num(), 2))
+	{
+		return false;
+	}
+
+	// Inside a transaction, events are collected, and posted as one batch per type when it closes.
+	{
+		Posted.Reset();
+		const int32 ReplicationKeyBefore = GetEntry(Storage, Keys[0]).ReplicationKey;
+
+		{
+			Faerie::Storage::FScopedTransaction Transaction(Storage);
+
+			AddMutable(Storage, 1);
+			TestTrue("Remove copies (first)", Storage->RemoveEntry(Keys[0], Tags::RemovalDeletion, 1));
+			AddMutable(Storage, 1);
+			TestTrue("Remove copies (second)", Storage->RemoveEntry(Keys[0], Tags::RemovalDeletion, 1));
+			TestTrue("Remove entry", Storage->RemoveEntry(Keys[1], Tags::RemovalDeletion));
+
+			// Nested transactions have no effect of their own.
+			{
+				Faerie::Storage::FScopedTransaction Nested(Storage);
+				AddMutable(Storage, 1);
+			}
+
+			TestEqual("Nothing is posted while open", Posted.Num(), 0);
+			TestEqual("Edits are not marked dirty while open", GetEntry(Storage, Keys[0]).ReplicationKey, ReplicationKeyBefore);
+			TestFalse("Removed entry is gone while open", Storage->ContainsKey(Keys[1]));
+			TestEqual("Entry count while open", Storage->GetEntryCount(), 4);
+			TestEqual("Edited entry copies while open", Storage->GetStack(Keys[0]), 1);
+		}
+
+		if (TestEqual("One batch per event type", Posted.Num(), 2))
+		{
+			TestTrue("Additions first, as they occurred first", Posted[0].Type == Tags::Addition);
+			TestEqual("Merged addition events", Posted[0].Events, 3);
+			TestTrue("Removals second", Posted[1].Type == Tags::RemovalDeletion);
+			TestEqual("Merged removal events", Posted[1].Events, 3);
+		}
+
+		TestEqual("Edited entry is marked dirty once", GetEntry(Storage, Keys[0]).ReplicationKey, ReplicationKeyBefore + 1);
+		TestEqual("Entry count after close", Storage->GetEntryCount(), 4);
+	}
+
+	// An empty transaction posts nothing.
+	{
+		Posted.Reset();
+		{
+			Faerie::Storage::FScopedTransaction Transaction(Storage);
+		}
+		TestEqual("Empty transaction posts nothing", Posted.Num(), 0);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,40 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieItem.h"
+#include "FaerieItemAsset.h"
+#include "Tokens/FaerieInfoToken.h"
+#include "Tokens/FaerieStaticReferenceToken.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieTokenCacheRepNotifyTests, "FDS.FaerieTokenCacheRepNotifyTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieTokenCacheRepNotifyTests::RunTest(const FString& Parameters)
+{
+	// An asset whose item has an info token, for the reference token to point at.
+	UFaerieItemAsset* Asset = NewObject<UFaerieItemAsset>();
+	UFaerieItem* AssetItem = UFaerieItem::CreateNewInstance({ UFaerieInfoToken::CreateInstance(FFaerieAssetInfo()) }, EFaerieItemInstancingMutability::Immutable);
+	CastFieldChecked<FObjectProperty>(UFaerieItemAsset::StaticClass()->FindPropertyByName(TEXT("Item")))->SetObjectPropertyValue_InContainer(Asset, AssetItem);
+
+	// Start with a reference under a tag that default lookups do not match.
+	FFaerieTaggedStaticReference Reference;
+	Reference.Reference = Asset;
+	UFaerieStaticReferenceToken* ReferenceToken = UFaerieStaticReferenceToken::CreateInstance({ Reference });
+	const UFaerieItem* Item = UFaerieItem::CreateNewInstance({ ReferenceToken }, EFaerieItemInstancingMutability::Mutable);
+
+	// This memoizes that nothing is referenced under the default tag.
+	TestNull("No token before the reference matches", Item->GetToken<UFaerieInfoToken>());
+
+	// Simulate replication changing the reference, which does not go through EditToken.
+	const FArrayProperty* ReferencesProperty = CastFieldChecked<FArrayProperty>(UFaerieStaticReferenceToken::StaticClass()->FindPropertyByName(TEXT("References")));
+	TArray<FFaerieTaggedStaticReference>& References = *ReferencesProperty->ContainerPtrToValuePtr<TArray<FFaerieTaggedStaticReference>>(ReferenceToken);
+	References[0].Tag = Faerie::Token::Tags::TokenReferenceDefaults;
+	ReferenceToken->PostRepNotifies();
+
+	TestNotNull("Referenced token is found after PostRepNotifies", Item->GetToken<UFaerieInfoToken>());
+
+	return true;
+}
+
+#endif
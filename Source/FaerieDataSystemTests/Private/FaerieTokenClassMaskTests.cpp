@@ -0,0 +1,177 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Algo/AnyOf.h"
+#include "FaerieItem.h"
+#include "FaerieItemAsset.h"
+#include "FaerieItemTokenClassMask.h"
+#include "Math/RandomStream.h"
+#include "Tokens/FaerieInfoToken.h"
+#include "Tokens/FaerieStaticReferenceToken.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieTokenClassMaskTests, "FDS.FaerieTokenClassMaskTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+namespace Faerie::Tests::ClassMask
+{
+	// Token classes from several modules, found by name, so that the hierarchy includes abstract and intermediate classes.
+	const TCHAR* ConcreteClassPaths[] = {
+		TEXT("/Script/FaerieItemData.FaerieInfoToken"),
+		TEXT("/Script/FaerieItemData.FaerieGuidToken"),
+		TEXT("/Script/FaerieItemData.FaerieTagToken"),
+		TEXT("/Script/FaerieItemGenerator.FaerieItemUsesToken"),
+		TEXT("/Script/FaerieInventory.FaerieStackLimiterToken"),
+		TEXT("/Script/FaerieInventoryContent.FaerieCapacityToken"),
+		TEXT("/Script/FaerieInventoryContent.FaerieShapeToken"),
+		TEXT("/Script/FaerieItemMesh.FaerieMeshToken"),
+	};
+
+	// Classes that are only ever required, never instanced.
+	const TCHAR* RequiredOnlyClassPaths[] = {
+		TEXT("/Script/FaerieItemData.FaerieItemToken"),
+		TEXT("/Script/FaerieItemMesh.FaerieMeshTokenBase"),
+		TEXT("/Script/FaerieInventory.FaerieItemContainerToken"),
+		TEXT("/Script/FaerieInventory.FaerieItemStorageToken"),
+	};
+
+	void FindClasses(const TConstArrayView<const TCHAR*> Paths, TArray<const UClass*>& OutClasses)
+	{
+		for (const TCHAR* Path : Paths)
+		{
+			if (const UClass* Class = FindObject<UClass>(nullptr, Path))
+			{
+				OutClasses.Add(Class);
+			}
+		}
+	}
+
+	// What HasTokens did before the class mask: look for an owned token of each class, one class at a time.
+	bool WalkHasTokens(const UFaerieItem* Item, const TConstArrayView<const UClass*> Required)
+	{
+		for (const UClass* Class : Required)
+		{
+			const bool Found = Algo::AnyOf(Item->GetOwnedTokens(),
+				[Class](const UFaerieItemToken* Token)
+				{
+					return IsValid(Token) && Token->IsA(Class);
+				});
+
+			if (!Found)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	FString Describe(const TConstArrayView<const UClass*> Classes)
+	{
+		return FString::JoinBy(Classes, TEXT(", "), [](const UClass* Class) { return Class->GetName(); });
+	}
+}
+
+bool FaerieTokenClassMaskTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests::ClassMask;
+	using Faerie::Token::FClassMask;
+
+	TArray<const UClass*> Concrete;
+	FindClasses(ConcreteClassPaths, Concrete);
+	TArray<const UClass*> AllClasses = Concrete;
+	FindClasses(RequiredOnlyClassPaths, AllClasses);
+
+	if (!TestTrue("Found token classes", Concrete.Num() >= 3))
+	{
+		return false;
+	}
+
+	// Masks of single classes.
+	{
+		TestTrue("Null class is empty", FClassMask::ForClass(nullptr).IsEmpty());
+		TestTrue("Non-token class is empty", FClassMask::ForClass(UFaerieItem::StaticClass()).IsEmpty());
+
+		const FClassMask& Base = FClassMask::ForClass(UFaerieItemToken::StaticClass());
+		for (const UClass* Class : AllClasses)
+		{
+			const FClassMask& Mask = FClassMask::ForClass(Class);
+			TestFalse(*FString::Printf(TEXT("%s is not empty"), *Class->GetName()), Mask.IsEmpty());
+			TestTrue(*FString::Printf(TEXT("%s contains its super classes"), *Class->GetName()), Mask.ContainsAll(Base) && Mask.ContainsAll(FClassMask::ForClass(Class->GetSuperClass())));
+			TestTrue(*FString::Printf(TEXT("%s mask is stable"), *Class->GetName()), &FClassMask::ForClass(Class) == &Mask);
+		}
+	}
+
+	// Owned tokens: the mask must agree with walking the tokens, for random items and random requirements.
+	{
+		FRandomStream Random(0xFAE);
+
+		for (int32 ItemIndex = 0; ItemIndex < 32; ++ItemIndex)
+		{
+			TArray<UFaerieItemToken*> Tokens;
+			for (const UClass* Class : Concrete)
+			{
+				if (Random.RandRange(0, 2) == 0)
+				{
+					Tokens.Add(NewObject<UFaerieItemToken>(GetTransientPackage(), const_cast<UClass*>(Class)));
+				}
+			}
+			const UFaerieItem* Item = UFaerieItem::CreateNewInstance(Tokens, EFaerieItemInstancingMutability::Mutable);
+
+			// Every single class, then random sets of up to three.
+			TArray<TArray<const UClass*>> Requirements;
+			Requirements.Add({});
+			for (const UClass* Class : AllClasses)
+			{
+				Requirements.Add({ Class });
+			}
+			for (int32 i = 0; i < 16; ++i)
+			{
+				TArray<const UClass*>& Required = Requirements.AddDefaulted_GetRef();
+				for (int32 j = Random.RandRange(2, 3); j > 0; --j)
+				{
+					Required.AddUnique(AllClasses[Random.RandRange(0, AllClasses.Num() - 1)]);
+				}
+			}
+
+			for (const TArray<const UClass*>& Required : Requirements)
+			{
+				TestEqual(*FString::Printf(TEXT("Item %d has [%s]"), ItemIndex, *Describe(Required)),
+					Item->HasTokens(FClassMask::ForClasses(Required)), WalkHasTokens(Item, Required));
+			}
+		}
+	}
+
+	// The mask follows tokens added after it was built.
+	{
+		UFaerieItem* Item = UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable);
+		const FClassMask& InfoMask = FClassMask::ForClass(UFaerieInfoToken::StaticClass());
+		TestFalse("Empty item has no info", Item->HasTokens(InfoMask));
+		Item->AddToken(UFaerieInfoToken::CreateInstance(FFaerieAssetInfo()));
+		TestTrue("Added token is in the mask", Item->HasTokens(InfoMask));
+	}
+
+	// Referenced tokens count only when a reference tag is given, and may be combined with owned tokens.
+	{
+		UFaerieItemAsset* Asset = NewObject<UFaerieItemAsset>();
+		UFaerieItem* AssetItem = UFaerieItem::CreateNewInstance({ UFaerieInfoToken::CreateInstance(FFaerieAssetInfo()) }, EFaerieItemInstancingMutability::Immutable);
+		CastFieldChecked<FObjectProperty>(UFaerieItemAsset::StaticClass()->FindPropertyByName(TEXT("Item")))->SetObjectPropertyValue_InContainer(Asset, AssetItem);
+
+		FFaerieTaggedStaticReference Reference;
+		Reference.Tag = Faerie::Token::Tags::TokenReferenceDefaults;
+		Reference.Reference = Asset;
+		const UFaerieItem* Item = UFaerieItem::CreateNewInstance({ UFaerieStaticReferenceToken::CreateInstance({ Reference }) }, EFaerieItemInstancingMutability::Mutable);
+
+		const FClassMask InfoMask = FClassMask::ForClass(UFaerieInfoToken::StaticClass());
+		const FClassMask InfoAndReference = FClassMask::ForClasses(TArray<const UClass*>{ UFaerieInfoToken::StaticClass(), UFaerieStaticReferenceToken::StaticClass() });
+
+		TestFalse("Referenced token is ignored without a tag", Item->HasTokens(InfoMask));
+		TestTrue("Referenced token is found with the tag", Item->HasTokens(InfoMask, Faerie::Token::Tags::TokenReferenceDefaults));
+		TestTrue("Owned and referenced tokens combine", Item->HasTokens(InfoAndReference, Faerie::Token::Tags::TokenReferenceDefaults));
+		TestTrue("Mask agrees with the token lookup", Item->GetToken<UFaerieInfoToken>() != nullptr);
+		TestFalse("Tokens in neither are still missing", Item->HasTokens(FClassMask::ForClass(FindObject<UClass>(nullptr, TEXT("/Script/FaerieItemData.FaerieGuidToken"))), Faerie::Token::Tags::TokenReferenceDefaults));
+	}
+
+	return true;
+}
+
+#endif
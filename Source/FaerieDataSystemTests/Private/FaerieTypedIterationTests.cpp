@@ -0,0 +1,103 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieContainerFilter.h"
+#include "FaerieContainerFilterTypes.h"
+#include "FaerieItemStorage.h"
+#include "FaerieItemStorageTransaction.h"
+#include "ItemContainerEvent.h"
+#include "Tokens/FaerieInfoToken.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieTypedIterationTests, "FDS.FaerieTypedIterationTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+namespace Faerie::Tests::TypedIteration
+{
+	using namespace Faerie::Container;
+
+	// Storages are iterated inline, while the same storage through a base pointer is iterated through its virtual interface.
+	static_assert(std::is_same_v<Private::TIterationContainerOf<const UFaerieItemStorage*>, UFaerieItemStorage>);
+	static_assert(std::is_same_v<Private::TIterationContainerOf<TNotNull<UFaerieItemStorage*>>, UFaerieItemStorage>);
+	static_assert(std::is_same_v<Private::TIterationContainerOf<const UFaerieItemContainerBase*>, UFaerieItemContainerBase>);
+
+	UFaerieItem* MakeNamedItem(const TCHAR* Name, const EFaerieItemInstancingMutability Mutability)
+	{
+		UFaerieItemToken* Info = UFaerieInfoToken::CreateInstance(FFaerieAssetInfo{ FText::FromString(Name), FText::GetEmpty(), FText::GetEmpty(), nullptr });
+		return UFaerieItem::CreateNewInstance(MakeArrayView(&Info, 1), Mutability);
+	}
+
+	// Run a filter through both iteration paths, and test that they agree.
+	template <typename TFilterType>
+	void TestPathsAgree(FAutomationTestBase& Test, const TCHAR* What, const TFilterType& Filter, const UFaerieItemStorage* Storage)
+	{
+		const UFaerieItemContainerBase* Container = Storage;
+
+		const auto Inline = Filter.Emit(Storage);
+		const auto Virtual = Filter.Emit(Container);
+		Test.TestTrue(*FString::Printf(TEXT("%s: Emit matches"), What), Inline == Virtual);
+		Test.TestEqual(*FString::Printf(TEXT("%s: Count matches"), What), Filter.Count(Storage), Filter.Count(Container));
+		Test.TestEqual(*FString::Printf(TEXT("%s: Count matches Emit"), What), Filter.Count(Storage), Inline.Num());
+		if (!Inline.IsEmpty())
+		{
+			Test.TestTrue(*FString::Printf(TEXT("%s: First matches"), What), Filter.First(Storage) == Filter.First(Container));
+		}
+	}
+
+	void TestAllFilters(FAutomationTestBase& Test, const TCHAR* Stage, const UFaerieItemStorage* Storage)
+	{
+		const FCompareName ByName{ FText::FromString(TEXT("Beta")), ETextComparisonLevel::Default };
+
+		TestPathsAgree(Test, *FString::Printf(TEXT("%s Keys"), Stage), FKeyFilter(), Storage);
+		TestPathsAgree(Test, *FString::Printf(TEXT("%s Addresses"), Stage), FAddressFilter(), Storage);
+		TestPathsAgree(Test, *FString::Printf(TEXT("%s Items"), Stage), FItemFilter(), Storage);
+		TestPathsAgree(Test, *FString::Printf(TEXT("%s Mutable items"), Stage), FMutableItemFilter(), Storage);
+		TestPathsAgree(Test, *FString::Printf(TEXT("%s Immutable keys"), Stage), FKeyFilter().ByImmutable(), Storage);
+		TestPathsAgree(Test, *FString::Printf(TEXT("%s Named keys"), Stage), FKeyFilter().By(FCompareName(ByName)), Storage);
+		TestPathsAgree(Test, *FString::Printf(TEXT("%s Inverted named addresses"), Stage), FAddressFilter().By(FCompareName(ByName)).Invert(), Storage);
+	}
+}
+
+bool FaerieTypedIterationTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests::TypedIteration;
+
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+
+	// Both paths must agree on an empty storage.
+	TestAllFilters(*this, TEXT("Empty"), Storage);
+	TestEqual("Empty storage has no keys", FKeyFilter().Count(Storage), 0);
+
+	const TCHAR* Names[] = { TEXT("Alpha"), TEXT("Beta"), TEXT("Gamma") };
+	for (const TCHAR* Name : Names)
+	{
+		Storage->AddItemStack(FFaerieItemStack(MakeNamedItem(Name, EFaerieItemInstancingMutability::Immutable), 2), EFaerieStorageAddStackBehavior::AddToAnyStack);
+		Storage->AddItemStack(FFaerieItemStack(MakeNamedItem(Name, EFaerieItemInstancingMutability::Mutable), 1), EFaerieStorageAddStackBehavior::AddToAnyStack);
+	}
+
+	TestAllFilters(*this, TEXT("Filled"), Storage);
+	TestEqual("Every entry is iterated", FKeyFilter().Count(Storage), Storage->GetEntryCount());
+	TestEqual("Mutable entries", FMutableItemFilter().Count(Storage), 3);
+
+	TArray<FEntryKey> Keys;
+	Storage->GetAllKeys(Keys);
+	TestTrue("Keys are iterated in order", FKeyFilter().Emit(Storage) == Keys);
+
+	// Entries removed inside a transaction are left as tombstones until it closes, which both paths must skip.
+	{
+		Faerie::Storage::FScopedTransaction Transaction(Storage);
+		Storage->RemoveEntry(Keys[0], Faerie::Inventory::Tags::RemovalDeletion);
+		Storage->RemoveEntry(Keys[3], Faerie::Inventory::Tags::RemovalDeletion);
+
+		TestAllFilters(*this, TEXT("Tombstoned"), Storage);
+		TestEqual("Tombstones are skipped", FKeyFilter().Count(Storage), Keys.Num() - 2);
+		TestTrue("First skips a leading tombstone", FKeyFilter().First(Storage) == Keys[1]);
+	}
+
+	TestAllFilters(*this, TEXT("Compacted"), Storage);
+	TestEqual("Compacted entry count", FKeyFilter().Count(Storage), Keys.Num() - 2);
+
+	return true;
+}
+
+#endif
@@ -5,10 +5,33 @@
 #include "Algo/BinarySearch.h"
 #include "Algo/IsSorted.h"
 #include "Algo/Sort.h"
+#include "Concepts/SameAs.h"
+#include "DenseKeyTable.h"
 #include "Stats/Stats.h"
 
 DECLARE_STATS_GROUP(TEXT("FaerieDataUtils"), STATGROUP_FaerieDataUtils, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("BSOA Index Of"), STAT_BSOA_IndexOf, STATGROUP_FaerieDataUtils);
+DECLARE_CYCLE_STAT(TEXT("BSOA Rebuild Key Table"), STAT_BSOA_RebuildKeyTable, STATGROUP_FaerieDataUtils);
+
+/**
+ * Array types may opt in to a FDenseKeyTable by implementing `FDenseKeyTable& GetDenseKeyTable() const`, returning a
+ * mutable member. Their Key type must implement `int32 Value() const`.
+ */
+template <typename TArrayType>
+concept CDenseKeyTableArray = requires(const TArrayType& Array)
+{
+	{ Array.GetDenseKeyTable() } -> UE::CSameAs<FDenseKeyTable&>;
+};
+
+/**
+ * Array types may opt in to tombstoned elements by implementing `bool IsTombstone(const TElementType&) const`.
+ * Tombstones keep their slot and key, so the array stays sorted, but key lookup treats them as absent.
+ */
+template <typename TArrayType, typename TElementType>
+concept CTombstoneArray = requires(const TArrayType& Array, const TElementType& Element)
+{
+	{ Array.IsTombstone(Element) } -> UE::CSameAs<bool>;
+};
 
 /**
  * This is a template base for types that wrap a struct array where the struct contains a Key.
@@ -18,6 +41,8 @@ DECLARE_CYCLE_STAT(TEXT("BSOA Index Of"), STAT_BSOA_IndexOf, STATGROUP_FaerieDat
  * See FInventoryContent for an example of this implemented.
  * TArrayType must implement a function with the signature `TArray<TElementType>& GetArray()`, and TElementType must have a
  * member named Key. The Key type must have operator< implemented.
+ * If TArrayType satisfies CDenseKeyTableArray, lookups are made through the key table, instead of binary search.
+ * If TArrayType satisfies CTombstoneArray, lookups will not return tombstones. Index-based accessors still do.
  */
 template <typename TArrayType, typename TElementType>
 struct TBinarySearchOptimizedArray
@@ -29,12 +54,106 @@ private:
 	UE_REWRITE const TArray<TElementType>& GetArray_Internal() const { return const_cast<TArrayType*>(static_cast<const TArrayType*>(this))->GetArray(); }
 	UE_REWRITE TArray<TElementType>& GetArray_Internal() { return static_cast<TArrayType*>(this)->GetArray(); }
 
+	void RebuildKeyTable(FDenseKeyTable& Table) const
+	{
+		SCOPE_CYCLE_COUNTER(STAT_BSOA_RebuildKeyTable);
+		Table.Rebuild(TConstArrayView<TElementType>(GetArray_Internal()),
+			[](const TElementType& Element) { return Element.Key.Value(); });
+	}
+
+	// Look up a Key through the key table. Returns false if the table cannot be used, or it missed, and binary search is required.
+	bool TryIndexOf_KeyTable(const KeyType Key, int32& OutIndex) const requires CDenseKeyTableArray<TArrayType>
+	{
+		FDenseKeyTable& Table = static_cast<const TArrayType*>(this)->GetDenseKeyTable();
+		const TArray<TElementType>& Array = GetArray_Internal();
+
+		if (!Table.IsValidFor(Array.Num()))
+		{
+			RebuildKeyTable(Table);
+		}
+
+		// Try twice, in case the table went out of date without being invalidated.
+		for (int32 Attempt = 0; Attempt < 2 && Table.IsUsable(); ++Attempt)
+		{
+			const int32 Index = Table.Find(Key.Value());
+
+			// A miss cannot be verified against the array, and a stale table may simply not know the key yet, so
+			// leave misses to binary search.
+			if (Index == INDEX_NONE)
+			{
+				return false;
+			}
+
+			if (Array.IsValidIndex(Index) && Array[Index].Key == Key)
+			{
+				OutIndex = Index;
+				return true;
+			}
+
+			RebuildKeyTable(Table);
+		}
+
+		return false;
+	}
+
+	UE_REWRITE void InvalidateKeyTable()
+	{
+		if constexpr (CDenseKeyTableArray<TArrayType>)
+		{
+			static_cast<TArrayType*>(this)->GetDenseKeyTable().Invalidate();
+		}
+	}
+
+	// Remove the element at Index, patching the key table instead of invalidating it.
+	void RemoveAt_Internal(const int32 Index)
+	{
+		if constexpr (CDenseKeyTableArray<TArrayType>)
+		{
+			static_cast<TArrayType*>(this)->GetDenseKeyTable().NotifyRemoved(GetArray_Internal()[Index].Key.Value(), Index);
+		}
+
+		// RemoveAtSwap would be faster but would break Entry key order.
+		GetArray_Internal().RemoveAt(Index);
+	}
+
+	int32 IndexOf_Internal(const KeyType Key) const
+	{
+		if constexpr (CDenseKeyTableArray<TArrayType>)
+		{
+			if (int32 Index; TryIndexOf_KeyTable(Key, Index))
+			{
+				return Index;
+			}
+		}
+
+		// This is O(n), so it's too expensive to run on every lookup outside of slow-check builds.
+		checkfSlow(IsSorted(), TEXT("Array got out of order. BinarySearch will not function. Determine why Array is not sorted!"));
+		// Search for Key in the Items. Since those do not share Type, we project by the element key.
+		return Algo::BinarySearchBy(GetArray_Internal(), Key, &TElementType::Key);
+	}
+
 public:
 	int32 IndexOf(const KeyType Key) const
 	{
-		checkf(IsSorted(), TEXT("Array got out of order. BinarySearch will not function. Determine why Array is not sorted!"));
 		SCOPE_CYCLE_COUNTER(STAT_BSOA_IndexOf);
-		// Search for Key in the Items. Since those do not share Type, we project by the element key.
+
+		const int32 Index = IndexOf_Internal(Key);
+
+		if constexpr (CTombstoneArray<TArrayType, TElementType>)
+		{
+			if (Index != INDEX_NONE && static_cast<const TArrayType*>(this)->IsTombstone(GetArray_Internal()[Index]))
+			{
+				return INDEX_NONE;
+			}
+		}
+
+		return Index;
+	}
+
+	// Binary search for a Key, ignoring the key table, if there is one.
+	int32 IndexOf_BinarySearch(const KeyType Key) const
+	{
+		checkfSlow(IsSorted(), TEXT("Array got out of order. BinarySearch will not function. Determine why Array is not sorted!"));
 		return Algo::BinarySearchBy(GetArray_Internal(), Key, &TElementType::Key);
 	}
 
@@ -87,6 +206,7 @@ public:
 	void Sort()
 	{
 		Algo::SortBy(GetArray_Internal(), &TElementType::Key);
+		InvalidateKeyTable();
 	}
 
 	/**
@@ -112,6 +232,17 @@ public:
 		}
 
 		// Otherwise, we were given a key not present, and we should insert the Entry at the Index.
+		if constexpr (CDenseKeyTableArray<TArrayType>)
+		{
+			if (NextIndex == GetArray_Internal().Num())
+			{
+				static_cast<TArrayType*>(this)->GetDenseKeyTable().NotifyAppended(Element.Key.Value(), NextIndex);
+			}
+			else
+			{
+				InvalidateKeyTable();
+			}
+		}
 		return GetArray_Internal().Insert_GetRef(Element, NextIndex);
 	}
 
@@ -120,8 +251,7 @@ public:
 		if (const int32 Index = IndexOf(Key);
 			Index != INDEX_NONE)
 		{
-			// Notify owning server of this removal.
-			GetArray_Internal().RemoveAt(Index);
+			RemoveAt_Internal(Index);
 			return true;
 		}
 		return false;
@@ -134,9 +264,7 @@ public:
 			Index != INDEX_NONE)
 		{
 			PreRemovalPredicate(GetArray_Internal()[Index]);
-
-			// RemoveAtSwap would be faster but would break Entry key order.
-			GetArray_Internal().RemoveAt(Index);
+			RemoveAt_Internal(Index);
 			return true;
 		}
 		return false;
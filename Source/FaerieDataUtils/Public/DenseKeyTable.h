@@ -0,0 +1,171 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/Array.h"
+#include "Containers/ArrayView.h"
+
+/**
+ * A direct-indexed lookup table from integer key values to array indices. Intended to accompany a
+ * TBinarySearchOptimizedArray whose keys are issued in increasing order by a key generator, turning key lookup into a
+ * single array read instead of a binary search.
+ * The table is only a cache over the real array. Appends and removals patch it in place, otherwise it is rebuilt lazily
+ * whenever it has been invalidated. Rebuilds are rebased to the lowest live key, so keys that have died at the front of
+ * the array stop costing memory. If the live keys are too sparse for direct indexing to be worth the memory, the table disables itself until the next rebuild.
+ * See FInventoryContent for an example of this in use.
+ */
+struct FDenseKeyTable
+{
+	// The table will not be used if the key range is larger than this multiple of the element count.
+	static constexpr int32 MaxSparseness = 4;
+
+	// Small arrays are always allowed to use the table, regardless of sparseness.
+	static constexpr int32 SparsenessSlack = 64;
+
+	UE_REWRITE bool IsValidFor(const int32 ArrayNum) const
+	{
+		return bIsValid && NumIndexed == ArrayNum;
+	}
+
+	UE_REWRITE bool IsUsable() const
+	{
+		return bIsUsable;
+	}
+
+	UE_REWRITE void Invalidate()
+	{
+		bIsValid = false;
+	}
+
+	// Returns the index stored for this key value, or INDEX_NONE. The caller must verify the element at the index.
+	UE_REWRITE int32 Find(const int32 KeyValue) const
+	{
+		const int32 Offset = KeyValue - BaseKey;
+		return Slots.IsValidIndex(Offset) ? Slots[Offset] : INDEX_NONE;
+	}
+
+	template <typename TElementType, typename TProjection>
+	void Rebuild(const TConstArrayView<TElementType> Elements, TProjection KeyValueProjection)
+	{
+		bIsValid = true;
+		bIsUsable = true;
+		NumIndexed = Elements.Num();
+		Slots.Reset();
+		BaseKey = 0;
+
+		if (Elements.IsEmpty())
+		{
+			return;
+		}
+
+		int32 MinKey = MAX_int32;
+		int32 MaxKey = MIN_int32;
+		for (const TElementType& Element : Elements)
+		{
+			const int32 KeyValue = KeyValueProjection(Element);
+			MinKey = FMath::Min(MinKey, KeyValue);
+			MaxKey = FMath::Max(MaxKey, KeyValue);
+		}
+
+		const int64 Range = static_cast<int64>(MaxKey) - MinKey + 1;
+		if (Range > static_cast<int64>(Elements.Num()) * MaxSparseness + SparsenessSlack)
+		{
+			bIsUsable = false;
+			return;
+		}
+
+		BaseKey = MinKey;
+		Slots.Init(INDEX_NONE, static_cast<int32>(Range));
+		for (int32 i = 0; i < Elements.Num(); ++i)
+		{
+			Slots[KeyValueProjection(Elements[i]) - BaseKey] = i;
+		}
+	}
+
+	// Incrementally register an element that was added to the end of the array.
+	void NotifyAppended(const int32 KeyValue, const int32 Index)
+	{
+		if (!bIsValid || !bIsUsable || Index != NumIndexed)
+		{
+			Invalidate();
+			return;
+		}
+
+		if (Slots.IsEmpty())
+		{
+			BaseKey = KeyValue;
+		}
+
+		const int32 Offset = KeyValue - BaseKey;
+		if (Offset < 0)
+		{
+			Invalidate();
+			return;
+		}
+
+		if (Offset >= Slots.Num())
+		{
+			const int32 OldNum = Slots.Num();
+			Slots.SetNumUninitialized(Offset + 1);
+			for (int32 i = OldNum; i < Slots.Num(); ++i)
+			{
+				Slots[i] = INDEX_NONE;
+			}
+		}
+
+		Slots[Offset] = Index;
+		NumIndexed++;
+	}
+
+	// Incrementally unregister an element that was removed from the array at Index, shifting down every element after it.
+	// The array must be sorted by key, so that only the slots after the removed key need to be patched.
+	void NotifyRemoved(const int32 KeyValue, const int32 Index)
+	{
+		if (!bIsValid || !bIsUsable)
+		{
+			Invalidate();
+			return;
+		}
+
+		const int32 Offset = KeyValue - BaseKey;
+		if (!Slots.IsValidIndex(Offset) || Slots[Offset] != Index)
+		{
+			Invalidate();
+			return;
+		}
+
+		Slots[Offset] = INDEX_NONE;
+		for (int32 i = Offset + 1; i < Slots.Num(); ++i)
+		{
+			if (Slots[i] != INDEX_NONE)
+			{
+				Slots[i]--;
+			}
+		}
+		NumIndexed--;
+
+		// Dead keys are not trimmed here, so once they take up too much of the table, let the next rebuild rebase it.
+		if (Slots.Num() > NumIndexed * MaxSparseness + SparsenessSlack)
+		{
+			Invalidate();
+		}
+	}
+
+	UE_REWRITE SIZE_T GetAllocatedSize() const
+	{
+		return Slots.GetAllocatedSize();
+	}
+
+private:
+	// Index into the array for each key value, offset by BaseKey.
+	TArray<int32> Slots;
+
+	// The key value stored in Slots[0].
+	int32 BaseKey = 0;
+
+	// The number of elements the array had when the table was last brought up to date.
+	int32 NumIndexed = 0;
+
+	bool bIsValid = false;
+	bool bIsUsable = true;
+};
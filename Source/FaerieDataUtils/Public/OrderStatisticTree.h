@@ -0,0 +1,341 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/Array.h"
+
+/**
+ * An ordered sequence of elements, that supports insertion, removal, and index-of in O(log n) expected time.
+ * This is a treap, where each node tracks the size of its subtree, stored in a flat node array.
+ * Elements are addressed by handles returned from Insert/Add. Handles stay valid until their element is removed. Removal
+ * and IndexOf work from the handle alone, and never compare elements, so elements whose sort order has gone stale can
+ * still be removed safely.
+ */
+template <typename ElementType>
+class TOrderStatisticTree
+{
+	struct FNode
+	{
+		ElementType Value;
+		int32 Left = INDEX_NONE;
+		int32 Right = INDEX_NONE;
+		int32 Parent = INDEX_NONE;
+		int32 Size = 1;
+		uint32 Priority = 0;
+	};
+
+public:
+	[[nodiscard]] int32 Num() const { return Root == INDEX_NONE ? 0 : Nodes[Root].Size; }
+	[[nodiscard]] bool IsEmpty() const { return Root == INDEX_NONE; }
+
+	void Reset()
+	{
+		Nodes.Reset();
+		Root = INDEX_NONE;
+		FreeHead = INDEX_NONE;
+	}
+
+	void Reserve(const int32 Number)
+	{
+		Nodes.Reserve(Number);
+	}
+
+	// Insert an element after all elements that it is not less than. Returns the handle to the new element.
+	template <typename TLess>
+	int32 Insert(const ElementType& Value, TLess Less)
+	{
+		const int32 Handle = AllocateNode(Value);
+		if (Root == INDEX_NONE)
+		{
+			Root = Handle;
+			return Handle;
+		}
+
+		int32 Current = Root;
+		while (true)
+		{
+			Nodes[Current].Size++;
+			int32& Child = Less(Nodes[Handle].Value, Nodes[Current].Value) ? Nodes[Current].Left : Nodes[Current].Right;
+			if (Child == INDEX_NONE)
+			{
+				Child = Handle;
+				Nodes[Handle].Parent = Current;
+				break;
+			}
+			Current = Child;
+		}
+
+		while (Nodes[Handle].Parent != INDEX_NONE && Nodes[Handle].Priority > Nodes[Nodes[Handle].Parent].Priority)
+		{
+			RotateUp(Handle);
+		}
+
+		return Handle;
+	}
+
+	// Append an element to the end of the sequence. Returns the handle to the new element.
+	int32 Add(const ElementType& Value)
+	{
+		return Insert(Value, [](const ElementType&, const ElementType&) { return false; });
+	}
+
+	// Remove the element with this handle. The handle is invalid afterward.
+	void Remove(const int32 Handle)
+	{
+		check(IsValidHandle(Handle));
+
+		// Rotate the node down until it is a leaf.
+		while (true)
+		{
+			const FNode& Node = Nodes[Handle];
+			if (Node.Left == INDEX_NONE && Node.Right == INDEX_NONE)
+			{
+				break;
+			}
+
+			int32 Child;
+			if (Node.Left == INDEX_NONE)
+			{
+				Child = Node.Right;
+			}
+			else if (Node.Right == INDEX_NONE)
+			{
+				Child = Node.Left;
+			}
+			else
+			{
+				Child = Nodes[Node.Left].Priority > Nodes[Node.Right].Priority ? Node.Left : Node.Right;
+			}
+			RotateUp(Child);
+		}
+
+		const int32 Parent = Nodes[Handle].Parent;
+		if (Parent == INDEX_NONE)
+		{
+			Root = INDEX_NONE;
+		}
+		else
+		{
+			FNode& ParentNode = Nodes[Parent];
+			(ParentNode.Left == Handle ? ParentNode.Left : ParentNode.Right) = INDEX_NONE;
+			for (int32 Ancestor = Parent; Ancestor != INDEX_NONE; Ancestor = Nodes[Ancestor].Parent)
+			{
+				Nodes[Ancestor].Size--;
+			}
+		}
+
+		FreeNode(Handle);
+	}
+
+	[[nodiscard]] bool IsValidHandle(const int32 Handle) const
+	{
+		return Nodes.IsValidIndex(Handle) && Nodes[Handle].Size > 0;
+	}
+
+	[[nodiscard]] const ElementType& Get(const int32 Handle) const
+	{
+		check(IsValidHandle(Handle));
+		return Nodes[Handle].Value;
+	}
+
+	// Get the position of an element in the sequence.
+	[[nodiscard]] int32 IndexOf(const int32 Handle) const
+	{
+		check(IsValidHandle(Handle));
+
+		int32 Index = SizeOf(Nodes[Handle].Left);
+		for (int32 Current = Handle; Nodes[Current].Parent != INDEX_NONE; Current = Nodes[Current].Parent)
+		{
+			const FNode& Parent = Nodes[Nodes[Current].Parent];
+			if (Parent.Right == Current)
+			{
+				Index += SizeOf(Parent.Left) + 1;
+			}
+		}
+		return Index;
+	}
+
+	// Get the handle of the element at a position in the sequence.
+	[[nodiscard]] int32 HandleAt(int32 Index) const
+	{
+		check(Index >= 0 && Index < Num());
+
+		int32 Current = Root;
+		while (true)
+		{
+			const int32 LeftSize = SizeOf(Nodes[Current].Left);
+			if (Index < LeftSize)
+			{
+				Current = Nodes[Current].Left;
+			}
+			else if (Index == LeftSize)
+			{
+				return Current;
+			}
+			else
+			{
+				Index -= LeftSize + 1;
+				Current = Nodes[Current].Right;
+			}
+		}
+	}
+
+	[[nodiscard]] const ElementType& operator[](const int32 Index) const
+	{
+		return Nodes[HandleAt(Index)].Value;
+	}
+
+	// Call a function on up to Count elements in sequence order, starting at Start.
+	template <typename TFunc>
+	void ForEachInRange(const int32 Start, const int32 Count, TFunc Func) const
+	{
+		if (Start < 0 || Start >= Num())
+		{
+			return;
+		}
+
+		int32 Current = HandleAt(Start);
+		for (int32 i = 0; i < Count && Current != INDEX_NONE; ++i)
+		{
+			Func(Nodes[Current].Value);
+			Current = Successor(Current);
+		}
+	}
+
+	// Debug function for checking balance. Walks up from every element, so is O(n log n).
+	[[nodiscard]] int32 GetHeight() const
+	{
+		int32 Height = 0;
+		for (int32 Handle = 0; Handle < Nodes.Num(); ++Handle)
+		{
+			if (Nodes[Handle].Size == 0)
+			{
+				continue;
+			}
+
+			int32 Depth = 1;
+			for (int32 Parent = Nodes[Handle].Parent; Parent != INDEX_NONE; Parent = Nodes[Parent].Parent)
+			{
+				++Depth;
+			}
+			Height = FMath::Max(Height, Depth);
+		}
+		return Height;
+	}
+
+private:
+	[[nodiscard]] int32 SizeOf(const int32 Handle) const
+	{
+		return Handle == INDEX_NONE ? 0 : Nodes[Handle].Size;
+	}
+
+	void UpdateSize(const int32 Handle)
+	{
+		FNode& Node = Nodes[Handle];
+		Node.Size = 1 + SizeOf(Node.Left) + SizeOf(Node.Right);
+	}
+
+	// Rotate a node above its parent, preserving sequence order.
+	void RotateUp(const int32 Handle)
+	{
+		const int32 Parent = Nodes[Handle].Parent;
+		const int32 GrandParent = Nodes[Parent].Parent;
+
+		if (Nodes[Parent].Left == Handle)
+		{
+			const int32 Moved = Nodes[Handle].Right;
+			Nodes[Parent].Left = Moved;
+			if (Moved != INDEX_NONE) Nodes[Moved].Parent = Parent;
+			Nodes[Handle].Right = Parent;
+		}
+		else
+		{
+			const int32 Moved = Nodes[Handle].Left;
+			Nodes[Parent].Right = Moved;
+			if (Moved != INDEX_NONE) Nodes[Moved].Parent = Parent;
+			Nodes[Handle].Left = Parent;
+		}
+
+		Nodes[Parent].Parent = Handle;
+		Nodes[Handle].Parent = GrandParent;
+
+		if (GrandParent == INDEX_NONE)
+		{
+			Root = Handle;
+		}
+		else
+		{
+			FNode& GrandParentNode = Nodes[GrandParent];
+			(GrandParentNode.Left == Parent ? GrandParentNode.Left : GrandParentNode.Right) = Handle;
+		}
+
+		UpdateSize(Parent);
+		UpdateSize(Handle);
+	}
+
+	[[nodiscard]] int32 Successor(int32 Handle) const
+	{
+		if (Nodes[Handle].Right != INDEX_NONE)
+		{
+			Handle = Nodes[Handle].Right;
+			while (Nodes[Handle].Left != INDEX_NONE)
+			{
+				Handle = Nodes[Handle].Left;
+			}
+			return Handle;
+		}
+
+		int32 Parent = Nodes[Handle].Parent;
+		while (Parent != INDEX_NONE && Nodes[Parent].Right == Handle)
+		{
+			Handle = Parent;
+			Parent = Nodes[Handle].Parent;
+		}
+		return Parent;
+	}
+
+	int32 AllocateNode(const ElementType& Value)
+	{
+		int32 Handle;
+		if (FreeHead != INDEX_NONE)
+		{
+			Handle = FreeHead;
+			FreeHead = Nodes[Handle].Left;
+			Nodes[Handle] = FNode();
+		}
+		else
+		{
+			Handle = Nodes.AddDefaulted();
+		}
+
+		FNode& Node = Nodes[Handle];
+		Node.Value = Value;
+		Node.Priority = NextPriority();
+		return Handle;
+	}
+
+	void FreeNode(const int32 Handle)
+	{
+		// Free nodes are marked with a size of 0, and linked through their Left index.
+		FNode& Node = Nodes[Handle];
+		Node.Size = 0;
+		Node.Parent = INDEX_NONE;
+		Node.Right = INDEX_NONE;
+		Node.Left = FreeHead;
+		FreeHead = Handle;
+	}
+
+	uint32 NextPriority()
+	{
+		// Xorshift. Priorities only need to be well distributed, not unpredictable.
+		PrioritySeed ^= PrioritySeed << 13;
+		PrioritySeed ^= PrioritySeed >> 17;
+		PrioritySeed ^= PrioritySeed << 5;
+		return PrioritySeed;
+	}
+
+	TArray<FNode> Nodes;
+	int32 Root = INDEX_NONE;
+	int32 FreeHead = INDEX_NONE;
+	uint32 PrioritySeed = 0x9E3779B9;
+};
@@ -4,6 +4,7 @@
 #include "FaerieContainerExtensionInterface.h"
 #include "FaerieEquipmentLog.h"
 #include "FaerieEquipmentSlot.h"
+#include "FaerieItemStorage.h"
 #include "Components/FaerieItemMeshComponent.h"
 #include "Components/SceneComponent.h"
 #include "Components/SkeletalMeshComponent.h"
@@ -91,6 +92,15 @@ void UEquipmentVisualizer::OnComponentDestroyed(const bool bDestroyingHierarchy)
 		}
 	}
 
+	for (auto&& Element : ProxyLeases)
+	{
+		if (UFaerieItemStorage* Storage = Element.Value.GetStorage())
+		{
+			Storage->ReleaseStackProxy(Element.Value);
+		}
+	}
+	ProxyLeases.Empty();
+
 	Super::OnComponentDestroyed(bDestroyingHierarchy);
 }
 
@@ -235,6 +245,7 @@ AActor* UEquipmentVisualizer::SpawnVisualActor(const FFaerieVisualKey Key, const
 		KeyedMetadata.FindOrAdd(Key).ChangeCallback.Broadcast(Key, NewActor);
 		OnAnyVisualSpawnedNative.Broadcast(Key, NewActor);
 		OnAnyVisualSpawned.Broadcast(Key, NewActor);
+		AcquireKeyProxy(Key);
 
 		return NewActor;
 	}
@@ -270,6 +281,7 @@ USceneComponent* UEquipmentVisualizer::SpawnVisualComponent(const FFaerieVisualK
 		KeyedMetadata.FindOrAdd(Key).ChangeCallback.Broadcast(Key, NewComponent);
 		OnAnyVisualSpawnedNative.Broadcast(Key, NewComponent);
 		OnAnyVisualSpawned.Broadcast(Key, NewComponent);
+		AcquireKeyProxy(Key);
 
 		return NewComponent;
 	}
@@ -293,6 +305,7 @@ bool UEquipmentVisualizer::DestroyVisual(UObject* Visual, const bool ClearMetada
 
 		OnAnyVisualDestroyedNative.Broadcast(Key);
 		OnAnyVisualDestroyed.Broadcast(Key);
+		ReleaseKeyProxy(Key);
 
 		return true;
 	}
@@ -304,6 +317,7 @@ bool UEquipmentVisualizer::DestroyVisual(UObject* Visual, const bool ClearMetada
 
 		OnAnyVisualDestroyedNative.Broadcast(Key);
 		OnAnyVisualDestroyed.Broadcast(Key);
+		ReleaseKeyProxy(Key);
 
 		return true;
 	}
@@ -328,6 +342,7 @@ bool UEquipmentVisualizer::DestroyVisualByKey(const FFaerieVisualKey Key, const
 
 		OnAnyVisualDestroyedNative.Broadcast(Key);
 		OnAnyVisualDestroyed.Broadcast(Key);
+		ReleaseKeyProxy(Key);
 
 		ReverseMap.Remove(Visual);
 
@@ -341,6 +356,7 @@ bool UEquipmentVisualizer::DestroyVisualByKey(const FFaerieVisualKey Key, const
 
 		OnAnyVisualDestroyedNative.Broadcast(Key);
 		OnAnyVisualDestroyed.Broadcast(Key);
+		ReleaseKeyProxy(Key);
 
 		ReverseMap.Remove(VisualComponent);
 
@@ -510,6 +526,36 @@ void UEquipmentVisualizer::AwaitOrReceiveUpdate(const FFaerieVisualKey Key, cons
 	}
 }
 
+void UEquipmentVisualizer::AcquireKeyProxy(const FFaerieVisualKey Key)
+{
+	// Hold stack proxies used as keys, so their storage cannot recycle them while they have a visual.
+	if (!ProxyLeases.Contains(Key))
+	{
+		if (const FFaerieStackProxyLease Lease = UFaerieItemStorage::AcquireExistingStackProxy(Key.Proxy);
+			Lease.IsValid())
+		{
+			ProxyLeases.Add(Key, Lease);
+		}
+	}
+}
+
+void UEquipmentVisualizer::ReleaseKeyProxy(const FFaerieVisualKey Key)
+{
+	if (HasVisualForKey(Key))
+	{
+		return;
+	}
+
+	if (FFaerieStackProxyLease Lease;
+		ProxyLeases.RemoveAndCopyValue(Key, Lease))
+	{
+		if (UFaerieItemStorage* Storage = Lease.GetStorage())
+		{
+			Storage->ReleaseStackProxy(Lease);
+		}
+	}
+}
+
 FFaerieVisualKey UEquipmentVisualizer::MakeVisualKeyFromProxy(const TScriptInterface<IFaerieItemDataProxy>& Proxy)
 {
 	return { Proxy.GetInterface() };
@@ -517,14 +563,14 @@ FFaerieVisualKey UEquipmentVisualizer::MakeVisualKeyFromProxy(const TScriptInter
 
 void UEquipmentVisualizer::OnVisualActorDestroyed(AActor* DestroyedActor)
 {
-	if (const FFaerieVisualKey* Key = ReverseMap.Find(DestroyedActor))
+	FFaerieVisualKey Key;
+	if (ReverseMap.RemoveAndCopyValue(DestroyedActor, Key))
 	{
-		SpawnedActors.Remove(*Key);
-		OnAnyVisualDestroyedNative.Broadcast(*Key);
-		OnAnyVisualDestroyed.Broadcast(*Key);
+		SpawnedActors.Remove(Key);
+		OnAnyVisualDestroyedNative.Broadcast(Key);
+		OnAnyVisualDestroyed.Broadcast(Key);
+		ReleaseKeyProxy(Key);
 	}
-
-	ReverseMap.Remove(DestroyedActor);
 }
 
 /*
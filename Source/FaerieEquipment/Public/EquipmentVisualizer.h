@@ -3,6 +3,7 @@
 #pragma once
 
 #include "FaerieItemProxy.h"
+#include "ItemStackProxy.h"
 #include "Components/ActorComponent.h"
 #include "UObject/WeakInterfacePtr.h"
 #include "UObject/ObjectKey.h"
@@ -212,6 +213,13 @@ protected:
 	TMap<FFaerieVisualKey, FEquipmentVisualMetadata> KeyedMetadata;
 
 private:
+	void AcquireKeyProxy(FFaerieVisualKey Key);
+	void ReleaseKeyProxy(FFaerieVisualKey Key);
+
+	// Leases on keys that are stack proxies, held while the key has a visual.
+	UPROPERTY()
+	TMap<FFaerieVisualKey, FFaerieStackProxyLease> ProxyLeases;
+
 	Faerie::Equipment::FVisualSpawned OnAnyVisualSpawnedNative;
 	Faerie::Equipment::FVisualDestroyed OnAnyVisualDestroyedNative;
 };
\ No newline at end of file
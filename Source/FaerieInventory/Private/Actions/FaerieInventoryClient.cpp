@@ -5,15 +5,47 @@
 #include "FaerieInventoryLog.h"
 #include "Actions/FaerieClientActionBase.h"
 #include "GameFramework/Actor.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieInventoryClient)
 
+DECLARE_STATS_GROUP(TEXT("FaerieInventoryClient"), STATGROUP_FaerieInventoryClient, STATCAT_Advanced);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queued Actions"), STAT_Client_QueuedActions, STATGROUP_FaerieInventoryClient);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Action RPCs Sent"), STAT_Client_ActionRPCs, STATGROUP_FaerieInventoryClient);
+
+namespace Faerie::Client
+{
+	static bool CoalesceActions = true;
+	static FAutoConsoleVariableRef CVarCoalesceActions(
+		TEXT("fae.Client.CoalesceActions"),
+		CoalesceActions,
+		TEXT("Queue action requests made by clients in the same frame, and send them to the server in a single batch."));
+
+	static int32 MaxActionsPerBatch = 64;
+	static FAutoConsoleVariableRef CVarMaxActionsPerBatch(
+		TEXT("fae.Client.MaxActionsPerBatch"),
+		MaxActionsPerBatch,
+		TEXT("Most queued actions to send in one batch. Larger queues are split across multiple batches, in order."));
+}
+
+using namespace Faerie;
+
 UFaerieInventoryClient::UFaerieInventoryClient()
 {
 	PrimaryComponentTick.bCanEverTick = false;
 	SetIsReplicatedByDefault(true);
 }
 
+void UFaerieInventoryClient::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Don't drop requests made on the last frame.
+	FlushQueuedActions();
+	Super::EndPlay(EndPlayReason);
+}
+
 bool UFaerieInventoryClient::CanAccessContainer(const TNotNull<const UFaerieItemContainerBase*> Container, const UScriptStruct* RequestType) const
 {
 	// @todo implement
@@ -41,7 +73,25 @@ void UFaerieInventoryClient::RequestExecuteAction(const FFaerieClientActionBase&
 		// Otherwise, use the RPC version.
 		TInstancedStruct<FFaerieClientActionBase> ArgsWrapper;
 		ArgsWrapper.InitializeAs(Args);
-		RequestExecuteAction(ArgsWrapper);
+		SendOrQueueAction(MoveTemp(ArgsWrapper));
+	}
+}
+
+void UFaerieInventoryClient::RequestExecuteAction(const TInstancedStruct<FFaerieClientActionBase>& Args)
+{
+	if (!Args.IsValid())
+	{
+		return;
+	}
+
+	if (GetOwner()->HasAuthority())
+	{
+		// If called on a server, run immediately.
+		Server_RequestExecuteAction(Args.Get());
+	}
+	else
+	{
+		SendOrQueueAction(CopyTemp(Args));
 	}
 }
 
@@ -62,7 +112,122 @@ void UFaerieInventoryClient::RequestExecuteAction_Batch(const TArray<const FFaer
 			TInstancedStruct<FFaerieClientActionBase>& ElementWrapper = ArrayWrapper.AddDefaulted_GetRef();
 			ElementWrapper.InitializeAs(*Element);
 		}
-		RequestExecuteAction_Batch(ArrayWrapper, Type);
+		SendOrQueueBatch(MoveTemp(ArrayWrapper), Type);
+	}
+}
+
+void UFaerieInventoryClient::RequestExecuteAction_Batch(const TArray<TInstancedStruct<FFaerieClientActionBase>>& Args,
+														const EFaerieClientRequestBatchType Type)
+{
+	if (GetOwner()->HasAuthority())
+	{
+		// If called on a server, run immediately.
+		SendExecuteAction_Batch(Args, Type);
+	}
+	else if (!Args.ContainsByPredicate([](const TInstancedStruct<FFaerieClientActionBase>& Element) { return !Element.IsValid(); }))
+	{
+		// The server drops batches with invalid elements, so don't queue any part of them.
+		SendOrQueueBatch(CopyTemp(Args), Type);
+	}
+}
+
+int32 UFaerieInventoryClient::FlushQueuedActions()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(FlushQueuedActionsTimer);
+	}
+
+	if (QueuedActions.IsEmpty())
+	{
+		return 0;
+	}
+
+	// Take the queue, in case sending somehow queues more.
+	TArray<TInstancedStruct<FFaerieClientActionBase>> Actions = MoveTemp(QueuedActions);
+	QueuedActions.Reset();
+	SET_DWORD_STAT(STAT_Client_QueuedActions, 0);
+
+	if (Actions.Num() == 1)
+	{
+		INC_DWORD_STAT(STAT_Client_ActionRPCs);
+		SendExecuteAction(Actions[0]);
+		return 1;
+	}
+
+	// Split very large queues, so that no single batch becomes too large to send.
+	const int32 BatchSize = FMath::Max(1, Client::MaxActionsPerBatch);
+	if (Actions.Num() <= BatchSize)
+	{
+		INC_DWORD_STAT(STAT_Client_ActionRPCs);
+		SendExecuteAction_Batch(Actions, EFaerieClientRequestBatchType::Individuals);
+		return 1;
+	}
+
+	int32 Batches = 0;
+	for (int32 First = 0; First < Actions.Num(); First += BatchSize)
+	{
+		const int32 Count = FMath::Min(BatchSize, Actions.Num() - First);
+		INC_DWORD_STAT(STAT_Client_ActionRPCs);
+		SendExecuteAction_Batch(TArray<TInstancedStruct<FFaerieClientActionBase>>(Actions.GetData() + First, Count),
+			EFaerieClientRequestBatchType::Individuals);
+		++Batches;
+	}
+	return Batches;
+}
+
+void UFaerieInventoryClient::QueueAction(TInstancedStruct<FFaerieClientActionBase>&& Args)
+{
+	UWorld* World = GetWorld();
+	if (!IsValid(World))
+	{
+		INC_DWORD_STAT(STAT_Client_ActionRPCs);
+		SendExecuteAction(Args);
+		return;
+	}
+
+	QueuedActions.Add(MoveTemp(Args));
+	SET_DWORD_STAT(STAT_Client_QueuedActions, QueuedActions.Num());
+
+	// Send everything queued this frame during the next world tick, before the net driver flushes.
+	if (!FlushQueuedActionsTimer.IsValid())
+	{
+		FlushQueuedActionsTimer = World->GetTimerManager().SetTimerForNextTick(
+			FTimerDelegate::CreateWeakLambda(this, [this] { FlushQueuedActions(); }));
+	}
+}
+
+void UFaerieInventoryClient::SendOrQueueAction(TInstancedStruct<FFaerieClientActionBase>&& Args)
+{
+	if (Client::CoalesceActions)
+	{
+		QueueAction(MoveTemp(Args));
+	}
+	else
+	{
+		// Anything queued before coalescing was disabled must still run first.
+		FlushQueuedActions();
+		INC_DWORD_STAT(STAT_Client_ActionRPCs);
+		SendExecuteAction(Args);
+	}
+}
+
+void UFaerieInventoryClient::SendOrQueueBatch(TArray<TInstancedStruct<FFaerieClientActionBase>>&& Args, const EFaerieClientRequestBatchType Type)
+{
+	if (Type == EFaerieClientRequestBatchType::Individuals && Client::CoalesceActions)
+	{
+		// Individuals run the same whether batched or not, so they can join the queue.
+		for (TInstancedStruct<FFaerieClientActionBase>& Element : Args)
+		{
+			QueueAction(MoveTemp(Element));
+		}
+	}
+	else
+	{
+		// Anything queued must run before this batch.
+		FlushQueuedActions();
+		INC_DWORD_STAT(STAT_Client_ActionRPCs);
+		SendExecuteAction_Batch(Args, Type);
 	}
 }
 
@@ -85,7 +250,21 @@ void UFaerieInventoryClient::RequestMoveAction(const FFaerieClientAction_MoveHan
 	}
 }
 
-void UFaerieInventoryClient::RequestExecuteAction_Implementation(const TInstancedStruct<FFaerieClientActionBase>& Args)
+void UFaerieInventoryClient::RequestMoveAction(const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveFrom,
+											   const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveTo)
+{
+	if (!GetOwner()->HasAuthority())
+	{
+		// Anything queued must run before this move.
+		FlushQueuedActions();
+		INC_DWORD_STAT(STAT_Client_ActionRPCs);
+	}
+
+	// On a server, this runs immediately.
+	SendMoveAction(MoveFrom, MoveTo);
+}
+
+void UFaerieInventoryClient::SendExecuteAction_Implementation(const TInstancedStruct<FFaerieClientActionBase>& Args)
 {
 	if (Args.IsValid())
 	{
@@ -93,7 +272,7 @@ void UFaerieInventoryClient::RequestExecuteAction_Implementation(const TInstance
 	}
 }
 
-void UFaerieInventoryClient::RequestExecuteAction_Batch_Implementation(
+void UFaerieInventoryClient::SendExecuteAction_Batch_Implementation(
 	const TArray<TInstancedStruct<FFaerieClientActionBase>>& Args, const EFaerieClientRequestBatchType Type)
 {
 	TArray<const FFaerieClientActionBase*> ExecuteArray;
@@ -109,7 +288,7 @@ void UFaerieInventoryClient::RequestExecuteAction_Batch_Implementation(
 	Server_RequestExecuteAction_Batch(ExecuteArray, Type);
 }
 
-void UFaerieInventoryClient::RequestMoveAction_Implementation(
+void UFaerieInventoryClient::SendMoveAction_Implementation(
 	const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveFrom,
 	const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveTo)
 {
@@ -153,6 +332,193 @@ void UFaerieInventoryClient::SetStackChoicePromptHandler(const FFaerieClientStac
 	StackPromptHandler = Handler;
 }
 
+void UFaerieInventoryClient::ViewStoragePages(UFaerieItemStorage* Storage, const TArray<int32>& Pages)
+{
+	// The server always has every page.
+	if (!IsValid(Storage) ||
+		!Storage->UsesPagedReplication() ||
+		GetOwner()->HasAuthority())
+	{
+		return;
+	}
+
+	// Only the last pages requested can be kept, so skip the rest.
+	TConstArrayView<int32> Viewed = Pages;
+	if (Viewed.Num() > MaxResidentStoragePages)
+	{
+		Viewed = Viewed.Right(MaxResidentStoragePages);
+	}
+
+	TArray<int32> Acquired;
+	for (const int32 Page : Viewed)
+	{
+		const FStoragePage StoragePage(Storage, Page);
+		if (const int32 Existing = ResidentStoragePages.Find(StoragePage);
+			Existing != INDEX_NONE)
+		{
+			// Move to most recently viewed.
+			ResidentStoragePages.RemoveAt(Existing);
+			ResidentStoragePages.Add(StoragePage);
+			continue;
+		}
+
+		ResidentStoragePages.Add(StoragePage);
+		Storage->Client_SetPageResident(Page, true);
+		Acquired.Add(Page);
+	}
+
+	TArray<int32> Released;
+	while (ResidentStoragePages.Num() > MaxResidentStoragePages)
+	{
+		const FStoragePage Oldest = ResidentStoragePages[0];
+		ResidentStoragePages.RemoveAt(0);
+
+		if (UFaerieItemStorage* OldestStorage = Oldest.Key.Get())
+		{
+			OldestStorage->Client_SetPageResident(Oldest.Value, false);
+			if (OldestStorage == Storage)
+			{
+				Released.Add(Oldest.Value);
+			}
+			else
+			{
+				RequestStoragePages(OldestStorage, {}, { Oldest.Value });
+			}
+		}
+	}
+
+	if (!Acquired.IsEmpty() || !Released.IsEmpty())
+	{
+		RequestStoragePages(Storage, Acquired, Released);
+	}
+}
+
+void UFaerieInventoryClient::ViewStorageRange(UFaerieItemStorage* Storage, const int32 First, const int32 Count)
+{
+	if (!IsValid(Storage))
+	{
+		return;
+	}
+
+	TArray<int32> Pages;
+	Storage->GetPagesInIndexRange(First, Count, Pages);
+	ViewStoragePages(Storage, Pages);
+}
+
+void UFaerieInventoryClient::ReleaseStoragePages(UFaerieItemStorage* Storage)
+{
+	if (!IsValid(Storage))
+	{
+		return;
+	}
+
+	TArray<int32> Released;
+	for (int32 i = ResidentStoragePages.Num() - 1; i >= 0; --i)
+	{
+		if (ResidentStoragePages[i].Key == Storage)
+		{
+			Released.Add(ResidentStoragePages[i].Value);
+			Storage->Client_SetPageResident(ResidentStoragePages[i].Value, false);
+			ResidentStoragePages.RemoveAt(i);
+		}
+	}
+
+	if (!Released.IsEmpty())
+	{
+		RequestStoragePages(Storage, {}, Released);
+	}
+}
+
+void UFaerieInventoryClient::RequestStoragePages_Implementation(UFaerieItemStorage* Storage, const TArray<int32>& Acquired,
+																const TArray<int32>& Released)
+{
+	if (!IsValid(Storage) ||
+		!CanAccessContainer(Storage, nullptr))
+	{
+		return;
+	}
+
+	APlayerController* Player = GetOwningPlayerController();
+	if (!IsValid(Player))
+	{
+		return;
+	}
+
+	// Only pages this client is being sent can be released, so a client cannot make the server name groups for others.
+	TArray<int32> ValidReleased;
+	for (const int32 Page : Released)
+	{
+		if (RelevantStoragePages.Remove(FStoragePage(Storage, Page)))
+		{
+			ValidReleased.Add(Page);
+		}
+	}
+	Storage->Server_SetPagesRelevant(Player, ValidReleased, false);
+
+	// Only pages covered by the index can be acquired, up to as many as the client may keep resident. Clients evict pages
+	// before requesting more, and request pages from their copy of the index, so a well-behaved client only has pages
+	// rejected when the index has shrunk since. It has already made them resident, so it is told which were rejected.
+	RelevantStoragePages.RemoveAll([](const FStoragePage& Page) { return !Page.Key.IsValid(); });
+	const int32 PageCount = Storage->GetIndexedPageCount();
+
+	TArray<int32> ValidAcquired;
+	TArray<int32> Rejected;
+	for (const int32 Page : Acquired)
+	{
+		const FStoragePage StoragePage(Storage, Page);
+		if (RelevantStoragePages.Contains(StoragePage))
+		{
+			continue;
+		}
+
+		if (Page < 0 || Page >= PageCount ||
+			RelevantStoragePages.Num() >= MaxResidentStoragePages)
+		{
+			Rejected.Add(Page);
+			continue;
+		}
+
+		RelevantStoragePages.Add(StoragePage);
+		ValidAcquired.Add(Page);
+	}
+	Storage->Server_SetPagesRelevant(Player, ValidAcquired, true);
+
+	if (!Rejected.IsEmpty())
+	{
+		UE_LOG(LogFaerieInventory, Warning, TEXT("Client requested storage pages that are not indexed, or more than it may keep resident!"))
+		RejectStoragePages(Storage, Rejected);
+	}
+}
+
+void UFaerieInventoryClient::RejectStoragePages_Implementation(UFaerieItemStorage* Storage, const TArray<int32>& Pages)
+{
+	if (!IsValid(Storage))
+	{
+		return;
+	}
+
+	for (const int32 Page : Pages)
+	{
+		if (ResidentStoragePages.Remove(FStoragePage(Storage, Page)))
+		{
+			Storage->Client_SetPageResident(Page, false);
+		}
+	}
+}
+
+APlayerController* UFaerieInventoryClient::GetOwningPlayerController() const
+{
+	if (APlayerController* Player = Cast<APlayerController>(GetOwner()))
+	{
+		return Player;
+	}
+	if (const APawn* Pawn = Cast<APawn>(GetOwner()))
+	{
+		return Pawn->GetController<APlayerController>();
+	}
+	return nullptr;
+}
+
 void UFaerieInventoryClient::Server_RequestExecuteAction(const FFaerieClientActionBase& Args)
 {
 	(void)Args.Server_Execute(this);
@@ -8,16 +8,46 @@
 #include "FaerieItemDataComparator.h"
 #include "FaerieItemDataFilter.h"
 #include "FaerieItemStorage.h"
+#include "Extensions/ItemContainerExtensionEvents.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieContainerQuery)
 
 DECLARE_STATS_GROUP(TEXT("FaerieItemStorage"), STATGROUP_FaerieItemStorageQuery, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("Query (First)"), STAT_Storage_QueryFirst, STATGROUP_FaerieItemStorageQuery);
 DECLARE_CYCLE_STAT(TEXT("Query (All)"), STAT_Storage_QueryAll, STATGROUP_FaerieItemStorageQuery);
+DECLARE_CYCLE_STAT(TEXT("Query (Live Update)"), STAT_Storage_QueryLiveUpdate, STATGROUP_FaerieItemStorageQuery);
+
+namespace Faerie::Container
+{
+	static int32 ParallelFilterThreshold = 4096;
+	static FAutoConsoleVariableRef CVarParallelFilterThreshold(
+		TEXT("fae.Query.ParallelFilterThreshold"),
+		ParallelFilterThreshold,
+		TEXT("Queries with a thread-safe filter run it in parallel on containers with at least this many addresses."));
+
+	// Number of addresses filtered by each parallel task.
+	static constexpr int32 ParallelFilterBatchSize = 256;
+
+	static bool CompileFilters = true;
+	static FAutoConsoleVariableRef CVarCompileFilters(
+		TEXT("fae.Query.CompileFilters"),
+		CompileFilters,
+		TEXT("Compile filter objects set on queries into a flat instruction program, instead of running their rule tree."));
+}
 
 using namespace Faerie::ItemData;
 using namespace Faerie::Container;
 
+void UFaerieContainerQuery::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	Super::AddReferencedObjects(InThis, Collector);
+
+	// Child filters may be removed from the filter tree after compiling, leaving the program as their only reference.
+	CastChecked<ThisClass>(InThis)->CompiledFilter.AddReferencedObjects(Collector);
+}
+
 bool UFaerieContainerQuery::IsSortBound() const
 {
 	return SortFunction.IsBound();
@@ -28,13 +58,21 @@ bool UFaerieContainerQuery::IsFilterBound() const
 	return FilterFunction.IsBound();
 }
 
+void UFaerieContainerQuery::NotifyQueryChanged()
+{
+	LiveRebuildPending = true;
+	OnQueryChanged.Broadcast(this);
+}
+
 void UFaerieContainerQuery::SetFilter(FViewPredicate&& Predicate, const UObject* AssociatedUObject)
 {
 	if (Predicate.IsBound())
 	{
 		FilterFunction = MoveTemp(Predicate);
 		FilterObject = AssociatedUObject;
-		OnQueryChanged.Broadcast(this);
+		FilterByObject = false;
+		CompiledFilter.Reset();
+		NotifyQueryChanged();
 	}
 	else
 	{
@@ -50,7 +88,9 @@ void UFaerieContainerQuery::SetFilterByDelegate(const FFaerieViewPredicate& Dele
 		// invisible to the Delegate's parameter type of 'const FFaerieItemDataViewWrapper&'.
 		FilterFunction = DYNAMIC_TO_NATIVE(FViewPredicate, Delegate);
 		FilterObject = nullptr;
-		OnQueryChanged.Broadcast(this);
+		FilterByObject = false;
+		CompiledFilter.Reset();
+		NotifyQueryChanged();
 	}
 	else
 	{
@@ -62,9 +102,24 @@ void UFaerieContainerQuery::SetFilterByObject(const UFaerieItemDataFilter* Objec
 {
 	if (Object != FilterObject)
 	{
-		FilterFunction = FViewPredicate::CreateUObject(Object, &UFaerieItemDataFilter::ExecView);
 		FilterObject = Object;
-		OnQueryChanged.Broadcast(this);
+		FilterByObject = IsValid(Object);
+		CompiledFilter.Reset();
+		FilterMemo.Reset();
+
+		if (FilterByObject)
+		{
+			if (CompileFilters)
+			{
+				CompiledFilter = FFilterProgram::Compile(Object);
+			}
+			FilterFunction = FViewPredicate::CreateUObject(this, &ThisClass::ExecFilterObject);
+		}
+		else
+		{
+			FilterFunction.Unbind();
+		}
+		NotifyQueryChanged();
 	}
 	else
 	{
@@ -78,7 +133,8 @@ void UFaerieContainerQuery::SetSort(FViewComparator&& Comparator, const UObject*
 	{
 		SortFunction = MoveTemp(Comparator);
 		SortObject = AssociatedUObject;
-		OnQueryChanged.Broadcast(this);
+		SortByKey = false;
+		NotifyQueryChanged();
 	}
 	else
 	{
@@ -92,7 +148,8 @@ void UFaerieContainerQuery::SetSortByDelegate(const UFaerieFunctionTemplates::FF
 	{
 		SortFunction = DYNAMIC_TO_NATIVE(FViewComparator, Delegate);
 		SortObject = nullptr;
-		OnQueryChanged.Broadcast(this);
+		SortByKey = false;
+		NotifyQueryChanged();
 	}
 	else
 	{
@@ -106,7 +163,8 @@ void UFaerieContainerQuery::SetSortByObject(const UFaerieItemDataComparator* Com
 	{
 		SortObject = Comparator;
 		SortFunction = FViewComparator::CreateUObject(Comparator, &UFaerieItemDataComparator::Exec);
-		OnQueryChanged.Broadcast(this);
+		SortByKey = IsValid(Comparator) && Comparator->HasSortKey();
+		NotifyQueryChanged();
 	}
 	else
 	{
@@ -119,7 +177,7 @@ void UFaerieContainerQuery::SetInvertFilter(const bool Invert)
 	if (Invert != InvertFilter)
 	{
 		InvertFilter = Invert;
-		OnQueryChanged.Broadcast(this);
+		NotifyQueryChanged();
 	}
 }
 
@@ -128,7 +186,16 @@ void UFaerieContainerQuery::SetInvertSort(const bool Invert)
 	if (Invert != InvertSort)
 	{
 		InvertSort = Invert;
-		OnQueryChanged.Broadcast(this);
+		NotifyQueryChanged();
+	}
+}
+
+void UFaerieContainerQuery::SetMemoizeFilter(const bool Memoize)
+{
+	if (Memoize != MemoizeFilter)
+	{
+		MemoizeFilter = Memoize;
+		FilterMemo.Reset();
 	}
 }
 
@@ -138,7 +205,10 @@ void UFaerieContainerQuery::ResetFilter()
 	{
 		FilterFunction.Unbind();
 		FilterObject = nullptr;
-		OnQueryChanged.Broadcast(this);
+		FilterByObject = false;
+		CompiledFilter.Reset();
+		FilterMemo.Reset();
+		NotifyQueryChanged();
 	}
 }
 
@@ -148,7 +218,8 @@ void UFaerieContainerQuery::ResetSort()
 	{
 		SortFunction.Unbind();
 		SortObject = nullptr;
-		OnQueryChanged.Broadcast(this);
+		SortByKey = false;
+		NotifyQueryChanged();
 	}
 }
 
@@ -191,7 +262,11 @@ void UFaerieContainerQuery::QueryAllAddresses(const UFaerieItemContainerBase* Co
 	// Ensure we are starting with a blank slate.
 	OutAddresses.Empty();
 
-	if (IsFilterBound())
+	if (IsFilterBound() && IsFilterThreadSafe())
+	{
+		FilterAddressesInParallel(Container, OutAddresses);
+	}
+	else if (IsFilterBound())
 	{
 		FCallbackFilter IteratorPredicate{
 			FIteratorPredicate::CreateUObject(this, &ThisClass::IsIteratorFiltered)};
@@ -218,11 +293,18 @@ void UFaerieContainerQuery::QueryAllAddresses(const UFaerieItemContainerBase* Co
 
 	if (IsSortBound())
 	{
-		Algo::Sort(OutAddresses,
-			[this, Container](const FFaerieAddress A, const FFaerieAddress B)
-			{
-				return CompareAddresses_Impl(Container, A, B);
-			});
+		if (SortByKey)
+		{
+			SortAddressesByKey(Container, OutAddresses);
+		}
+		else
+		{
+			Algo::Sort(OutAddresses,
+				[this, Container](const FFaerieAddress A, const FFaerieAddress B)
+				{
+					return CompareAddresses_Impl(Container, A, B);
+				});
+		}
 	}
 }
 
@@ -241,6 +323,14 @@ namespace
 		const TNotNull<const IFaerieItemOwnerInterface*> Owner;
 		const FFaerieItemStackView Stack;
 	};
+
+	// Orders by sort key, then by address, so that full sorts and incremental inserts agree on the order of ties.
+	bool IsKeyedLess(const FSortKey& KeyA, const FFaerieAddress AddressA, const FSortKey& KeyB, const FFaerieAddress AddressB, const bool Invert)
+	{
+		if (KeyA < KeyB) return !Invert;
+		if (KeyB < KeyA) return Invert;
+		return AddressA < AddressB;
+	}
 }
 
 bool UFaerieContainerQuery::CompareAddresses(const UFaerieItemContainerBase* Container, const FFaerieAddress AddressA, const FFaerieAddress AddressB) const
@@ -279,15 +369,380 @@ bool UFaerieContainerQuery::CompareAddresses_Impl(const TNotNull<const UFaerieIt
 	const FImmediateView ViewA(Container, Container->ViewStack(AddressA));
 	const FImmediateView ViewB(Container, Container->ViewStack(AddressB));
 
-	if (InvertSort)
+	// This is the single ordering used by every sort path, so it must match SortAddressesByKey exactly.
+	if (SortByKey)
+	{
+		const UFaerieItemDataComparator* Comparator = CastChecked<UFaerieItemDataComparator>(SortObject);
+		return IsKeyedLess(Comparator->ExtractSortKey(&ViewA), AddressA, Comparator->ExtractSortKey(&ViewB), AddressB, InvertSort);
+	}
+
+	// SortFunction is assumed to be a strict ordering, so the reverse comparison is only needed when A is not less than
+	// B, to tell B < A apart from a tie.
+	if (SortFunction.Execute(&ViewA, &ViewB))
+	{
+		return !InvertSort;
+	}
+
+	if (SortFunction.Execute(&ViewB, &ViewA))
+	{
+		return InvertSort;
+	}
+
+	// Ties are ordered by address, regardless of InvertSort.
+	return AddressA < AddressB;
+}
+
+bool UFaerieContainerQuery::ExecFilterObject(const FViewPtr View) const
+{
+	if (!MemoizeFilter && CompiledFilter.IsEmpty())
 	{
-		return !SortFunction.Execute(&ViewA, &ViewB);
+		return static_cast<const UFaerieItemDataFilter*>(FilterObject.Get())->ExecView(View);
 	}
+	return ExecFilterObjectStack(View->ResolveView());
+}
 
-	return SortFunction.Execute(&ViewA, &ViewB);
+bool UFaerieContainerQuery::ExecFilterObjectStack(const FFaerieItemStackView& View) const
+{
+	auto Exec = [this, &View]
+		{
+			if (!CompiledFilter.IsEmpty())
+			{
+				return CompiledFilter.Exec(View);
+			}
+			return static_cast<const UFaerieItemDataFilter*>(FilterObject.Get())->Exec(View);
+		};
+
+	if (MemoizeFilter)
+	{
+		return FilterMemo.Exec(FilterObject, View, Exec);
+	}
+	return Exec();
 }
 
 bool UFaerieContainerQuery::IsIteratorFiltered(FIteratorPtr Iterator) const
 {
 	return FilterFunction.Execute(Iterator);
 }
+
+bool UFaerieContainerQuery::IsFilterThreadSafe() const
+{
+	return FilterByObject && CastChecked<UFaerieItemDataFilter>(FilterObject)->IsThreadSafe();
+}
+
+void UFaerieContainerQuery::FilterAddressesInParallel(const TNotNull<const UFaerieItemContainerBase*> Container, TArray<FFaerieAddress>& OutAddresses) const
+{
+	// Resolve every address in container order first. This reads the container's own lookup structures, so it stays on
+	// this thread. Only the filter itself runs on workers.
+	TArray<TPair<FFaerieAddress, FFaerieItemStackView>> Candidates;
+	for (auto It = AddressRange(Container); It; ++It)
+	{
+		Candidates.Emplace(*It, It.GetPtr()->ResolveView());
+	}
+
+	const int32 NumBatches = FMath::DivideAndRoundUp(Candidates.Num(), ParallelFilterBatchSize);
+	TArray<TArray<FFaerieAddress>> BatchResults;
+	BatchResults.SetNum(NumBatches);
+
+	ParallelFor(NumBatches,
+		[&](const int32 BatchIndex)
+		{
+			const int32 Start = BatchIndex * ParallelFilterBatchSize;
+			const int32 End = FMath::Min(Start + ParallelFilterBatchSize, Candidates.Num());
+			TArray<FFaerieAddress>& Results = BatchResults[BatchIndex];
+			for (int32 i = Start; i < End; ++i)
+			{
+				if (ExecFilterObjectStack(Candidates[i].Value) != InvertFilter)
+				{
+					Results.Add(Candidates[i].Key);
+				}
+			}
+		},
+		Candidates.Num() >= ParallelFilterThreshold ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	// Batches are contiguous runs of the container, so appending them in order keeps the results in container order.
+	for (TArray<FFaerieAddress>& Batch : BatchResults)
+	{
+		OutAddresses.Append(MoveTemp(Batch));
+	}
+}
+
+void UFaerieContainerQuery::SortAddressesByKey(const TNotNull<const UFaerieItemContainerBase*> Container, TArray<FFaerieAddress>& Addresses) const
+{
+	const UFaerieItemDataComparator* Comparator = CastChecked<UFaerieItemDataComparator>(SortObject);
+
+	// Resolve each address once to extract its key, then sort by keys alone.
+	TArray<TPair<FSortKey, FFaerieAddress>> KeyedAddresses;
+	KeyedAddresses.Reserve(Addresses.Num());
+	for (const FFaerieAddress Address : Addresses)
+	{
+		const FImmediateView View(Container, Container->ViewStack(Address));
+		KeyedAddresses.Emplace(Comparator->ExtractSortKey(&View), Address);
+	}
+
+	Algo::Sort(KeyedAddresses,
+		[Invert = InvertSort](const TPair<FSortKey, FFaerieAddress>& A, const TPair<FSortKey, FFaerieAddress>& B)
+		{
+			return IsKeyedLess(A.Key, A.Value, B.Key, B.Value, Invert);
+		});
+
+	for (int32 i = 0; i < KeyedAddresses.Num(); ++i)
+	{
+		Addresses[i] = KeyedAddresses[i].Value;
+	}
+}
+
+bool UFaerieContainerQuery::PassesFilter(const TNotNull<const UFaerieItemContainerBase*> Container, const FFaerieAddress Address) const
+{
+	if (!FilterFunction.IsBound())
+	{
+		return true;
+	}
+
+	const FImmediateView View(Container, Container->ViewStack(Address));
+	return FilterFunction.Execute(&View) != InvertFilter;
+}
+
+int32 UFaerieContainerQuery::InsertLiveResult(const TNotNull<const UFaerieItemContainerBase*> Container, const FFaerieAddress Address)
+{
+	if (IsSortBound())
+	{
+		return LiveResults.Insert(Address,
+			[this, Container](const FFaerieAddress A, const FFaerieAddress B)
+			{
+				return CompareAddresses_Impl(Container, A, B);
+			});
+	}
+
+	return LiveResults.Add(Address);
+}
+
+bool UFaerieContainerQuery::BindToContainer(UFaerieItemContainerBase* Container, const bool LiveUpdates)
+{
+	UnbindFromContainer();
+
+	if (!IsValid(Container))
+	{
+		return false;
+	}
+
+	LiveContainer = Container;
+	LiveRebuildPending = true;
+
+	if (!LiveUpdates)
+	{
+		return false;
+	}
+
+	auto EventsExtension = Faerie::Extensions::Get<UItemContainerExtensionEvents>(Container, false);
+	if (!IsValid(EventsExtension))
+	{
+		return false;
+	}
+
+	EventsExtension->GetOnPostEventBatch().AddUObject(this, &ThisClass::HandlePostEventBatch);
+	return true;
+}
+
+void UFaerieContainerQuery::UnbindFromContainer()
+{
+	if (UFaerieItemContainerBase* Container = LiveContainer.Get())
+	{
+		if (auto EventsExtension = Faerie::Extensions::Get<UItemContainerExtensionEvents>(Container, false))
+		{
+			EventsExtension->GetOnPostEventBatch().RemoveAll(this);
+		}
+	}
+
+	LiveContainer = nullptr;
+	LiveRebuildPending = false;
+	PendingLiveChanges.Empty();
+
+	if (!LiveResults.IsEmpty())
+	{
+		LiveResults.Reset();
+		LiveResultHandles.Empty();
+		OnLiveResultChanged.Broadcast(this, EQueryResultChange::Reset, FFaerieAddress(), INDEX_NONE);
+	}
+}
+
+void UFaerieContainerQuery::HandlePostEventBatch(const TNotNull<const UFaerieItemContainerBase*> Container, const Faerie::Inventory::FEventLogBatch& Events)
+{
+	if (Container != LiveContainer || LiveRebuildPending)
+	{
+		return;
+	}
+
+	for (auto&& Event : Events.Data)
+	{
+		PendingLiveChanges.Append(Event.AddressesTouched);
+	}
+}
+
+void UFaerieContainerQuery::RebuildLiveResults()
+{
+	LiveRebuildPending = false;
+	PendingLiveChanges.Reset();
+	LiveResults.Reset();
+	LiveResultHandles.Reset();
+
+	if (const UFaerieItemContainerBase* Container = LiveContainer.Get())
+	{
+		TArray<FFaerieAddress> Addresses;
+		QueryAllAddresses(Container, Addresses);
+
+		LiveResults.Reserve(Addresses.Num());
+		LiveResultHandles.Reserve(Addresses.Num());
+		for (const FFaerieAddress Address : Addresses)
+		{
+			LiveResultHandles.Add(Address, LiveResults.Add(Address));
+		}
+	}
+
+	OnLiveResultChanged.Broadcast(this, EQueryResultChange::Reset, FFaerieAddress(), INDEX_NONE);
+}
+
+void UFaerieContainerQuery::UpdateLiveResults()
+{
+	SCOPE_CYCLE_COUNTER(STAT_Storage_QueryLiveUpdate);
+
+	const UFaerieItemContainerBase* Container = LiveContainer.Get();
+	if (!IsValid(Container))
+	{
+		return;
+	}
+
+	// When most of the results have changed, it's cheaper to start over.
+	if (LiveRebuildPending || PendingLiveChanges.Num() > FMath::Max(16, LiveResults.Num() / 2))
+	{
+		RebuildLiveResults();
+		return;
+	}
+
+	if (PendingLiveChanges.IsEmpty())
+	{
+		return;
+	}
+
+	struct FLiveChange
+	{
+		FFaerieAddress Address;
+		int32 OldIndex = INDEX_NONE;
+		int32 NewIndex = INDEX_NONE;
+	};
+
+	TArray<FLiveChange> Changes;
+	Changes.Reserve(PendingLiveChanges.Num());
+	for (const FFaerieAddress Address : PendingLiveChanges)
+	{
+		FLiveChange& Change = Changes.Add_GetRef({ Address });
+		if (const int32* Handle = LiveResultHandles.Find(Address))
+		{
+			Change.OldIndex = LiveResults.IndexOf(*Handle);
+		}
+	}
+	PendingLiveChanges.Reset();
+
+	// Take every changed address out before inserting any, so that insertion never compares against an address that
+	// was removed from the container, or whose sort position is stale.
+	for (const FLiveChange& Change : Changes)
+	{
+		if (Change.OldIndex != INDEX_NONE)
+		{
+			LiveResults.Remove(LiveResultHandles.FindAndRemoveChecked(Change.Address));
+		}
+	}
+
+	for (const FLiveChange& Change : Changes)
+	{
+		if (Container->Contains(Change.Address) && PassesFilter(Container, Change.Address))
+		{
+			LiveResultHandles.Add(Change.Address, InsertLiveResult(Container, Change.Address));
+		}
+	}
+
+	bool AllInPlace = true;
+	for (FLiveChange& Change : Changes)
+	{
+		if (const int32* Handle = LiveResultHandles.Find(Change.Address))
+		{
+			Change.NewIndex = LiveResults.IndexOf(*Handle);
+		}
+		AllInPlace &= Change.OldIndex == Change.NewIndex;
+	}
+
+	if (AllInPlace)
+	{
+		for (const FLiveChange& Change : Changes)
+		{
+			if (Change.NewIndex != INDEX_NONE)
+			{
+				OnLiveResultChanged.Broadcast(this, EQueryResultChange::Updated, Change.Address, Change.NewIndex);
+			}
+		}
+		return;
+	}
+
+	// Broadcast removals from the back, then additions from the front, so each index is valid when it's received.
+	// Addresses that moved are broadcast as a removal and an addition.
+	Changes.Sort([](const FLiveChange& A, const FLiveChange& B) { return A.OldIndex > B.OldIndex; });
+	for (const FLiveChange& Change : Changes)
+	{
+		if (Change.OldIndex != INDEX_NONE)
+		{
+			OnLiveResultChanged.Broadcast(this, EQueryResultChange::Removed, Change.Address, Change.OldIndex);
+		}
+	}
+
+	Changes.Sort([](const FLiveChange& A, const FLiveChange& B) { return A.NewIndex < B.NewIndex; });
+	for (const FLiveChange& Change : Changes)
+	{
+		if (Change.NewIndex != INDEX_NONE)
+		{
+			OnLiveResultChanged.Broadcast(this, EQueryResultChange::Added, Change.Address, Change.NewIndex);
+		}
+	}
+}
+
+void UFaerieContainerQuery::RequestLiveRebuild()
+{
+	LiveRebuildPending = true;
+}
+
+int32 UFaerieContainerQuery::GetNumLiveResults() const
+{
+	return LiveResults.Num();
+}
+
+int32 UFaerieContainerQuery::GetLiveResultIndex(const FFaerieAddress Address) const
+{
+	if (const int32* Handle = LiveResultHandles.Find(Address))
+	{
+		return LiveResults.IndexOf(*Handle);
+	}
+	return INDEX_NONE;
+}
+
+FFaerieAddress UFaerieContainerQuery::GetLiveResultAt(const int32 Index) const
+{
+	if (Index >= 0 && Index < LiveResults.Num())
+	{
+		return LiveResults[Index];
+	}
+	return FFaerieAddress();
+}
+
+void UFaerieContainerQuery::GetLiveResultRange(const int32 Start, const int32 Count, TArray<FFaerieAddress>& OutAddresses) const
+{
+	OutAddresses.Reset();
+	if (Start < 0 || Count <= 0 || Start >= LiveResults.Num())
+	{
+		return;
+	}
+
+	OutAddresses.Reserve(FMath::Min(Count, LiveResults.Num() - Start));
+	LiveResults.ForEachInRange(Start, Count,
+		[&OutAddresses](const FFaerieAddress Address)
+		{
+			OutAddresses.Add(Address);
+		});
+}
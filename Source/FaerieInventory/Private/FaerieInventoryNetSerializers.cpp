@@ -0,0 +1,313 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieInventoryNetSerializers.h"
+#include "FaerieItemContainerStructs.h"
+#include "InventoryDataStructs.h"
+
+#if UE_WITH_IRIS
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+#endif
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieInventoryNetSerializers)
+
+#if UE_WITH_IRIS
+
+namespace Faerie::Inventory::Net
+{
+	// Keys are quantized as their zigzagged distance from the position of a new TKeyGen, so keys made early are small.
+	// The offset wraps, so that every int32 survives the trip.
+	static uint32 QuantizeKey(const int32 Value)
+	{
+		const int32 Offset = static_cast<int32>(static_cast<uint32>(Value) - TKeyGen<FEntryKey>::InitialPosition);
+		return (static_cast<uint32>(Offset) << 1) ^ static_cast<uint32>(Offset >> 31);
+	}
+
+	static int32 DequantizeKey(const uint32 Encoded)
+	{
+		const uint32 Offset = (Encoded >> 1) ^ (0u - (Encoded & 1));
+		return static_cast<int32>(Offset + TKeyGen<FEntryKey>::InitialPosition);
+	}
+
+	// Iris writes bits instead of bytes, so values are prefixed with their bit count rather than byte-packed.
+	static void WritePackedBits(UE::Net::FNetBitStreamWriter* Writer, const uint32 Value)
+	{
+		const uint32 NumBits = 32 - FMath::CountLeadingZeros(Value);
+		Writer->WriteBits(NumBits, 6);
+		if (NumBits)
+		{
+			Writer->WriteBits(Value, NumBits);
+		}
+	}
+
+	static uint32 ReadPackedBits(UE::Net::FNetBitStreamReader* Reader)
+	{
+		const uint32 NumBits = Reader->ReadBits(6);
+		if (NumBits > 32)
+		{
+			Reader->DoOverflow();
+			return 0;
+		}
+		return NumBits ? Reader->ReadBits(NumBits) : 0;
+	}
+}
+
+namespace UE::Net
+{
+	struct FFaerieItemKeyNetSerializer
+	{
+		static constexpr uint32 Version = 0;
+
+		typedef FFaerieItemKeyBase SourceType;
+		typedef uint32 QuantizedType;
+		typedef FFaerieItemKeyNetSerializerConfig ConfigType;
+
+		static const ConfigType DefaultConfig;
+
+		static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+		{
+			Faerie::Inventory::Net::WritePackedBits(Context.GetBitStreamWriter(), *reinterpret_cast<const QuantizedType*>(Args.Source));
+		}
+
+		static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+		{
+			*reinterpret_cast<QuantizedType*>(Args.Target) = Faerie::Inventory::Net::ReadPackedBits(Context.GetBitStreamReader());
+		}
+
+		static void Quantize(FNetSerializationContext&, const FNetQuantizeArgs& Args)
+		{
+			const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+			*reinterpret_cast<QuantizedType*>(Args.Target) = Faerie::Inventory::Net::QuantizeKey(Source.Value());
+		}
+
+		static void Dequantize(FNetSerializationContext&, const FNetDequantizeArgs& Args)
+		{
+			const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			*reinterpret_cast<SourceType*>(Args.Target) = SourceType(Faerie::Inventory::Net::DequantizeKey(Source));
+		}
+
+		static bool IsEqual(FNetSerializationContext&, const FNetIsEqualArgs& Args)
+		{
+			if (Args.bStateIsQuantized)
+			{
+				return *reinterpret_cast<const QuantizedType*>(Args.Source0) == *reinterpret_cast<const QuantizedType*>(Args.Source1);
+			}
+			return *reinterpret_cast<const SourceType*>(Args.Source0) == *reinterpret_cast<const SourceType*>(Args.Source1);
+		}
+
+	private:
+		class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+		{
+		public:
+			virtual ~FNetSerializerRegistryDelegates();
+
+		private:
+			virtual void OnPreFreezeNetSerializerRegistry() override;
+		};
+
+		static FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+	};
+
+	struct FKeyedStackNetSerializer
+	{
+		static constexpr uint32 Version = 0;
+
+		struct FQuantizedType
+		{
+			uint32 Key;
+			uint32 Stack;
+		};
+
+		typedef FKeyedStack SourceType;
+		typedef FQuantizedType QuantizedType;
+		typedef FKeyedStackNetSerializerConfig ConfigType;
+
+		static const ConfigType DefaultConfig;
+
+		static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+		{
+			const QuantizedType& Value = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			FNetBitStreamWriter* Writer = Context.GetBitStreamWriter();
+			Faerie::Inventory::Net::WritePackedBits(Writer, Value.Key);
+			Faerie::Inventory::Net::WritePackedBits(Writer, Value.Stack);
+		}
+
+		static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+		{
+			QuantizedType& Value = *reinterpret_cast<QuantizedType*>(Args.Target);
+			FNetBitStreamReader* Reader = Context.GetBitStreamReader();
+			Value.Key = Faerie::Inventory::Net::ReadPackedBits(Reader);
+			Value.Stack = Faerie::Inventory::Net::ReadPackedBits(Reader);
+		}
+
+		static void Quantize(FNetSerializationContext&, const FNetQuantizeArgs& Args)
+		{
+			const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+			QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+			Target.Key = Faerie::Inventory::Net::QuantizeKey(Source.Key.Value());
+			Target.Stack = (static_cast<uint32>(Source.Stack) << 1) ^ static_cast<uint32>(Source.Stack >> 31);
+		}
+
+		static void Dequantize(FNetSerializationContext&, const FNetDequantizeArgs& Args)
+		{
+			const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+			Target.Key = FStackKey(Faerie::Inventory::Net::DequantizeKey(Source.Key));
+			Target.Stack = static_cast<int32>((Source.Stack >> 1) ^ (0u - (Source.Stack & 1)));
+		}
+
+		static bool IsEqual(FNetSerializationContext&, const FNetIsEqualArgs& Args)
+		{
+			if (Args.bStateIsQuantized)
+			{
+				const QuantizedType& Value0 = *reinterpret_cast<const QuantizedType*>(Args.Source0);
+				const QuantizedType& Value1 = *reinterpret_cast<const QuantizedType*>(Args.Source1);
+				return Value0.Key == Value1.Key && Value0.Stack == Value1.Stack;
+			}
+			return *reinterpret_cast<const SourceType*>(Args.Source0) == *reinterpret_cast<const SourceType*>(Args.Source1);
+		}
+
+	private:
+		class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+		{
+		public:
+			virtual ~FNetSerializerRegistryDelegates();
+
+		private:
+			virtual void OnPreFreezeNetSerializerRegistry() override;
+		};
+
+		static FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+	};
+
+	// An address is an entry key in the high half, and a stack key in the low half, so each half is packed like a key.
+	struct FFaerieAddressNetSerializer
+	{
+		static constexpr uint32 Version = 0;
+
+		struct FQuantizedType
+		{
+			uint32 Entry;
+			uint32 Stack;
+		};
+
+		typedef FFaerieAddress SourceType;
+		typedef FQuantizedType QuantizedType;
+		typedef FFaerieAddressNetSerializerConfig ConfigType;
+
+		static const ConfigType DefaultConfig;
+
+		static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+		{
+			const QuantizedType& Value = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			FNetBitStreamWriter* Writer = Context.GetBitStreamWriter();
+			Faerie::Inventory::Net::WritePackedBits(Writer, Value.Entry);
+			Faerie::Inventory::Net::WritePackedBits(Writer, Value.Stack);
+		}
+
+		static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+		{
+			QuantizedType& Value = *reinterpret_cast<QuantizedType*>(Args.Target);
+			FNetBitStreamReader* Reader = Context.GetBitStreamReader();
+			Value.Entry = Faerie::Inventory::Net::ReadPackedBits(Reader);
+			Value.Stack = Faerie::Inventory::Net::ReadPackedBits(Reader);
+		}
+
+		static void Quantize(FNetSerializationContext&, const FNetQuantizeArgs& Args)
+		{
+			const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+			QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+			Target.Entry = Faerie::Inventory::Net::QuantizeKey(static_cast<int32>(Source.Address >> 32));
+			Target.Stack = Faerie::Inventory::Net::QuantizeKey(static_cast<int32>(Source.Address & 0xFFFFFFFF));
+		}
+
+		static void Dequantize(FNetSerializationContext&, const FNetDequantizeArgs& Args)
+		{
+			const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+			SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+			const int64 Entry = Faerie::Inventory::Net::DequantizeKey(Source.Entry);
+			const int64 Stack = static_cast<uint32>(Faerie::Inventory::Net::DequantizeKey(Source.Stack));
+			Target.Address = (Entry << 32) | Stack;
+		}
+
+		static bool IsEqual(FNetSerializationContext&, const FNetIsEqualArgs& Args)
+		{
+			if (Args.bStateIsQuantized)
+			{
+				const QuantizedType& Value0 = *reinterpret_cast<const QuantizedType*>(Args.Source0);
+				const QuantizedType& Value1 = *reinterpret_cast<const QuantizedType*>(Args.Source1);
+				return Value0.Entry == Value1.Entry && Value0.Stack == Value1.Stack;
+			}
+			return *reinterpret_cast<const SourceType*>(Args.Source0) == *reinterpret_cast<const SourceType*>(Args.Source1);
+		}
+
+	private:
+		class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+		{
+		public:
+			virtual ~FNetSerializerRegistryDelegates();
+
+		private:
+			virtual void OnPreFreezeNetSerializerRegistry() override;
+		};
+
+		static FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+	};
+
+	UE_NET_IMPLEMENT_SERIALIZER(FFaerieItemKeyNetSerializer);
+	UE_NET_IMPLEMENT_SERIALIZER(FKeyedStackNetSerializer);
+	UE_NET_IMPLEMENT_SERIALIZER(FFaerieAddressNetSerializer);
+
+	const FFaerieItemKeyNetSerializer::ConfigType FFaerieItemKeyNetSerializer::DefaultConfig;
+	const FKeyedStackNetSerializer::ConfigType FKeyedStackNetSerializer::DefaultConfig;
+	const FFaerieAddressNetSerializer::ConfigType FFaerieAddressNetSerializer::DefaultConfig;
+
+	FFaerieItemKeyNetSerializer::FNetSerializerRegistryDelegates FFaerieItemKeyNetSerializer::NetSerializerRegistryDelegates;
+	FKeyedStackNetSerializer::FNetSerializerRegistryDelegates FKeyedStackNetSerializer::NetSerializerRegistryDelegates;
+	FFaerieAddressNetSerializer::FNetSerializerRegistryDelegates FFaerieAddressNetSerializer::NetSerializerRegistryDelegates;
+
+	static const FName PropertyNetSerializerRegistry_NAME_EntryKey("EntryKey");
+	static const FName PropertyNetSerializerRegistry_NAME_StackKey("StackKey");
+	static const FName PropertyNetSerializerRegistry_NAME_KeyedStack("KeyedStack");
+	static const FName PropertyNetSerializerRegistry_NAME_FaerieAddress("FaerieAddress");
+
+	UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_EntryKey, FFaerieItemKeyNetSerializer);
+	UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_StackKey, FFaerieItemKeyNetSerializer);
+	UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_KeyedStack, FKeyedStackNetSerializer);
+	UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_FaerieAddress, FFaerieAddressNetSerializer);
+
+	FFaerieItemKeyNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+	{
+		UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_EntryKey);
+		UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_StackKey);
+	}
+
+	void FFaerieItemKeyNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+	{
+		UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_EntryKey);
+		UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_StackKey);
+	}
+
+	FKeyedStackNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+	{
+		UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_KeyedStack);
+	}
+
+	void FKeyedStackNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+	{
+		UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_KeyedStack);
+	}
+
+	FFaerieAddressNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+	{
+		UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_FaerieAddress);
+	}
+
+	void FFaerieAddressNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+	{
+		UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_FaerieAddress);
+	}
+}
+
+#endif
@@ -10,6 +10,7 @@
 #include "ItemContainerExtensionBase.h"
 #include "GameFramework/Actor.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/Misc/NetConditionGroupManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieItemContainerBase)
 
@@ -72,7 +73,17 @@ void UFaerieItemContainerBase::OnItemMutated(const TNotNull<const UFaerieItem*>
 		{
 			if (UFaerieItemToken* MutableToken = Token->MutateCast())
 			{
-				Actor->AddReplicatedSubObject(MutableToken);
+				// Tokens replicate alongside their item, so they join its net group, if it has one.
+				if (const FName NetGroup = GetItemNetGroup(Item);
+					!NetGroup.IsNone())
+				{
+					Actor->AddReplicatedSubObject(MutableToken, COND_NetGroup);
+					UE::Net::FNetConditionGroupManager::RegisterSubObjectInGroup(MutableToken, NetGroup);
+				}
+				else
+				{
+					Actor->AddReplicatedSubObject(MutableToken);
+				}
 				MutableToken->InitializeNetObject(Actor);
 			}
 		}
@@ -85,6 +96,11 @@ void UFaerieItemContainerBase::OnItemMutated(const TNotNull<const UFaerieItem*>
 		{
 			if (UFaerieItemToken* MutableToken = Token->MutateCast())
 			{
+				if (const FName NetGroup = GetItemNetGroup(Item);
+					!NetGroup.IsNone())
+				{
+					UE::Net::FNetConditionGroupManager::UnregisterSubObjectFromGroup(MutableToken, NetGroup);
+				}
 				Actor->RemoveReplicatedSubObject(MutableToken);
 				MutableToken->DeinitializeNetObject(Actor);
 			}
@@ -5,14 +5,23 @@
 #include "FaerieInventorySettings.h"
 #include "FaerieItem.h"
 #include "FaerieItemStorageIterators.h"
+#include "FaerieItemToken.h"
+#include "FaerieItemTokenFilter.h"
+#include "FaerieItemTokenFilterTypes.h"
 #include "FaerieItemStorageStatics.h"
 #include "FaerieSubObjectFilter.h"
 #include "ItemStackProxy.h"
 #include "ItemContainerExtensionBase.h"
 
+#include "Algo/BinarySearch.h"
+#include "Algo/Compare.h"
 #include "Algo/Transform.h"
+#include "HAL/IConsoleManager.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/Misc/NetConditionGroupManager.h"
+#include "Engine/World.h"
 #include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
 
 #if WITH_EDITOR
 #include "Engine/Engine.h"
@@ -32,6 +41,15 @@ using namespace Faerie;
 
 namespace Faerie::Storage
 {
+	static int32 StackProxyPoolSize = 256;
+	static FAutoConsoleVariableRef CVarStackProxyPoolSize(
+		TEXT("fae.Storage.StackProxyPoolSize"),
+		StackProxyPoolSize,
+		TEXT("Maximum number of released stack proxies that each storage keeps for reuse."));
+
+	// Smallest size that LocalStackProxies must reach before it is swept.
+	static constexpr int32 MinStackProxySweepThreshold = 64;
+
 	namespace Address
 	{
 		[[nodiscard]] UE_REWRITE FFaerieAddress Encode(const FEntryKey Entry, const FStackKey Stack)
@@ -63,7 +81,85 @@ namespace Faerie::Storage
 		return Behavior == EFaerieStorageAddStackBehavior::OnlyNewStacks;
 	}
 
+	namespace Paging
+	{
+		// Each page of each storage has its own net condition group, which players are added to as they view the page.
+		FName MakeNetGroup(const UFaerieItemStorage* Storage, const int32 Page)
+		{
+			return FName(*FString::Printf(TEXT("%s.Page%d"), *Storage->GetPathName(), Page));
+		}
+
+		// Move a mutable item, and its tokens, into the net group of its page, so they only replicate to players viewing it.
+		// Tokens added to the item later join the group through GetItemNetGroup.
+		void SetItemNetGroup(AActor& Actor, const UFaerieItem* Item, const FName NetGroup)
+		{
+			UFaerieItem* Mutable = Item->MutateCast();
+			if (!IsValid(Mutable) ||
+				!Actor.IsUsingRegisteredSubObjectList() ||
+				!Actor.IsReplicatedSubObjectRegistered(Mutable))
+			{
+				return;
+			}
+
+			Actor.RemoveReplicatedSubObject(Mutable);
+			Actor.AddReplicatedSubObject(Mutable, COND_NetGroup);
+			UE::Net::FNetConditionGroupManager::RegisterSubObjectInGroup(Mutable, NetGroup);
+
+			for (UFaerieItemToken* Token : Token::Filter().By<Token::FIsOwned>(Mutable).Iterate(Mutable))
+			{
+				Actor.RemoveReplicatedSubObject(Token);
+				Actor.AddReplicatedSubObject(Token, COND_NetGroup);
+				UE::Net::FNetConditionGroupManager::RegisterSubObjectInGroup(Token, NetGroup);
+			}
+		}
+
+		void ClearItemNetGroup(const UFaerieItem* Item, const FName NetGroup)
+		{
+			UFaerieItem* Mutable = Item->MutateCast();
+			if (!IsValid(Mutable))
+			{
+				return;
+			}
+
+			UE::Net::FNetConditionGroupManager::UnregisterSubObjectFromGroup(Mutable, NetGroup);
+			for (UFaerieItemToken* Token : Token::Filter().By<Token::FIsOwned>(Mutable).Iterate(Mutable))
+			{
+				UE::Net::FNetConditionGroupManager::UnregisterSubObjectFromGroup(Token, NetGroup);
+			}
+		}
+	}
+
 	static const FText AdditionFailure_FailedCanAddStack = LOCTEXT("AdditionFailure_FailedCanAddStack", "Refused by CanAddStack");
+
+	// Incoming stacks of one item, gathered by AddItemStacks.
+	struct FPendingAddition
+	{
+		FPendingAddition(const FFaerieItemStack& Stack, const FEntryKey ExistingEntry)
+		  : Item(Stack.Item), TotalCopies(Stack.Copies), ExistingEntry(ExistingEntry)
+		{
+			Copies.Add(Stack.Copies);
+		}
+
+		void Add(const int32 InCopies)
+		{
+			Copies.Add(InCopies);
+			TotalCopies += InCopies;
+		}
+
+		FFaerieItemStackView ToItemStackView() const
+		{
+			return FFaerieItemStackView(Item, TotalCopies);
+		}
+
+		const UFaerieItem* Item;
+		int32 TotalCopies;
+
+		// The entry these copies will be added to. Invalid if they will make a new entry.
+		FEntryKey ExistingEntry;
+
+		// The copies of each incoming stack, in order.
+		TArray<int32, TInlineAllocator<1>> Copies;
+	};
 }
 
 void UFaerieItemStorage::PostInitProperties()
@@ -80,6 +176,9 @@ void UFaerieItemStorage::PostDuplicate(const EDuplicateMode::Type DuplicateMode)
 
 	// Rebind replication functions out into this class.
 	EntryMap.ChangeListener = this;
+
+	// Duplicated content was copied without notifications.
+	RebuildLookupIndex();
 }
 
 void UFaerieItemStorage::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -89,7 +188,24 @@ void UFaerieItemStorage::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& O
 	FDoRepLifetimeParams SharedParams;
 	SharedParams.bIsPushBased = true;
 
+	// Only one of EntryMap or PageIndex is replicated, depending on PagedReplication.
+	SharedParams.Condition = COND_Custom;
 	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, EntryMap, SharedParams)
+
+	FDoRepLifetimeParams IndexParams;
+	IndexParams.Condition = COND_Custom;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, PageIndex, IndexParams)
+
+	DOREPLIFETIME_CONDITION(ThisClass, PagedReplication, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(ThisClass, PageSize, COND_InitialOnly);
+}
+
+void UFaerieItemStorage::GetReplicatedCustomConditionState(FCustomPropertyConditionState& OutActiveState) const
+{
+	Super::GetReplicatedCustomConditionState(OutActiveState);
+
+	DOREPCUSTOMCONDITION_ACTIVE_FAST(ThisClass, EntryMap, !PagedReplication);
+	DOREPCUSTOMCONDITION_ACTIVE_FAST(ThisClass, PageIndex, PagedReplication);
 }
 
 void UFaerieItemStorage::PostLoad()
@@ -97,11 +213,14 @@ void UFaerieItemStorage::PostLoad()
 	Super::PostLoad();
 
 	// Determine the next valid key to use.
-	if (!EntryMap.IsEmpty())
+	if (EntryMap.NumSlots() > 0)
 	{
-		KeyGen.SetPosition(EntryMap.GetKeyAt(EntryMap.Num()-1));
+		// Use the last slot, not Num(), as a tombstone still holds the highest key issued.
+		KeyGen.SetPosition(EntryMap.GetKeyAt(EntryMap.NumSlots()-1));
 	}
 	// See Footnote1
+
+	RebuildLookupIndex();
 }
 
 void UFaerieItemStorage::InitializeNetObject(AActor* Actor)
@@ -109,10 +228,22 @@ void UFaerieItemStorage::InitializeNetObject(AActor* Actor)
 	Super::InitializeNetObject(Actor);
 	Actor->AddReplicatedSubObject(Extensions);
 	Extensions->InitializeNetObject(Actor);
+
+	if (PagedReplication && Actor->HasAuthority())
+	{
+		PagingActor = Actor;
+		Server_RebuildPages();
+	}
 }
 
 void UFaerieItemStorage::DeinitializeNetObject(AActor* Actor)
 {
+	if (IsServerPaging())
+	{
+		Server_ClearPages();
+		PagingActor.Reset();
+	}
+
 	Extensions->DeinitializeNetObject(Actor);
 	Actor->RemoveReplicatedSubObject(Extensions);
 	Super::DeinitializeNetObject(Actor);
@@ -147,9 +278,12 @@ void UFaerieItemStorage::LoadSaveData(const FConstStructView ItemData, UFaerieIt
 		}
 	}
 
-	for (const FEntryKey InvalidKey : InvalidKeys)
 	{
-		EntryMap.Remove(InvalidKey);
+		FInventoryContent::FDeferredRemovalScope DeferredRemoval(EntryMap);
+		for (const FEntryKey InvalidKey : InvalidKeys)
+		{
+			EntryMap.Remove(InvalidKey);
+		}
 	}
 
 	EntryMap.MarkArrayDirty();
@@ -157,10 +291,18 @@ void UFaerieItemStorage::LoadSaveData(const FConstStructView ItemData, UFaerieIt
 	// Rebind replication functions out into this class.
 	EntryMap.ChangeListener = this;
 
+	RebuildLookupIndex();
+
+	if (IsServerPaging())
+	{
+		Server_RebuildPages();
+	}
+
 	// Determine the next valid key to use.
-	if (!EntryMap.IsEmpty())
+	if (EntryMap.NumSlots() > 0)
 	{
-		KeyGen.SetPosition(EntryMap.GetKeyAt(EntryMap.Num()-1));
+		// Use the last slot, not Num(), as a tombstone still holds the highest key issued.
+		KeyGen.SetPosition(EntryMap.GetKeyAt(EntryMap.NumSlots()-1));
 	}
 
 	// Rebuild extension state
@@ -341,6 +483,21 @@ void UFaerieItemStorage::OnItemMutated(const TNotNull<const UFaerieItem*> Item,
 	}
 }
 
+FName UFaerieItemStorage::GetItemNetGroup(const UFaerieItem* Item) const
+{
+	if (IsServerPaging() && IsValid(Item))
+	{
+		if (const FInventoryEntry* Entry = FindEntry(Item, EFaerieItemEqualsCheck::ComparePointers))
+		{
+			if (const UFaerieStoragePage* Page = Pages.FindRef(GetPageOfKey(Entry->GetKey())))
+			{
+				return Page->GetNetGroup();
+			}
+		}
+	}
+	return NAME_None;
+}
+
 void UFaerieItemStorage::PostContentAdded(const FInventoryEntry& Entry)
 {
 	if (!Entry.IsValid())
@@ -349,6 +506,13 @@ void UFaerieItemStorage::PostContentAdded(const FInventoryEntry& Entry)
 		return;
 	}
 
+	LookupIndex.Update(Entry.GetKey(), Entry.GetItem());
+
+	if (IsServerPaging())
+	{
+		Server_UpdatePagedEntry(Entry, true);
+	}
+
 	// Proxies may already exist for keys on the client if they are replicated by extensions or other means, and
 	// happened to arrive before we got them.
 	TArray<FFaerieAddress, TInlineAllocator<1>> Addresses;
@@ -367,17 +531,30 @@ void UFaerieItemStorage::PostContentAdded(const FInventoryEntry& Entry)
 				StackProxy->Get()->NotifyCreation();
 			}
 		}
+
+		if (auto&& LeasedProxy = LeasedStackProxies.Find(Address))
+		{
+			(*LeasedProxy)->NotifyCreation();
+		}
 	}
 }
 
 void UFaerieItemStorage::PreContentRemoved(const FInventoryEntry& Entry)
 {
+	// Always drop the key from the index, even if the entry is malformed.
+	LookupIndex.Remove(Entry.GetKey());
+
 	if (!Entry.IsValid())
 	{
 		UE_LOG(LogFaerieInventory, Error, TEXT("PreContentRemoved: Received Invalid Entry"))
 		return;
 	}
 
+	if (IsServerPaging())
+	{
+		Server_RemovePagedEntry(Entry);
+	}
+
 	// Collate addresses
 	TArray<FFaerieAddress, TInlineAllocator<1>> Addresses;
 	Addresses.Reserve(Entry.NumStacks());
@@ -395,6 +572,12 @@ void UFaerieItemStorage::PreContentRemoved(const FInventoryEntry& Entry)
 		{
 			StackProxy->NotifyRemoval();
 		}
+
+		// Leased proxies stay mapped until they are released, so that their leases remain valid.
+		if (auto&& LeasedProxy = LeasedStackProxies.Find(Address))
+		{
+			(*LeasedProxy)->NotifyRemoval();
+		}
 	}
 }
 
@@ -412,6 +595,24 @@ void UFaerieItemStorage::PostContentChanged(const FInventoryEntry& Entry, const
 		return;
 	}
 
+	// The item itself may have changed, either by mutation, or by the client receiving a new item object.
+	if (ChangeType != FInventoryContent::Server_ItemHandleClosed)
+	{
+		LookupIndex.Update(Entry.GetKey(), Entry.GetItem());
+	}
+
+	if (IsServerPaging())
+	{
+		Server_UpdatePagedEntry(Entry, false);
+	}
+
+	// Proxies will be notified once, when the transaction closes.
+	if (Transaction.Depth > 0)
+	{
+		Transaction.PendingChanges.Add(Entry.GetKey());
+		return;
+	}
+
 	/*
 		switch (ChangeType)
 		{
@@ -455,6 +656,11 @@ void UFaerieItemStorage::PostContentChanged(const FInventoryEntry& Entry, const
 		}
 		*/
 
+	NotifyStackProxiesOfChange(Entry);
+}
+
+void UFaerieItemStorage::NotifyStackProxiesOfChange(const FInventoryEntry& Entry)
+{
 	// Call updates on any stack proxies.
 	// PostContentChanged is called when stacks are removed as well, so let's do some cleanup here.
 	// Start by getting all the Addresses that we could have proxies for.
@@ -469,9 +675,15 @@ void UFaerieItemStorage::PostContentChanged(const FInventoryEntry& Entry, const
 	{
 		auto&& LocalStackProxy = *It;
 
+		// Sweep proxies that have died while we are here.
+		if (!LocalStackProxy.Value.IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
 		// Check for local proxies that match this entry
-		if (!LocalStackProxy.Value.IsValid() ||
-			LocalStackProxy.Value->GetKey() != Entry.GetKey())
+		if (LocalStackProxy.Value->GetKey() != Entry.GetKey())
 		{
 			continue;
 		}
@@ -488,6 +700,266 @@ void UFaerieItemStorage::PostContentChanged(const FInventoryEntry& Entry, const
 			LocalStackProxy.Value->NotifyRemoval();
 		}
 	}
+
+	// Leased proxies stay mapped until released, so only notify those for removed stacks once.
+	for (auto&& LeasedProxy : LeasedStackProxies)
+	{
+		if (LeasedProxy.Value->GetKey() != Entry.GetKey())
+		{
+			continue;
+		}
+
+		if (Addresses.Contains(LeasedProxy.Key))
+		{
+			LeasedProxy.Value->NotifyUpdate();
+		}
+		else if (LeasedProxy.Value->GetItemVersion() != -1)
+		{
+			LeasedProxy.Value->NotifyRemoval();
+		}
+	}
+}
+
+void UFaerieItemStorage::PostEventImpl(const Inventory::FEventData& Event, const FFaerieInventoryTag Reason)
+{
+	if (Transaction.Depth > 0)
+	{
+		Inventory::FEventLogBatch Batch;
+		Batch.Type = Reason;
+		Batch.Data = MakeConstArrayView(&Event, 1);
+		PostEventBatchImpl(Batch);
+		return;
+	}
+
+	Extensions->PostEvent(this, Event, Reason);
+}
+
+void UFaerieItemStorage::PostEventBatchImpl(const Inventory::FEventLogBatch& Batch)
+{
+	if (Transaction.Depth > 0)
+	{
+		auto* Pending = Transaction.PendingEvents.FindByPredicate(
+			[&Batch](const TPair<FFaerieInventoryTag, TArray<Inventory::FEventData>>& Pair)
+			{
+				return Pair.Key == Batch.Type;
+			});
+
+		if (!Pending)
+		{
+			Pending = &Transaction.PendingEvents.Emplace_GetRef(Batch.Type, TArray<Inventory::FEventData>());
+		}
+
+		Pending->Value.Append(Batch.Data);
+		return;
+	}
+
+	Extensions->PostEventBatch(this, Batch);
+}
+
+void UFaerieItemStorage::BeginTransaction()
+{
+	if (Transaction.Depth++ > 0) return;
+
+	Transaction.DeferredRemoval.Emplace(EntryMap);
+	Transaction.DeferredDirty.Emplace(EntryMap);
+}
+
+void UFaerieItemStorage::EndTransaction()
+{
+	check(Transaction.Depth > 0);
+	if (--Transaction.Depth > 0) return;
+
+	// Compact out removed entries, and then mark everything still alive that was touched.
+	Transaction.DeferredRemoval.Reset();
+	Transaction.DeferredDirty.Reset();
+
+	// Move pending state out first, in case any of these notifications open a new transaction.
+	const TSet<FEntryKey> PendingChanges = MoveTemp(Transaction.PendingChanges);
+	const TArray<TPair<FFaerieInventoryTag, TArray<Inventory::FEventData>>> PendingEvents = MoveTemp(Transaction.PendingEvents);
+
+	for (const FEntryKey Key : PendingChanges)
+	{
+		// Entries that were removed after being edited already had their proxies cleaned up.
+		if (const FInventoryEntry* Entry = GetEntrySafe(Key))
+		{
+			NotifyStackProxiesOfChange(*Entry);
+		}
+	}
+
+	for (auto&& [Type, Events] : PendingEvents)
+	{
+		Inventory::FEventLogBatch Batch;
+		Batch.Type = Type;
+		Batch.Data = Events;
+		Extensions->PostEventBatch(this, Batch);
+	}
+}
+
+bool UFaerieItemStorage::IsServerPaging() const
+{
+	return PagingActor.IsValid();
+}
+
+bool UFaerieItemStorage::IsPagingClient() const
+{
+	// Decided by authority rather than by PagingActor, which the server only sets once the storage is net initialized.
+	if (!PagedReplication)
+	{
+		return false;
+	}
+	const AActor* Actor = GetTypedOuter<AActor>();
+	return IsValid(Actor) && !Actor->HasAuthority();
+}
+
+UFaerieStoragePage* UFaerieItemStorage::Server_GetOrCreatePage(const int32 Page)
+{
+	if (const TObjectPtr<UFaerieStoragePage>* Existing = Pages.Find(Page))
+	{
+		return *Existing;
+	}
+
+	UFaerieStoragePage* NewPage = NewObject<UFaerieStoragePage>(this);
+	NewPage->PageIndex = Page;
+	NewPage->NetGroup = Storage::Paging::MakeNetGroup(this, Page);
+	Pages.Add(Page, NewPage);
+
+	// Pages only replicate to players that have been included in their group.
+	PagingActor->AddReplicatedSubObject(NewPage, COND_NetGroup);
+	UE::Net::FNetConditionGroupManager::RegisterSubObjectInGroup(NewPage, NewPage->NetGroup);
+
+	return NewPage;
+}
+
+void UFaerieItemStorage::Server_UpdatePagedEntry(const FInventoryEntry& Entry, const bool Added)
+{
+	UFaerieStoragePage* Page = Server_GetOrCreatePage(GetPageOfKey(Entry.GetKey()));
+
+	// Entries are kept in key order, like EntryMap.
+	const int32 Index = Algo::LowerBoundBy(Page->Entries, Entry.GetKey(), &FInventoryEntry::GetKey);
+	if (Page->Entries.IsValidIndex(Index) && Page->Entries[Index].GetKey() == Entry.GetKey())
+	{
+		Page->Entries[Index] = Entry;
+	}
+	else
+	{
+		Page->Entries.Insert(Entry, Index);
+	}
+	Page->MarkEntriesDirty();
+
+	PageIndex.SetCopies(Entry.GetKey(), Entry.StackSum());
+
+	if (Added)
+	{
+		Storage::Paging::SetItemNetGroup(*PagingActor, Entry.GetItem(), Page->NetGroup);
+	}
+}
+
+void UFaerieItemStorage::Server_RemovePagedEntry(const FInventoryEntry& Entry)
+{
+	PageIndex.RemoveKey(Entry.GetKey());
+
+	const int32 PageNumber = GetPageOfKey(Entry.GetKey());
+	if (UFaerieStoragePage* Page = Pages.FindRef(PageNumber))
+	{
+		if (const int32 Index = Algo::BinarySearchBy(Page->Entries, Entry.GetKey(), &FInventoryEntry::GetKey);
+			Index != INDEX_NONE)
+		{
+			Page->Entries.RemoveAt(Index);
+			Page->MarkEntriesDirty();
+		}
+
+		Storage::Paging::ClearItemNetGroup(Entry.GetItem(), Page->NetGroup);
+	}
+
+	Server_RemovePageIfUnused(PageNumber);
+}
+
+void UFaerieItemStorage::Server_RemovePageIfUnused(const int32 PageNumber)
+{
+	UFaerieStoragePage* Page = Pages.FindRef(PageNumber);
+	if (!IsValid(Page) || !Page->Entries.IsEmpty())
+	{
+		return;
+	}
+
+	// Emptied pages are kept while players are viewing them, so that they receive the removal. Keys are never reused, so
+	// once the last of them leaves, nothing will be added to the page again.
+	for (FConstPlayerControllerIterator It = PagingActor->GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* Player = It->Get();
+			IsValid(Player) && Player->IsMemberOfNetConditionGroup(Page->NetGroup))
+		{
+			return;
+		}
+	}
+
+	UE::Net::FNetConditionGroupManager::UnregisterSubObjectFromGroup(Page, Page->NetGroup);
+	PagingActor->RemoveReplicatedSubObject(Page);
+	Pages.Remove(PageNumber);
+}
+
+void UFaerieItemStorage::Server_RebuildPages()
+{
+	Server_ClearPages();
+
+	for (const FInventoryEntry& Entry : EntryMap)
+	{
+		Server_UpdatePagedEntry(Entry, true);
+	}
+}
+
+void UFaerieItemStorage::Server_ClearPages()
+{
+	for (auto&& [Index, Page] : Pages)
+	{
+		UE::Net::FNetConditionGroupManager::UnregisterSubObjectFromGroup(Page, Page->NetGroup);
+		PagingActor->RemoveReplicatedSubObject(Page);
+	}
+	Pages.Reset();
+	PageIndex.Reset();
+}
+
+void UFaerieItemStorage::Client_ReceivePage(UFaerieStoragePage* Page)
+{
+	const int32 PageNumber = Page->GetPageIndex();
+	Pages.Add(PageNumber, Page);
+
+	if (!ResidentPages.Contains(PageNumber))
+	{
+		return;
+	}
+
+	const TConstArrayView<FInventoryEntry> PageEntries = Page->GetEntries();
+
+	// Remove entries that have left the page. Keys never move between pages, so only this page's range is checked.
+	const int32 FirstKey = PageNumber * PageSize + Inventory::TKeyGen<FEntryKey>::InitialPosition + 1;
+	for (int32 KeyValue = FirstKey; KeyValue < FirstKey + PageSize; ++KeyValue)
+	{
+		if (const FEntryKey Key(KeyValue);
+			EntryMap.Contains(Key) &&
+			Algo::BinarySearchBy(PageEntries, Key, &FInventoryEntry::GetKey) == INDEX_NONE)
+		{
+			EntryMap.Remove(Key);
+		}
+	}
+
+	// Add and update the rest, sending the same notifications as the replicated EntryMap would.
+	for (const FInventoryEntry& PageEntry : PageEntries)
+	{
+		if (!EntryMap.Contains(PageEntry.GetKey()))
+		{
+			EntryMap.Insert(PageEntry);
+			continue;
+		}
+
+		if (FInventoryEntry& Existing = EntryMap[PageEntry.GetKey()];
+			Existing.GetItem() != PageEntry.GetItem() ||
+			!Algo::Compare(Existing.GetStacks(), PageEntry.GetStacks()))
+		{
+			Existing = PageEntry;
+			EntryMap.PostEntryReplicatedChange_Client(Existing);
+		}
+	}
 }
 
 
@@ -508,31 +980,33 @@ const FInventoryEntry* UFaerieItemStorage::GetEntrySafe(const FEntryKey Key) con
 	return EntryMap.Find(Key);
 }
 
+void UFaerieItemStorage::RebuildLookupIndex()
+{
+	LookupIndex.Reset();
+	for (const FInventoryEntry& Entry : EntryMap)
+	{
+		if (Entry.IsValid())
+		{
+			LookupIndex.Add(Entry.GetKey(), Entry.GetItem());
+		}
+	}
+}
+
 const FInventoryEntry* UFaerieItemStorage::FindEntry(const TNotNull<const UFaerieItem*> Item, const EFaerieItemEqualsCheck Method) const
 {
+	FEntryKey Key;
+
 	switch (Method)
 	{
 	case EFaerieItemEqualsCheck::ComparePointers:
-		for (const FInventoryEntry& Entry : EntryMap)
-		{
-			if (Item == Entry.GetItem())
-			{
-				return &Entry;
-			}
-		}
+		Key = LookupIndex.FindByPointer(Item);
 		break;
 	case EFaerieItemEqualsCheck::UseCompareWith:
-		for (const FInventoryEntry& Entry : EntryMap)
-		{
-			if (Item->CompareWith(Entry.GetItem(), EFaerieItemComparisonFlags::Default))
-			{
-				return &Entry;
-			}
-		}
+		Key = LookupIndex.FindEquivalent(Item);
 		break;
 	}
 
-	return nullptr;
+	return Key.IsValid() ? GetEntrySafe(Key) : nullptr;
 }
 
 UFaerieItemStackProxy* UFaerieItemStorage::GetStackProxyImpl(const FFaerieAddress Address) const
@@ -542,7 +1016,7 @@ UFaerieItemStackProxy* UFaerieItemStorage::GetStackProxyImpl(const FFaerieAddres
 
 	if (auto&& ExistingProxy = LocalStackProxies.Find(Address))
 	{
-		if (ExistingProxy && ExistingProxy->IsValid())
+		if (ExistingProxy->IsValid())
 		{
 			return ExistingProxy->Get();
 		}
@@ -550,15 +1024,15 @@ UFaerieItemStackProxy* UFaerieItemStorage::GetStackProxyImpl(const FFaerieAddres
 
 	ThisClass* This = const_cast<ThisClass*>(this);
 
-	FEntryKey Entry;
-	FStackKey Stack;
-	Storage::Address::Decode(Address, Entry, Stack);
-	const FName ProxyName = MakeUniqueObjectName(This, UFaerieItemStackProxy::StaticClass(),
-												 *FString::Printf(TEXT("STACK_PROXY_%s_%s"),
-												 *Entry.ToString(), *Stack.ToString()));
-	UFaerieItemStackProxy* NewEntryProxy = NewObject<UFaerieItemStackProxy>(This, UFaerieItemStackProxy::StaticClass(), ProxyName);
-	check(IsValid(NewEntryProxy));
+	// Proxies that die leave their entries behind. Sweeping each time the map doubles keeps the cost amortized.
+	if (LocalStackProxies.Num() >= StackProxySweepThreshold)
+	{
+		This->SweepStaleStackProxies();
+	}
 
+	// Proxies returned from here may be held by anything, so they are never pooled, and never taken from the pool.
+	const FName ProxyName = MakeUniqueObjectName(This, UFaerieItemStackProxy::StaticClass(), TEXT("STACK_PROXY"));
+	UFaerieItemStackProxy* NewEntryProxy = NewObject<UFaerieItemStackProxy>(This, UFaerieItemStackProxy::StaticClass(), ProxyName);
 	NewEntryProxy->ItemStorage = This;
 	NewEntryProxy->Address = Address;
 
@@ -572,6 +1046,57 @@ UFaerieItemStackProxy* UFaerieItemStorage::GetStackProxyImpl(const FFaerieAddres
 	return NewEntryProxy;
 }
 
+UFaerieItemStackProxy* UFaerieItemStorage::GetLeasedStackProxyImpl(const FFaerieAddress Address)
+{
+	// Don't create proxies for invalid keys.
+	if (!Address.IsValid()) return nullptr;
+
+	if (auto&& ExistingProxy = LeasedStackProxies.Find(Address))
+	{
+		return *ExistingProxy;
+	}
+
+	// Rebind a released proxy if there is one, otherwise make a new one.
+	UFaerieItemStackProxy* NewEntryProxy;
+	if (!StackProxyPool.IsEmpty())
+	{
+		NewEntryProxy = StackProxyPool.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		// Proxies are rebound to other addresses when recycled, so they are not named after their address.
+		const FName ProxyName = MakeUniqueObjectName(this, UFaerieItemStackProxy::StaticClass(), TEXT("LEASED_STACK_PROXY"));
+		NewEntryProxy = NewObject<UFaerieItemStackProxy>(this, UFaerieItemStackProxy::StaticClass(), ProxyName);
+		NewEntryProxy->ItemStorage = this;
+		NewEntryProxy->Leased = true;
+	}
+	check(IsValid(NewEntryProxy));
+
+	NewEntryProxy->Address = Address;
+
+	if (Contains(Address))
+	{
+		NewEntryProxy->NotifyCreation();
+	}
+
+	LeasedStackProxies.Add(Address, NewEntryProxy);
+
+	return NewEntryProxy;
+}
+
+void UFaerieItemStorage::SweepStaleStackProxies()
+{
+	for (auto It = LocalStackProxies.CreateIterator(); It; ++It)
+	{
+		if (!It->Value.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	StackProxySweepThreshold = FMath::Max(Storage::MinStackProxySweepThreshold, LocalStackProxies.Num() * 2);
+}
+
 Inventory::FEventData UFaerieItemStorage::AddStackImplNoBroadcast(const FFaerieItemStack& InStack, const bool ForceNewStack)
 {
 	Inventory::FEventData Event;
@@ -636,7 +1161,7 @@ Inventory::FEventData UFaerieItemStorage::AddStackImpl(const FFaerieItemStack& I
 	const Inventory::FEventData Event = AddStackImplNoBroadcast(InStack, ForceNewStack);
 
 	// Execute PostEventBatch on all extensions with the finished Event
-	Extensions->PostEvent(this, Event, Inventory::Tags::Addition);
+	PostEventImpl(Event, Inventory::Tags::Addition);
 
 	return Event;
 }
@@ -697,7 +1222,7 @@ Inventory::FEventData UFaerieItemStorage::RemoveFromEntryImpl(const FInventoryEn
 
 	const Inventory::FEventData Event = RemoveFromEntryImplNoBroadcast(Entry, Amount);
 
-	Extensions->PostEvent(this, Event, Reason);
+	PostEventImpl(Event, Reason);
 
 	return Event;
 }
@@ -769,7 +1294,7 @@ Inventory::FEventData UFaerieItemStorage::RemoveFromStackImpl(const FFaerieAddre
 		EntryMap.Remove(EntryKey);
 	}
 
-	Extensions->PostEvent(this, Event, Reason);
+	PostEventImpl(Event, Reason);
 
 	return Event;
 }
@@ -896,6 +1421,124 @@ int32 UFaerieItemStorage::GetStackCount() const
 	return Stacks;
 }
 
+int32 UFaerieItemStorage::GetPageOfKey(const FEntryKey Key) const
+{
+	return FMath::Max(Key.Value() - Inventory::TKeyGen<FEntryKey>::InitialPosition - 1, 0) / FMath::Max(PageSize, 1);
+}
+
+int32 UFaerieItemStorage::GetIndexedEntryCount() const
+{
+	if (IsPagingClient())
+	{
+		return PageIndex.Num();
+	}
+	return EntryMap.Num();
+}
+
+int32 UFaerieItemStorage::GetIndexedPageCount() const
+{
+	const TConstArrayView<FFaerieStorageIndexEntry> Index = PageIndex.GetView();
+	return Index.IsEmpty() ? 0 : GetPageOfKey(Index.Last().Key) + 1;
+}
+
+void UFaerieItemStorage::GetPagesInIndexRange(const int32 First, const int32 Count, TArray<int32>& OutPages) const
+{
+	const TConstArrayView<FFaerieStorageIndexEntry> Index = PageIndex.GetView();
+	const int32 End = FMath::Min(First + Count, Index.Num());
+	for (int32 i = FMath::Max(First, 0); i < End; ++i)
+	{
+		// The index is in key order, so entries of the same page are adjacent.
+		if (const int32 Page = GetPageOfKey(Index[i].Key);
+			OutPages.IsEmpty() || OutPages.Last() != Page)
+		{
+			OutPages.Add(Page);
+		}
+	}
+}
+
+bool UFaerieItemStorage::IsPageIndexed(const int32 Page) const
+{
+	const TConstArrayView<FFaerieStorageIndexEntry> Index = PageIndex.GetView();
+	const int32 First = Algo::LowerBoundBy(Index, FEntryKey(Page * PageSize + Inventory::TKeyGen<FEntryKey>::InitialPosition + 1), &FFaerieStorageIndexEntry::Key);
+	return Index.IsValidIndex(First) && GetPageOfKey(Index[First].Key) == Page;
+}
+
+bool UFaerieItemStorage::IsPageResident(const int32 Page) const
+{
+	return !IsPagingClient() || ResidentPages.Contains(Page);
+}
+
+void UFaerieItemStorage::Client_SetPageResident(const int32 Page, const bool Resident)
+{
+	if (!IsPagingClient())
+	{
+		return;
+	}
+
+	if (Resident)
+	{
+		if (ResidentPages.Contains(Page))
+		{
+			return;
+		}
+		ResidentPages.Add(Page);
+
+		// If the page was viewed before, it can be shown right away. The server will send any changes since, unless it has
+		// emptied the page and removed it since, in which case the page is dropped, rather than showing stale entries.
+		if (UFaerieStoragePage* Existing = Pages.FindRef(Page))
+		{
+			if (IsPageIndexed(Page))
+			{
+				Client_ReceivePage(Existing);
+			}
+			else
+			{
+				Pages.Remove(Page);
+			}
+		}
+		return;
+	}
+
+	if (!ResidentPages.Remove(Page))
+	{
+		return;
+	}
+
+	// Evicted entries are removed, rather than left to go stale. The page object is kept, so the entries can be shown
+	// again right away if the page is viewed again.
+
+	const int32 FirstKey = Page * PageSize + Inventory::TKeyGen<FEntryKey>::InitialPosition + 1;
+	for (int32 KeyValue = FirstKey; KeyValue < FirstKey + PageSize; ++KeyValue)
+	{
+		if (const FEntryKey Key(KeyValue);
+			EntryMap.Contains(Key))
+		{
+			EntryMap.Remove(Key);
+		}
+	}
+}
+
+void UFaerieItemStorage::Server_SetPagesRelevant(APlayerController* Player, const TConstArrayView<int32> InPages, const bool Relevant)
+{
+	if (!IsServerPaging() || !IsValid(Player))
+	{
+		return;
+	}
+
+	for (const int32 Page : InPages)
+	{
+		if (Relevant)
+		{
+			Player->IncludeInNetConditionGroup(Storage::Paging::MakeNetGroup(this, Page));
+		}
+		else
+		{
+			Player->RemoveFromNetConditionGroup(Storage::Paging::MakeNetGroup(this, Page));
+			Server_RemovePageIfUnused(Page);
+		}
+	}
+}
+
 bool UFaerieItemStorage::ContainsKey(const FEntryKey Key) const
 {
 	return Contains(Key);
@@ -924,7 +1567,7 @@ FEntryKey UFaerieItemStorage::FindItem(const UFaerieItem* Item, const EFaerieIte
 FFaerieAddress UFaerieItemStorage::GetFirstAddress() const
 {
 	if (EntryMap.IsEmpty()) return FFaerieAddress();
-	const FInventoryEntry& FirstEntry = EntryMap.Entries[0];
+	const FInventoryEntry& FirstEntry = EntryMap.Entries[EntryMap.FindNextLiveIndex(0)];
 	return Storage::Address::Encode(FirstEntry.GetKey(), FirstEntry.GetStacks()[0].Key);
 }
 
@@ -937,6 +1580,68 @@ const UFaerieItem* UFaerieItemStorage::GetEntryItem(const FEntryKey Key) const
 	return nullptr;
 }
 
+FFaerieStackProxyLease UFaerieItemStorage::AcquireStackProxy(const FFaerieAddress Address)
+{
+	FFaerieStackProxyLease Lease;
+	if (UFaerieItemStackProxy* StackProxy = GetLeasedStackProxyImpl(Address);
+		IsValid(StackProxy))
+	{
+		StackProxy->AcquireCount++;
+		Lease.Proxy = StackProxy;
+		Lease.Binding = StackProxy->Binding;
+	}
+	return Lease;
+}
+
+FFaerieStackProxyLease UFaerieItemStorage::AcquireExistingStackProxy(const FFaerieItemProxy& Proxy)
+{
+	// Only proxies that are currently leased can be recycled. Any other proxy can be held without a lease.
+	if (UFaerieItemStackProxy* StackProxy = const_cast<UFaerieItemStackProxy*>(Cast<UFaerieItemStackProxy>(Proxy.GetObject()));
+		IsValid(StackProxy) && StackProxy->Leased && StackProxy->AcquireCount > 0)
+	{
+		StackProxy->AcquireCount++;
+
+		FFaerieStackProxyLease Lease;
+		Lease.Proxy = StackProxy;
+		Lease.Binding = StackProxy->Binding;
+		return Lease;
+	}
+	return FFaerieStackProxyLease();
+}
+
+bool UFaerieItemStorage::ReleaseStackProxy(FFaerieStackProxyLease& Lease)
+{
+	UFaerieItemStackProxy* StackProxy = Lease.Proxy;
+	const bool Valid = Lease.IsValid();
+	Lease = FFaerieStackProxyLease();
+
+	// Stale leases are rejected, so they cannot release a proxy out from under whoever it was recycled for.
+	if (!Valid ||
+		StackProxy->GetStorage() != this ||
+		StackProxy->AcquireCount <= 0)
+	{
+		return false;
+	}
+
+	StackProxy->AcquireCount--;
+	if (StackProxy->AcquireCount > 0)
+	{
+		return true;
+	}
+
+	// Nothing is using this proxy anymore, as leases are the only way to reach it. Unbind it from its address, and keep
+	// it for the next request.
+	LeasedStackProxies.Remove(StackProxy->Address);
+
+	StackProxy->Unbind();
+
+	if (StackProxyPool.Num() < Storage::StackProxyPoolSize)
+	{
+		StackProxyPool.Add(StackProxy);
+	}
+	return true;
+}
+
 bool UFaerieItemStorage::CanAddStack(const FFaerieItemStackView Stack, const EFaerieStorageAddStackBehavior AddStackBehavior) const
 {
 	if (!Stack.Item.IsValid() ||
@@ -1090,6 +1795,147 @@ void UFaerieItemStorage::AddItemStacks(const TConstArrayView<FFaerieItemStack> I
 
 	const bool ForceNewStack = Storage::IfOnlyNewStacks(AddStackBehavior);
 
+	// Group incoming stacks by item identity, so that each item is tested, and added, only once.
+	TArray<Storage::FPendingAddition> Groups;
+	Groups.Reserve(ItemStacks.Num());
+
+	// Index of the groups that will create new entries, keyed by their index in Groups.
+	Storage::FEntryLookupIndex PendingIndex;
+
+	// Index of the groups that will add to existing entries.
+	TMap<FEntryKey, int32> ExistingGroups;
+
+	int32 NumNewEntries = 0;
+
+	for (auto&& ItemStack : ItemStacks)
+	{
+		if (!ensureAlwaysMsgf(
+			ItemStack.IsValid(),
+			TEXT("AddStackImpl was passed an invalid stack.")))
+		{
+			continue;
+		}
+
+		// Every stack passes the same checks as a single add, so extensions can still reject individual stacks. Rejected
+		// stacks are skipped, as AddItemStacksIndividually would.
+		if (!CanAddStack(ItemStack, AddStackBehavior))
+		{
+			continue;
+		}
+
+		if (ItemStack.Item->MutateCast() == nullptr)
+		{
+			// Immutables can stack with existing entries, or with other stacks in this batch.
+			if (const FEntryKey ExistingKey = LookupIndex.FindEquivalent(ItemStack.Item);
+				ExistingKey.IsValid())
+			{
+				if (const int32* GroupIndex = ExistingGroups.Find(ExistingKey))
+				{
+					Groups[*GroupIndex].Add(ItemStack.Copies);
+				}
+				else
+				{
+					ExistingGroups.Add(ExistingKey, Groups.Emplace(ItemStack, ExistingKey));
+				}
+				continue;
+			}
+
+			if (const FEntryKey PendingKey = PendingIndex.FindEquivalent(ItemStack.Item);
+				PendingKey.IsValid())
+			{
+				Groups[PendingKey.Value()].Add(ItemStack.Copies);
+				continue;
+			}
+
+			PendingIndex.Add(FEntryKey(Groups.Num()), ItemStack.Item);
+		}
+
+		Groups.Emplace(ItemStack, FEntryKey());
+		NumNewEntries++;
+	}
+
+	if (Groups.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<FFaerieItemStackView> GroupViews;
+	GroupViews.Reserve(Groups.Num());
+	Algo::Transform(Groups, GroupViews, &Storage::FPendingAddition::ToItemStackView);
+
+	// Then test the entire batch at once, for extensions that limit what can be added in total.
+	const FFaerieExtensionAllowsAdditionArgs GroupTestArgs { AddStackBehavior, EFaerieStorageAddStackTestMultiType::GroupTest };
+	if (Extensions->AllowsAddition(this, GroupViews, GroupTestArgs) == EEventExtensionResponse::Disallowed)
+	{
+		// Some of the batch may still fit on its own, so fall back to testing and adding stacks one at a time.
+		AddItemStacksIndividually(ItemStacks, AddStackBehavior);
+		return;
+	}
+
+	TArray<Inventory::FEventData> Events;
+	Events.Reserve(Groups.Num());
+
+	TArray<FInventoryEntry> NewEntries;
+	NewEntries.Reserve(NumNewEntries);
+
+	for (Storage::FPendingAddition& Group : Groups)
+	{
+		// Execute PreAddition on all extensions
+		Extensions->PreAddition(this, Group.ToItemStackView());
+
+		Inventory::FEventData& Event = Events.AddDefaulted_GetRef();
+		Event.Item = Group.Item;
+		Event.Amount = Group.TotalCopies;
+
+		if (Group.ExistingEntry.IsValid())
+		{
+			Event.EntryTouched = Group.ExistingEntry;
+
+			FInventoryEntry::FMutableAccess Entry = EntryMap[Group.ExistingEntry].GetMutableAccess(EntryMap);
+			if (ForceNewStack)
+			{
+				for (const int32 Copies : Group.Copies)
+				{
+					Entry.AddToNewStacks(Copies, Event.AddressesTouched);
+				}
+			}
+			else
+			{
+				Entry.AddToAnyStack(Group.TotalCopies, Event.AddressesTouched);
+			}
+		}
+		else
+		{
+			if (UFaerieItem* Mutable = Group.Item->MutateCast())
+			{
+				ItemData::TakeOwnership(this, Mutable);
+			}
+
+			// Filling any stack first is the same as laying out the total, while forcing new stacks must keep each
+			// incoming stack apart.
+			const TConstArrayView<int32> StackCopies = ForceNewStack
+				? TConstArrayView<int32>(Group.Copies)
+				: TConstArrayView<int32>(&Group.TotalCopies, 1);
+
+			Event.EntryTouched = KeyGen.NextKey();
+			NewEntries.Emplace(Group.Item, Event.EntryTouched, StackCopies, Event.AddressesTouched);
+		}
+	}
+
+	// NextKey() is guaranteed to have a greater value than all currently existing keys, so this is a single append.
+	EntryMap.AppendUnsafe(MoveTemp(NewEntries));
+
+	// Execute PostEventBatch on all extensions with the finished Events
+	Inventory::FEventLogBatch Batch;
+	Batch.Type = Inventory::Tags::Addition;
+	Batch.Data = Events;
+	PostEventBatchImpl(Batch);
+}
+
+void UFaerieItemStorage::AddItemStacksIndividually(const TConstArrayView<FFaerieItemStack> ItemStacks, const EFaerieStorageAddStackBehavior AddStackBehavior)
+{
+	const bool ForceNewStack = Storage::IfOnlyNewStacks(AddStackBehavior);
+
 	Inventory::FEventLogBatch Batch;
 	Batch.Type = Inventory::Tags::Addition;
 	TArray<Inventory::FEventData> Events;
@@ -1097,9 +1943,7 @@ void UFaerieItemStorage::AddItemStacks(const TConstArrayView<FFaerieItemStack> I
 
 	for (auto&& ItemStack : ItemStacks)
 	{
-		if (!ensureAlwaysMsgf(
-			ItemStack.IsValid(),
-			TEXT("AddStackImpl was passed an invalid stack.")))
+		if (!ItemStack.IsValid())
 		{
 			continue;
 		}
@@ -1118,7 +1962,7 @@ void UFaerieItemStorage::AddItemStacks(const TConstArrayView<FFaerieItemStack> I
 
 	// Execute PostEventBatch on all extensions with the finished Event
 	Batch.Data = Events;
-	Extensions->PostEventBatch(this, Batch);
+	PostEventBatchImpl(Batch);
 }
 
 void UFaerieItemStorage::AddItemStackBulk(const TArray<FFaerieItemStack>& ItemStacks, const EFaerieStorageAddStackBehavior AddStackBehavior)
@@ -1208,23 +2052,28 @@ void UFaerieItemStorage::Clear(FFaerieInventoryTag RemovalTag)
 	Batch.Type = RemovalTag;
 	TArray<Inventory::FEventData> Events;
 	Events.Reserve(Entries.Num());
-	for (const FEntryKey EntryKey : Entries)
 	{
-		const FInventoryEntry& Entry = EntryMap[EntryKey];
+		// Removed entries are compacted out once at the end, instead of shifting the array for each one.
+		FInventoryContent::FDeferredRemovalScope DeferredRemoval(EntryMap);
 
-		if (!CanRemoveEntryImpl(Entry, Inventory::Tags::RemovalMoving))
+		for (const FEntryKey EntryKey : Entries)
 		{
-			continue;
-		}
+			const FInventoryEntry& Entry = EntryMap[EntryKey];
+
+			if (!CanRemoveEntryImpl(Entry, Inventory::Tags::RemovalMoving))
+			{
+				continue;
+			}
 
-		Extensions->PreRemoval(this, EntryKey, ItemData::EntireStack);
+			Extensions->PreRemoval(this, EntryKey, ItemData::EntireStack);
 
-		// RemoveFromEntryImplNoBroadcast should not be called with unvalidated parameters.
-		Events.Add(RemoveFromEntryImplNoBroadcast(Entry, ItemData::EntireStack));
+			// RemoveFromEntryImplNoBroadcast should not be called with unvalidated parameters.
+			Events.Add(RemoveFromEntryImplNoBroadcast(Entry, ItemData::EntireStack));
+		}
 	}
 
 	Batch.Data = Events;
-	Extensions->PostEventBatch(this, Batch);
+	PostEventBatchImpl(Batch);
 
 	checkf(EntryMap.IsEmpty(), TEXT("Clear failed to empty EntryMap"));
 
@@ -1367,7 +2216,7 @@ bool UFaerieItemStorage::MergeStacks(const FEntryKey Entry, const FStackKey From
 	}
 	// Close Mutable scope
 
-	Extensions->PostEvent(this, Event, Inventory::Tags::Merge);
+	PostEventImpl(Event, Inventory::Tags::Merge);
 
 	return true;
 }
@@ -1411,7 +2260,7 @@ bool UFaerieItemStorage::SplitStack(const FFaerieAddress Address, const int32 Am
 		Event.AddressesTouched.Add(Storage::Address::Encode(Entry, SplitStack));
 	}
 
-	Extensions->PostEvent(this, Event, Inventory::Tags::Split);
+	PostEventImpl(Event, Inventory::Tags::Split);
 
 	return true;
 }
@@ -1436,29 +2285,33 @@ void UFaerieItemStorage::Dump(UFaerieItemStorage* ToStorage)
 	TArray<FFaerieItemStack> Stacks;
 	Stacks.Reserve(Entries.Num());
 
-	for (const FEntryKey EntryKey : Entries)
 	{
-		const FInventoryEntry& Entry = EntryMap[EntryKey];
+		FInventoryContent::FDeferredRemovalScope DeferredRemoval(EntryMap);
 
-		if (!CanRemoveEntryImpl(Entry, Inventory::Tags::RemovalMoving))
+		for (const FEntryKey EntryKey : Entries)
 		{
-			continue;
-		}
+			const FInventoryEntry& Entry = EntryMap[EntryKey];
 
-		if (!ToStorage->CanAddStack(Entry.ToItemStackView(), DumpBehavior))
-		{
-			continue;
-		}
+			if (!CanRemoveEntryImpl(Entry, Inventory::Tags::RemovalMoving))
+			{
+				continue;
+			}
 
-		Extensions->PreRemoval(this, EntryKey, ItemData::EntireStack);
+			if (!ToStorage->CanAddStack(Entry.ToItemStackView(), DumpBehavior))
+			{
+				continue;
+			}
+
+			Extensions->PreRemoval(this, EntryKey, ItemData::EntireStack);
 
-		auto&& Event = Events.Add_GetRef(RemoveFromEntryImplNoBroadcast(Entry, ItemData::EntireStack));
+			auto&& Event = Events.Add_GetRef(RemoveFromEntryImplNoBroadcast(Entry, ItemData::EntireStack));
 
-		Stacks.Emplace(Event.Item.Get(), Event.Amount);
+			Stacks.Emplace(Event.Item.Get(), Event.Amount);
+		}
 	}
 
 	EventBatch.Data = Events;
-	Extensions->PostEventBatch(this, EventBatch);
+	PostEventBatchImpl(EventBatch);
 
 	ToStorage->AddItemStacks(Stacks, DumpBehavior);
 }
@@ -30,11 +30,8 @@ namespace Faerie::Storage
 
 	void FIterator_AllEntries::AdvanceEntry()
 	{
-		EntryIndex++;
-		if (EntryIndex >= Content->Num())
-		{
-			EntryIndex = INDEX_NONE;
-		}
+		// Skips any entries tombstoned by a deferred removal scope.
+		EntryIndex = Content->FindNextLiveIndex(EntryIndex + 1);
 	}
 
 	FEntryKey FIterator_AllEntries::GetKey() const
@@ -66,10 +63,9 @@ namespace Faerie::Storage
 
 	void FIterator_AllAddresses::AdvanceEntry()
 	{
-		EntryIndex++;
-		if (EntryIndex >= Content->Num())
+		EntryIndex = Content->FindNextLiveIndex(EntryIndex + 1);
+		if (EntryIndex == INDEX_NONE)
 		{
-			EntryIndex = INDEX_NONE;
 			StackPtr = nullptr;
 			return;
 		}
@@ -135,6 +131,7 @@ namespace Faerie::Storage
 	FIterator_SingleEntry::FIterator_SingleEntry(const TNotNull<const UFaerieItemStorage*> Storage, const int32 Index)
 	  : EntryPtr(&ReadInventoryContent(Storage).GetElementAt(Index))
 	{
+		checkf(!ReadInventoryContent(Storage).IsTombstone(*EntryPtr), TEXT("FIterator_SingleEntry was given the index of a removed entry!"));
 		const TConstArrayView<FKeyedStack> StackView = EntryPtr->GetStacks();
 		StackPtr = StackView.GetData();
 		NumRemaining = StackView.Num()-1;
@@ -0,0 +1,131 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemStorageLookup.h"
+#include "FaerieHashStatics.h"
+#include "FaerieItem.h"
+#include "FaerieItemToken.h"
+#include "FaerieItemTokenFilter.h"
+#include "FaerieItemTokenFilterTypes.h"
+#include "Algo/Sort.h"
+
+namespace Faerie::Storage
+{
+	uint32 FEntryLookupIndex::MakeContentHash(const TNotNull<const UFaerieItem*> Item)
+	{
+		// This mirrors UFaerieItem::CompareWith using EFaerieItemComparisonFlags::Default, which only compares primary
+		// identifier tokens, in any order, and requires both items to have the same number of tokens. It relies on
+		// tokens hashing equal when they compare equal, see UFaerieItemToken::CompareWithImpl.
+		TArray<uint32> TokenHashes;
+		for (const UFaerieItemToken* IdentifierToken : Token::Filter().By<Token::FTagFilter>(Token::Tags::PrimaryIdentifierToken).Iterate(Item))
+		{
+			TokenHashes.Add(IdentifierToken->GetTokenHash());
+		}
+
+		return Hash::Combine(Hash::CombineHashes(TokenHashes).Hash, Item->GetOwnedTokens().Num());
+	}
+
+	bool FEntryLookupIndex::IsContentIndexable(const TNotNull<const UFaerieItem*> Item)
+	{
+		// CompareWith(Default) treats data-mutable items as unequivocable, so they can only ever match themselves.
+		return !Item->IsDataMutable();
+	}
+
+	void FEntryLookupIndex::Add(const FEntryKey Key, const TNotNull<const UFaerieItem*> Item)
+	{
+		check(Key.IsValid());
+
+		FIndexedItem& Record = Records.FindOrAdd(Key);
+		checkf(Record.Item == nullptr, TEXT("Key '%s' is already indexed. Use Update instead."), *Key.ToString());
+
+		Record.Item = Item;
+		ByPointer.Add(Item, Key);
+
+		if (IsContentIndexable(Item))
+		{
+			Record.ContentHash = MakeContentHash(Item);
+			ByContentHash.Add(Record.ContentHash.GetValue(), Key);
+		}
+	}
+
+	void FEntryLookupIndex::Remove(const FEntryKey Key)
+	{
+		FIndexedItem Record;
+		if (!Records.RemoveAndCopyValue(Key, Record))
+		{
+			return;
+		}
+
+		// Only remove the pointer lookup if it still points at us.
+		if (const FEntryKey* PointerKey = ByPointer.Find(Record.Item);
+			PointerKey && *PointerKey == Key)
+		{
+			ByPointer.Remove(Record.Item);
+		}
+
+		if (Record.ContentHash.IsSet())
+		{
+			ByContentHash.RemoveSingle(Record.ContentHash.GetValue(), Key);
+		}
+	}
+
+	void FEntryLookupIndex::Reset()
+	{
+		Records.Reset();
+		ByPointer.Reset();
+		ByContentHash.Reset();
+	}
+
+	void FEntryLookupIndex::Update(const FEntryKey Key, const TNotNull<const UFaerieItem*> Item)
+	{
+		Remove(Key);
+		Add(Key, Item);
+	}
+
+	FEntryKey FEntryLookupIndex::FindByPointer(const UFaerieItem* Item) const
+	{
+		if (const FEntryKey* Key = ByPointer.Find(Item))
+		{
+			return *Key;
+		}
+		return FEntryKey();
+	}
+
+	FEntryKey FEntryLookupIndex::FindEquivalent(const TNotNull<const UFaerieItem*> Item) const
+	{
+		const FEntryKey PointerKey = FindByPointer(Item);
+
+		TArray<FEntryKey, TInlineAllocator<4>> Candidates;
+		FindContentCandidates(Item, Candidates);
+
+		for (const FEntryKey Candidate : Candidates)
+		{
+			// An exact pointer match with a lower key wins, same as a linear search would.
+			if (PointerKey.IsValid() && PointerKey < Candidate)
+			{
+				break;
+			}
+
+			if (Candidate == PointerKey ||
+				Item->CompareWith(Records[Candidate].Item, EFaerieItemComparisonFlags::Default))
+			{
+				return Candidate;
+			}
+		}
+
+		return PointerKey;
+	}
+
+	void FEntryLookupIndex::FindContentCandidates(const TNotNull<const UFaerieItem*> Item, TArray<FEntryKey, TInlineAllocator<4>>& OutKeys) const
+	{
+		OutKeys.Reset();
+		if (!IsContentIndexable(Item))
+		{
+			return;
+		}
+
+		ByContentHash.MultiFind(MakeContentHash(Item), OutKeys);
+
+		// Keep results in key order, so that lookup resolves to the same entry that a linear search of the content would.
+		Algo::Sort(OutKeys);
+	}
+}
@@ -135,6 +135,7 @@ namespace Faerie::ItemData
 	void TakeOwnership_Impl(const TNotNull<UObject*> Owner, const TNotNull<UFaerieItem*> Item)
 	{
 		checkfSlow(Item->GetOuter() != Owner, TEXT("TakeOwnership called on item we already own. Incorrect recursion likely the cause!"));
+		checkfSlow(!Item->IsAssetItem(), TEXT("Asset items are shared, and replicated by reference. They must never be owned!"));
 
 		// Children of items that have already been moved to this owner will also own us, so skip the transient check, but perform the rest of this function.
 		if (!Item->IsInOuter(Owner))
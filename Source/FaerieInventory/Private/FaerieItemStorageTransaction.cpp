@@ -0,0 +1,18 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemStorageTransaction.h"
+#include "FaerieItemStorage.h"
+
+namespace Faerie::Storage
+{
+	FScopedTransaction::FScopedTransaction(const TNotNull<UFaerieItemStorage*> Storage)
+	  : Storage(Storage)
+	{
+		Storage->BeginTransaction();
+	}
+
+	FScopedTransaction::~FScopedTransaction()
+	{
+		Storage->EndTransaction();
+	}
+}
@@ -0,0 +1,60 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieStoragePaging.h"
+#include "FaerieItemStorage.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieStoragePaging)
+
+void FFaerieStorageIndex::SetCopies(const FEntryKey Key, const int32 Copies)
+{
+	if (const int32 Index = IndexOf(Key);
+		Index != INDEX_NONE)
+	{
+		if (FFaerieStorageIndexEntry& Entry = Entries[Index];
+			Entry.Copies != Copies)
+		{
+			Entry.Copies = Copies;
+			MarkItemDirty(Entry);
+		}
+		return;
+	}
+
+	MarkItemDirty(Insert(FFaerieStorageIndexEntry(Key, Copies)));
+}
+
+void FFaerieStorageIndex::RemoveKey(const FEntryKey Key)
+{
+	if (Remove(Key))
+	{
+		MarkArrayDirty();
+	}
+}
+
+void FFaerieStorageIndex::Reset()
+{
+	Entries.Reset();
+	MarkArrayDirty();
+}
+
+void UFaerieStoragePage::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(ThisClass, PageIndex, COND_InitialOnly);
+
+	FDoRepLifetimeParams EntriesParams;
+	EntriesParams.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, Entries, EntriesParams)
+}
+
+void UFaerieStoragePage::MarkEntriesDirty()
+{
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Entries, this);
+}
+
+void UFaerieStoragePage::OnRep_Entries()
+{
+	GetOuterUFaerieItemStorage()->Client_ReceivePage(this);
+}
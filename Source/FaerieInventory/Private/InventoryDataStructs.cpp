@@ -6,6 +6,7 @@
 #include "FaerieItemStorage.h"
 #include "InventoryDataEnums.h"
 #include "HAL/LowLevelMemStats.h"
+#include "UObject/CoreNet.h"
 #include "Tokens/FaerieStackLimiterToken.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(InventoryDataStructs)
@@ -25,31 +26,93 @@ namespace LocalCopy
 	}
 }
 
-FInventoryEntry::FInventoryEntry(FFaerieItemStackView InStack, const FEntryKey EntryKey, TArray<FFaerieAddress>& OutNewAddresses)
+bool FKeyedStack::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
 {
-	ItemObject = InStack.Item.Get();
-	Key = EntryKey;
+	int32 KeyValue = Key.Value();
+	Faerie::Inventory::Net::SerializePackedInt(Ar, KeyValue);
+	Faerie::Inventory::Net::SerializePackedInt(Ar, Stack);
 
-	UpdateCachedStackLimit();
+	if (Ar.IsLoading())
+	{
+		Key = FStackKey(KeyValue);
+	}
 
-	if (Limit == Faerie::ItemData::UnlimitedStack)
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+namespace Faerie::Inventory::Net
+{
+	// Guards against reading a corrupt array count.
+	static constexpr uint32 MaxSerializedStacks = 1 << 16;
+
+	void SerializePackedInt(FArchive& Ar, int32& Value)
 	{
-		const FStackKey NewKey = KeyGen.NextKey();
-		Stacks.Emplace(NewKey, InStack.Copies);
-		OutNewAddresses.Add(LocalCopy::Encode(Key, NewKey));
+		uint32 Encoded = (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+		Ar.SerializeIntPacked(Encoded);
+
+		if (Ar.IsLoading())
+		{
+			Value = static_cast<int32>(Encoded >> 1) ^ -static_cast<int32>(Encoded & 1);
+		}
 	}
-	else
+
+	bool SerializeStacks(FArchive& Ar, TArray<FKeyedStack>& Stacks)
 	{
-		// Split the incoming stack into as many more as are required
-		while (InStack.Copies > 0)
+		uint8 SingleStack = Stacks.Num() == 1;
+		Ar.SerializeBits(&SingleStack, 1);
+
+		uint32 NumStacks = 1;
+		if (!SingleStack)
 		{
-			const int32 NewStack = FMath::Min(InStack.Copies, Limit);
-			InStack.Copies -= NewStack;
+			NumStacks = Stacks.Num();
+			Ar.SerializeIntPacked(NumStacks);
 
-			const FStackKey NewKey = KeyGen.NextKey();
-			Stacks.Emplace(NewKey, NewStack);
-			OutNewAddresses.Add(LocalCopy::Encode(Key, NewKey));
+			if (NumStacks > MaxSerializedStacks)
+			{
+				Ar.SetError();
+				return false;
+			}
 		}
+
+		if (Ar.IsLoading())
+		{
+			Stacks.SetNum(NumStacks);
+		}
+
+		int32 PreviousKey = TKeyGen<FStackKey>::InitialPosition;
+		for (FKeyedStack& Stack : Stacks)
+		{
+			int32 KeyDelta = Stack.Key.Value() - PreviousKey;
+			SerializePackedInt(Ar, KeyDelta);
+			SerializePackedInt(Ar, Stack.Stack);
+
+			if (Ar.IsLoading())
+			{
+				Stack.Key = FStackKey(PreviousKey + KeyDelta);
+			}
+			PreviousKey = Stack.Key.Value();
+		}
+
+		return !Ar.IsError();
+	}
+}
+
+FInventoryEntry::FInventoryEntry(const FFaerieItemStackView InStack, const FEntryKey EntryKey, TArray<FFaerieAddress>& OutNewAddresses)
+  : FInventoryEntry(InStack.Item.Get(), EntryKey, MakeArrayView(&InStack.Copies, 1), OutNewAddresses)
+{
+}
+
+FInventoryEntry::FInventoryEntry(const UFaerieItem* Item, const FEntryKey EntryKey, const TConstArrayView<int32> StackCopies, TArray<FFaerieAddress>& OutNewAddresses)
+{
+	ItemObject = Item;
+	Key = EntryKey;
+
+	UpdateCachedStackLimit();
+
+	for (const int32 Copies : StackCopies)
+	{
+		EmplaceNewStacks(Copies, OutNewAddresses);
 	}
 }
 
@@ -73,6 +136,29 @@ void FInventoryEntry::UpdateCachedStackLimit()
 	Limit = UFaerieStackLimiterToken::GetItemStackLimit(ItemObject);
 }
 
+void FInventoryEntry::EmplaceNewStacks(int32 Amount, TArray<FFaerieAddress>& OutNewAddresses)
+{
+	if (Limit == Faerie::ItemData::UnlimitedStack)
+	{
+		const FStackKey NewKey = KeyGen.NextKey();
+		Stacks.Emplace(NewKey, Amount);
+		OutNewAddresses.Add(LocalCopy::Encode(Key, NewKey));
+	}
+	else
+	{
+		// Split the incoming stack into as many more as are required
+		while (Amount > 0)
+		{
+			const int32 NewStack = FMath::Min(Amount, Limit);
+			Amount -= NewStack;
+
+			const FStackKey NewKey = KeyGen.NextKey();
+			Stacks.Emplace(NewKey, NewStack);
+			OutNewAddresses.Add(LocalCopy::Encode(Key, NewKey));
+		}
+	}
+}
+
 bool FInventoryEntry::Contains(const FStackKey InKey) const
 {
 	return GetStackIndex(InKey) != INDEX_NONE;
@@ -155,6 +241,33 @@ FFaerieItemStackView FInventoryEntry::ToItemStackView() const
 	};
 }
 
+bool FInventoryEntry::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	int32 KeyValue = Key.Value();
+	Faerie::Inventory::Net::SerializePackedInt(Ar, KeyValue);
+
+	UObject* Object = const_cast<UFaerieItem*>(ItemObject.Get());
+	if (Map)
+	{
+		// An unmapped object is not a failure. The fast array will resolve it when it arrives.
+		Map->SerializeObject(Ar, UFaerieItem::StaticClass(), Object);
+	}
+	else
+	{
+		Ar << Object;
+	}
+
+	bOutSuccess = Faerie::Inventory::Net::SerializeStacks(Ar, Stacks);
+
+	if (Ar.IsLoading())
+	{
+		Key = FEntryKey(KeyValue);
+		ItemObject = Cast<UFaerieItem>(Object);
+	}
+
+	return true;
+}
+
 void FInventoryEntry::PostSerialize(const FArchive& Ar)
 {
 	if (Ar.IsLoading())
@@ -173,11 +286,14 @@ void FInventoryEntry::PostScriptConstruct()
 
 void FInventoryEntry::PreReplicatedRemove(const FInventoryContent& InArraySerializer)
 {
+	InArraySerializer.GetDenseKeyTable().Invalidate();
 	InArraySerializer.PreEntryReplicatedRemove(*this);
 }
 
 void FInventoryEntry::PostReplicatedAdd(const FInventoryContent& InArraySerializer)
 {
+	InArraySerializer.GetDenseKeyTable().Invalidate();
+
 	// Update the cached limit on the client so it isn't 0.
 	UpdateCachedStackLimit();
 	InArraySerializer.PostEntryReplicatedAdd(*this);
@@ -233,13 +349,16 @@ FInventoryEntry::FMutableAccess::~FMutableAccess()
 	Source.WriteLock--;
 
 	// Propagate change to client
-	Source.MarkItemDirty(Handle);
+	Source.MarkEntryDirty(Handle);
 
 	// Broadcast change on server if anything was changed
 	if (ChangeMask.CountSetBits() != 0)
 	{
 		Source.PostEntryReplicatedChange_Server(Handle, FInventoryContent::Server_ItemHandleClosed, ChangeMask);
 	}
+
+	// If a deferred removal scope closed while we held the lock, finish its work now.
+	Source.ConditionalCompact();
 }
 
 void FInventoryEntry::FMutableAccess::SetStack(const FStackKey InKey, const int32 Stack)
@@ -449,8 +568,9 @@ void FInventoryContent::Append(const FInventoryEntry& Entry)
 			TEXT("If this is hit, then Key is not sequential and Append was not safe to use. Either use a validated Key, or use FInventoryContent::Insert"));
 	}
 
+	KeyTable.NotifyAppended(Entry.Key.Value(), Entries.Num());
 	FInventoryEntry& NewItemRef = Entries.Emplace_GetRef(Entry);
-	MarkItemDirty(NewItemRef);
+	MarkEntryDirty(NewItemRef);
 	PostEntryReplicatedAdd(NewItemRef);
 }
 
@@ -461,11 +581,49 @@ void FInventoryContent::AppendUnsafe(const FInventoryEntry& Entry)
 
 	LLM_SCOPE_BYTAG(ItemStorage);
 
+	// The key table does not depend on order, so this can be registered even if the key is out of sequence.
+	KeyTable.NotifyAppended(Entry.Key.Value(), Entries.Num());
 	FInventoryEntry& NewItemRef = Entries.Emplace_GetRef(Entry);
-	MarkItemDirty(NewItemRef);
+	MarkEntryDirty(NewItemRef);
 	PostEntryReplicatedAdd(NewItemRef);
 }
 
+void FInventoryContent::AppendUnsafe(TArray<FInventoryEntry>&& NewEntries)
+{
+	check(WriteLock == 0);
+
+	if (NewEntries.IsEmpty()) return;
+
+	LLM_SCOPE_BYTAG(ItemStorage);
+
+	TArray<FEntryKey> NewKeys;
+	NewKeys.Reserve(NewEntries.Num());
+
+	Entries.Reserve(Entries.Num() + NewEntries.Num());
+	for (FInventoryEntry& Entry : NewEntries)
+	{
+		check(Entry.Key.IsValid());
+		NewKeys.Add(Entry.Key);
+		KeyTable.NotifyAppended(Entry.Key.Value(), Entries.Num());
+		Entries.Emplace(MoveTemp(Entry));
+	}
+	NewEntries.Reset();
+
+	// Sequential keys will already be in order, in which case this is only a linear check.
+	if (!IsSorted())
+	{
+		Sort();
+	}
+
+	for (const FEntryKey NewKey : NewKeys)
+	{
+		FInventoryEntry& NewItemRef = (*this)[NewKey];
+		// Each new item must still be marked individually, to be assigned a ReplicationID.
+		MarkEntryDirty(NewItemRef);
+		PostEntryReplicatedAdd(NewItemRef);
+	}
+}
+
 void FInventoryContent::Insert(const FInventoryEntry& Entry)
 {
 	check(Entry.Key.IsValid());
@@ -473,10 +631,16 @@ void FInventoryContent::Insert(const FInventoryEntry& Entry)
 
 	LLM_SCOPE_BYTAG(ItemStorage);
 
+	// Insert may overwrite an existing entry in place, which must not be a tombstone.
+	if (HasTombstones())
+	{
+		Compact();
+	}
+
 	FInventoryEntry& NewEntry = BSOA::Insert(Entry);
 
 	PostEntryReplicatedAdd(NewEntry);
-	MarkItemDirty(NewEntry);
+	MarkEntryDirty(NewEntry);
 }
 
 void FInventoryContent::Remove(const FEntryKey Key)
@@ -484,6 +648,31 @@ void FInventoryContent::Remove(const FEntryKey Key)
 	check(Key.IsValid());
 	check(WriteLock == 0);
 
+	if (DeferredRemovalDepth > 0)
+	{
+		if (const int32 Index = IndexOf(Key);
+			Index != INDEX_NONE)
+		{
+			FInventoryEntry& Entry = Entries[Index];
+
+			// Notify owning server of this removal. Clients are notified once the entry is compacted out.
+			PreEntryReplicatedRemove(Entry);
+
+			// Indices do not change, so the key table stays valid.
+			Entry.bTombstone = true;
+			NumTombstones++;
+
+			// Even inside a scope, don't let dead entries make up most of the array.
+			if (WriteLock == 0 &&
+				NumTombstones >= MinTombstonesToCompact &&
+				NumTombstones >= Entries.Num() * MaxTombstoneRatio)
+			{
+				Compact();
+			}
+		}
+		return;
+	}
+
 	if (BSOA::Remove(Key,
 		[this](const FInventoryEntry& Entry)
 		{
@@ -496,6 +685,93 @@ void FInventoryContent::Remove(const FEntryKey Key)
 	}
 }
 
+void FInventoryContent::Compact()
+{
+	check(WriteLock == 0);
+
+	if (!HasTombstones()) return;
+
+	LLM_SCOPE_BYTAG(ItemStorage);
+
+	// RemoveAll is stable, so key order is preserved. Tombstones kept their ReplicationIDs until now, so to clients this
+	// is no different from removing each entry individually.
+	Entries.RemoveAll([](const FInventoryEntry& Entry) { return Entry.bTombstone; });
+	NumTombstones = 0;
+	KeyTable.Invalidate();
+
+	// Notify clients of these removals.
+	MarkArrayDirty();
+}
+
+void FInventoryContent::ConditionalCompact()
+{
+	if (HasTombstones() && DeferredRemovalDepth == 0 && WriteLock == 0)
+	{
+		Compact();
+	}
+}
+
+FInventoryContent::FDeferredRemovalScope::FDeferredRemovalScope(FInventoryContent& Content)
+  : Content(Content)
+{
+	Content.DeferredRemovalDepth++;
+}
+
+FInventoryContent::FDeferredRemovalScope::~FDeferredRemovalScope()
+{
+	check(Content.DeferredRemovalDepth > 0);
+	Content.DeferredRemovalDepth--;
+
+	// If something is still iterating, this will be deferred until it's done.
+	Content.ConditionalCompact();
+}
+
+void FInventoryContent::MarkEntryDirty(FInventoryEntry& Entry)
+{
+	if (DeferredDirtyDepth > 0)
+	{
+		PendingDirtyKeys.Add(Entry.Key);
+		return;
+	}
+
+	MarkItemDirty(Entry);
+}
+
+FInventoryContent::FDeferredDirtyScope::FDeferredDirtyScope(FInventoryContent& Content)
+  : Content(Content)
+{
+	Content.DeferredDirtyDepth++;
+}
+
+FInventoryContent::FDeferredDirtyScope::~FDeferredDirtyScope()
+{
+	check(Content.DeferredDirtyDepth > 0);
+	if (--Content.DeferredDirtyDepth > 0) return;
+
+	// Entries that were removed during the scope are simply skipped.
+	for (const FEntryKey Key : Content.PendingDirtyKeys)
+	{
+		if (const int32 Index = Content.IndexOf(Key);
+			Index != INDEX_NONE)
+		{
+			Content.MarkItemDirty(Content.Entries[Index]);
+		}
+	}
+	Content.PendingDirtyKeys.Reset();
+}
+
+int32 FInventoryContent::FindNextLiveIndex(const int32 StartIndex) const
+{
+	for (int32 i = StartIndex; i < Entries.Num(); ++i)
+	{
+		if (!Entries[i].bTombstone)
+		{
+			return i;
+		}
+	}
+	return INDEX_NONE;
+}
+
 void FInventoryContent::LockWriteAccess() const
 {
 #if FAERIE_DEBUG
@@ -517,6 +793,12 @@ void FInventoryContent::UnlockWriteAccess() const
 	}
 #endif
 	WriteLock--;
+
+	// Compaction is deferred while iterators are alive.
+	if (WriteLock == 0 && HasTombstones())
+	{
+		const_cast<FInventoryContent*>(this)->ConditionalCompact();
+	}
 }
 
 void FInventoryContent::PreEntryReplicatedRemove(const FInventoryEntry& Entry) const
@@ -560,7 +842,7 @@ FInventoryContent::TRangedForConstIterator FInventoryContent::begin() const
 	}
 #endif
 	WriteLock++;
-	return TRangedForConstIterator(Entries.begin());
+	return TRangedForConstIterator(Entries.GetData(), Entries.GetData() + Entries.Num());
 }
 
 FInventoryContent::TRangedForConstIterator FInventoryContent::end() const
@@ -573,5 +855,5 @@ FInventoryContent::TRangedForConstIterator FInventoryContent::end() const
 	}
 #endif
 	WriteLock--;
-	return TRangedForConstIterator(Entries.end());
+	return TRangedForConstIterator(Entries.GetData() + Entries.Num(), Entries.GetData() + Entries.Num());
 }
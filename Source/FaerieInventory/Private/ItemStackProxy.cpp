@@ -18,6 +18,16 @@ namespace Faerie::Inventory
 	UE_DEFINE_GAMEPLAY_TAG_TYPED(FFaerieInventoryTag, ProxyRemoved, "Fae.Inventory.ProxyRemoved")
 }
 
+UFaerieItemStorage* FFaerieStackProxyLease::GetStorage() const
+{
+	return IsValid() ? Proxy->GetStorage() : nullptr;
+}
+
+bool FFaerieStackProxyLease::IsValid() const
+{
+	return ::IsValid(Proxy) && Proxy->Binding == Binding;
+}
+
 const UFaerieItem* UFaerieItemStackProxy::GetItemObject() const
 {
 	if (!VerifyStatus())
@@ -110,6 +120,16 @@ void UFaerieItemStackProxy::NotifyRemoval()
 	OnCacheRemoved.Broadcast(this, Inventory::ProxyRemoved);
 }
 
+void UFaerieItemStackProxy::Unbind()
+{
+	OnProxyEvent.Clear();
+	OnCacheUpdated.Clear();
+	OnCacheRemoved.Clear();
+	Address = FFaerieAddress();
+	LocalItemVersion = -1;
+	Binding++;
+}
+
 bool UFaerieItemStackProxy::VerifyStatus() const
 {
 	auto&& Storage = GetStorage();
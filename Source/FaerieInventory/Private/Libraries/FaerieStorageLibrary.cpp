@@ -40,6 +40,35 @@ TArray<UFaerieItemStackProxy*> UFaerieStorageLibrary::GetAllStackProxies(UFaerie
 	return Proxies;
 }
 
+TArray<FFaerieStackProxyLease> UFaerieStorageLibrary::AcquireAllStackProxies(UFaerieItemStorage* Storage)
+{
+	if (!IsValid(Storage)) return {};
+
+	// Collect the addresses first, as acquiring proxies may touch the storage's proxy map.
+	TArray<FFaerieAddress> Addresses;
+	Storage->GetAllAddresses(Addresses);
+
+	TArray<FFaerieStackProxyLease> Leases;
+	Leases.Reserve(Addresses.Num());
+	for (const FFaerieAddress Address : Addresses)
+	{
+		Leases.Add(Storage->AcquireStackProxy(Address));
+	}
+	return Leases;
+}
+
+void UFaerieStorageLibrary::ReleaseStackProxies(TArray<FFaerieStackProxyLease>& Leases)
+{
+	for (FFaerieStackProxyLease& Lease : Leases)
+	{
+		if (UFaerieItemStorage* Storage = Lease.GetStorage())
+		{
+			Storage->ReleaseStackProxy(Lease);
+		}
+	}
+	Leases.Empty();
+}
+
 FFaerieAddress UFaerieStorageLibrary::QueryFirst(UFaerieItemStorage* Storage, const FFaerieViewPredicate& Filter)
 {
 	using namespace Faerie::Container;
@@ -4,6 +4,7 @@
 
 #include "FaerieFunctionTemplates.h"
 #include "FaerieItemContainerStructs.h"
+#include "ItemStackProxy.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "FaerieStorageLibrary.generated.h"
 
@@ -34,10 +35,17 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Faerie|Storage Library")
 	static TScriptInterface<IFaerieItemOwnerInterface> GetViewOwner(const FFaerieItemDataViewWrapper& View);
 
-	// Query function to filter for the first matching entry.
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Storage Library")
 	static TArray<UFaerieItemStackProxy*> GetAllStackProxies(UFaerieItemStorage* Storage);
 
+	// Acquire a proxy for every stack in a storage. They must be handed back with ReleaseStackProxies when done.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Storage Library")
+	static TArray<FFaerieStackProxyLease> AcquireAllStackProxies(UFaerieItemStorage* Storage);
+
+	// Hand back proxies acquired by AcquireAllStackProxies, and empty the array.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Storage Library")
+	static void ReleaseStackProxies(UPARAM(ref) TArray<FFaerieStackProxyLease>& Leases);
+
 	// Query function to filter for the first matching entry.
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Storage Library")
 	static FFaerieAddress QueryFirst(UFaerieItemStorage* Storage, const UFaerieFunctionTemplates::FFaerieViewPredicate& Filter);
@@ -8,8 +8,10 @@
 #include "StructUtils/InstancedStruct.h"
 #include "FaerieInventoryClient.generated.h"
 
+class APlayerController;
 class UFaerieInventoryClient;
 class UFaerieItemContainerBase;
+class UFaerieItemStorage;
 
 UENUM()
 enum class EFaerieClientRequestBatchType : uint8
@@ -62,11 +64,16 @@ class FAERIEINVENTORY_API UFaerieInventoryClient : public UActorComponent
 public:
 	UFaerieInventoryClient();
 
+	//~ UActorComponent
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+	//~ UActorComponent
+
 	// Overrides for allowing a client to run a request on the server.
 	virtual bool CanAccessContainer(TNotNull<const UFaerieItemContainerBase*> Container, const UScriptStruct* RequestType) const;
 
 	/**
 	 * Sends a request to the server to perform an inventory related edit.
+	 * On clients, requests made in the same frame are queued and sent together in one batch, in the order they were made.
 	 * To define custom actions, derive a struct from FFaerieClientActionBase, and override Server_Execute.
 	 */
 	void RequestExecuteAction(const FFaerieClientActionBase& Args);
@@ -77,6 +84,10 @@ public:
 	 */
 	void RequestExecuteAction_Batch(const TArray<const FFaerieClientActionBase*>& Args, EFaerieClientRequestBatchType Type);
 
+	// Immediately send any requests queued this frame, instead of waiting for the end of the frame.
+	// Returns the number of RPCs the queue was sent in.
+	int32 FlushQueuedActions();
+
 	/**
 	 * A specialized movement request.
 	 * To define custom actions, derive a struct from FFaerieClientAction_MoveHandlerBase, and override everything.
@@ -92,36 +103,91 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Faerie|InventoryClient")
 	void SetStackChoicePromptHandler(const FFaerieClientStackPromptHandler& Handler);
 
+	/**
+	 * Make pages of a storage that uses paged replication resident on this client, requesting them from the server.
+	 * Once more than MaxResidentStoragePages are resident, the least recently viewed pages are evicted, which removes their
+	 * entries from the storage on this client.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Faerie|InventoryClient")
+	void ViewStoragePages(UFaerieItemStorage* Storage, const TArray<int32>& Pages);
+
+	// View the pages holding a range of entries, by their position in the storage index, e.g., the rows of a list.
+	UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Faerie|InventoryClient")
+	void ViewStorageRange(UFaerieItemStorage* Storage, int32 First, int32 Count);
+
+	// Evict every resident page of a storage.
+	UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Faerie|InventoryClient")
+	void ReleaseStoragePages(UFaerieItemStorage* Storage);
+
 protected:
 	/**
-	 * Sends a request to the server to perform an inventory related edit.
+	 * Sends a request to the server to perform an inventory related edit. Queued with other requests like the native version.
 	 * Args must be an InstancedStruct deriving from FFaerieClientActionBase.
 	 * This can be used by calling MakeInstancedStruct, and passing any struct into it that is named like "FFaerieClientAction_...".
 	 */
-	UFUNCTION(BlueprintCallable, Server, Reliable, Category = "Faerie|InventoryClient")
+	UFUNCTION(BlueprintCallable, Category = "Faerie|InventoryClient")
 	void RequestExecuteAction(const TInstancedStruct<FFaerieClientActionBase>& Args);
 
 	/**
-	 * Sends requests to the server to perform a batch of inventory related edits.
+	 * Sends requests to the server to perform a batch of inventory related edits. Queued with other requests like the native version.
 	 * Each Args struct must be an InstancedStruct deriving from FFaerieClientActionBase.
 	 * This can be used by calling MakeInstancedStruct, and passing any struct into it that is named like "FFaerieClientAction_...".
 	 */
-	UFUNCTION(BlueprintCallable, Server, Reliable, Category = "Faerie|InventoryClient")
+	UFUNCTION(BlueprintCallable, Category = "Faerie|InventoryClient")
 	void RequestExecuteAction_Batch(const TArray<TInstancedStruct<FFaerieClientActionBase>>& Args, EFaerieClientRequestBatchType Type);
 
 	/**
-	 * A specialized movement request.
+	 * A specialized movement request. Sent after any queued requests.
 	 * Args must be an InstancedStruct deriving from FFaerieClientAction_MoveHandlerBase.
 	 * This can be used by calling MakeInstancedStruct, and passing any struct into it that is named like "FFaerieClientAction_Move...".
 	 */
-	UFUNCTION(BlueprintCallable, Server, Reliable, Category = "Faerie|InventoryClient")
+	UFUNCTION(BlueprintCallable, Category = "Faerie|InventoryClient")
 	void RequestMoveAction(const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveFrom, const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveTo);
 
+	// The RPCs behind the requests above. Only sent through them, so that queued requests are never overtaken.
+	UFUNCTION(Server, Reliable)
+	void SendExecuteAction(const TInstancedStruct<FFaerieClientActionBase>& Args);
+
+	UFUNCTION(Server, Reliable)
+	void SendExecuteAction_Batch(const TArray<TInstancedStruct<FFaerieClientActionBase>>& Args, EFaerieClientRequestBatchType Type);
+
+	UFUNCTION(Server, Reliable)
+	void SendMoveAction(const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveFrom, const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveTo);
+
+	// Tells the server which pages of a paged storage to start and stop sending to us.
+	UFUNCTION(Server, Reliable)
+	void RequestStoragePages(UFaerieItemStorage* Storage, const TArray<int32>& Acquired, const TArray<int32>& Released);
+
+	// Tells us which of the pages we requested the server will not send, so we stop keeping them resident.
+	UFUNCTION(Client, Reliable)
+	void RejectStoragePages(UFaerieItemStorage* Storage, const TArray<int32>& Pages);
+
+	// Maximum number of pages, across all paged storages, to keep resident on this client.
+	UPROPERTY(EditAnywhere, Category = "Paging", meta = (ClampMin = 1))
+	int32 MaxResidentStoragePages = 16;
+
 private:
+	APlayerController* GetOwningPlayerController() const;
 	void Server_RequestExecuteAction(const FFaerieClientActionBase& Args);
 	void Server_RequestExecuteAction_Batch(const TArray<const FFaerieClientActionBase*>& Args, EFaerieClientRequestBatchType Type);
 	void Server_RequestMoveAction(const FFaerieClientAction_MoveHandlerBase& MoveFrom, const FFaerieClientAction_MoveHandlerBase& MoveTo);
 
+	void QueueAction(TInstancedStruct<FFaerieClientActionBase>&& Args);
+	void SendOrQueueAction(TInstancedStruct<FFaerieClientActionBase>&& Args);
+	void SendOrQueueBatch(TArray<TInstancedStruct<FFaerieClientActionBase>>&& Args, EFaerieClientRequestBatchType Type);
+
+	// Client: Requests made this frame, waiting to be sent together.
+	TArray<TInstancedStruct<FFaerieClientActionBase>> QueuedActions;
+	FTimerHandle FlushQueuedActionsTimer;
+
 	FFaerieClientStackPromptHandler StackPromptHandler;
 	FFaerieClientStackPromptCallback ActivePromptCallback;
+
+	using FStoragePage = TPair<TWeakObjectPtr<UFaerieItemStorage>, int32>;
+
+	// Client: Resident pages, from least to most recently viewed.
+	TArray<FStoragePage> ResidentStoragePages;
+
+	// Server: Pages that this client is being sent.
+	TArray<FStoragePage> RelevantStoragePages;
 };
\ No newline at end of file
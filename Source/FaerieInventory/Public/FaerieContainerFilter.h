@@ -43,14 +43,14 @@ namespace Faerie::Container
 		{ Predicate.Exec(Iterator) } -> UE::CSameAs<bool>;
 	};
 
-	template <bool View, typename ResolveType, EFilterFlags Flags, CFilterPredicate... TPredicates>
+	template <bool View, typename ResolveType, EFilterFlags Flags, typename TContainer, CFilterPredicate... TPredicates>
 	class TFilteringIterator
 	{
 		using InputType = std::conditional_t<View, const Utils::TPredicateTuple<TPredicates...>&, Utils::TPredicateTuple<TPredicates...>&&>;
 		using FieldType = std::conditional_t<View, const Utils::TPredicateTuple<TPredicates...>&, Utils::TPredicateTuple<TPredicates...>>;
 
 	public:
-		explicit TFilteringIterator(InputType PredicateTuple, const TNotNull<const UFaerieItemContainerBase*> Container)
+		explicit TFilteringIterator(InputType PredicateTuple, const TNotNull<const TContainer*> Container)
 		  : PredicateTuple(MoveTempIfPossible(PredicateTuple)),
 			Iterator(Container)
 		{
@@ -104,7 +104,7 @@ namespace Faerie::Container
 		FieldType PredicateTuple;
 
 		// If MutableOnly has been enabled by a predicate, use the automatic skip feature in TIterator
-		TIterator<ResolveType, EnumHasAnyFlags(Flags, EFilterFlags::MutableOnly)> Iterator;
+		TIterator<ResolveType, EnumHasAnyFlags(Flags, EFilterFlags::MutableOnly), TContainer> Iterator;
 	};
 
 	template <EFilterFlags Flags, typename ResolveType, CFilterPredicate... TPredicates>
@@ -190,18 +190,23 @@ namespace Faerie::Container
 		}
 
 		// Create an iterator from this filter.
-		[[nodiscard]] UE_REWRITE auto Iterate(TNotNull<const UFaerieItemContainerBase*> Container) const &
+		// When the container's type is statically known to provide an inline iterator, such as UFaerieItemStorage, it is
+		// iterated without allocating or dispatching through the container's virtual interface.
+		template <typename TContainerPtr>
+		[[nodiscard]] UE_REWRITE auto Iterate(const TContainerPtr& Container) const &
 		{
-			return TFilteringIterator<true, ResolveType, Flags, TPredicates...>(PredicateTuple, Container);
+			return TFilteringIterator<true, ResolveType, Flags, Private::TIterationContainerOf<TContainerPtr>, TPredicates...>(PredicateTuple, Container);
 		}
 
 		// Create an iterator from this filter.
-		[[nodiscard]] UE_REWRITE auto Iterate(TNotNull<const UFaerieItemContainerBase*> Container) &&
+		template <typename TContainerPtr>
+		[[nodiscard]] UE_REWRITE auto Iterate(const TContainerPtr& Container) &&
 		{
-			return TFilteringIterator<false, ResolveType, Flags, TPredicates...>(MoveTemp(PredicateTuple), Container);
+			return TFilteringIterator<false, ResolveType, Flags, Private::TIterationContainerOf<TContainerPtr>, TPredicates...>(MoveTemp(PredicateTuple), Container);
 		}
 
-		[[nodiscard]] int32 Count(const TNotNull<const UFaerieItemContainerBase*> Container) const
+		template <typename TContainerPtr>
+		[[nodiscard]] int32 Count(const TContainerPtr& Container) const
 		{
 			int32 OutCount = 0;
 			for (auto It = Iterate(Container); It; ++It)
@@ -211,7 +216,8 @@ namespace Faerie::Container
 			return OutCount;
 		}
 
-		[[nodiscard]] TArray<ResolveType> Emit(const TNotNull<const UFaerieItemContainerBase*> Container) const
+		template <typename TContainerPtr>
+		[[nodiscard]] TArray<ResolveType> Emit(const TContainerPtr& Container) const
 		{
 			TArray<ResolveType> OutItems;
 			for (auto It = Iterate(Container); It; ++It)
@@ -221,7 +227,8 @@ namespace Faerie::Container
 			return OutItems;
 		}
 
-		[[nodiscard]] ResolveType First(const TNotNull<const UFaerieItemContainerBase*> Container) const
+		template <typename TContainerPtr>
+		[[nodiscard]] ResolveType First(const TContainerPtr& Container) const
 		{
 			if (auto It = Iterate(Container);
 				It)
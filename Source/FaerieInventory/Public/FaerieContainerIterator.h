@@ -6,6 +6,9 @@
 #include "FaerieItemDataViewBase.h"
 #include "LoopUtils.h"
 #include "DebuggingFlags.h"
+#include "UObject/ObjectPtr.h"
+
+class UFaerieItemStorage;
 
 namespace Faerie::Container
 {
@@ -48,14 +51,66 @@ namespace Faerie::Container
 				return FIteratorAccess::CreateEntryIteratorImpl(Container);
 			}
 		}
+
+		// Owns the iterator that a TIterator walks. By default, the container creates it on the heap through its virtual
+		// interface. Containers that know their iterator type statically can specialize this to hold it inline instead.
+		template <typename TContainer, bool IterateAddresses>
+		class TIteratorStorage
+		{
+		public:
+			UE_REWRITE explicit TIteratorStorage(const TNotNull<const UFaerieItemContainerBase*> Container)
+			  : Ptr(CreateIteratorImpl<IterateAddresses>(Container)) {}
+
+			UE_REWRITE explicit TIteratorStorage(TUniquePtr<IIterator>&& Iterator)
+			  : Ptr(MoveTemp(Iterator)) {}
+
+			[[nodiscard]] UE_REWRITE IIterator* Get() const { return Ptr.Get(); }
+
+		private:
+			TUniquePtr<IIterator> Ptr;
+		};
+
+		template <typename TContainer>
+		struct TIteratorTraits
+		{
+			// Set to true by containers that specialize TIteratorStorage.
+			static constexpr bool InlineStorage = false;
+		};
+
+		// Specializations must be declared here, alongside the primary templates, so that every translation unit sees
+		// them, even those that only forward declare the container. TIteratorStorage for storages is defined in
+		// FaerieItemStorageIterators.h.
+		template <>
+		struct TIteratorTraits<UFaerieItemStorage>
+		{
+			static constexpr bool InlineStorage = true;
+		};
+
+		template <bool IterateAddresses>
+		class TIteratorStorage<UFaerieItemStorage, IterateAddresses>;
+
+		// The container type to instantiate iterators for. Containers without inline storage all share the base class version.
+		template <typename TContainer>
+		using TIterationContainer = std::conditional_t<TIteratorTraits<TContainer>::InlineStorage, TContainer, UFaerieItemContainerBase>;
+
+		// Anything else that converts to a container pointer uses the base class version.
+		template <typename T> struct TContainerPointee { using Type = UFaerieItemContainerBase; };
+		template <typename T> struct TContainerPointee<T*> { using Type = std::remove_cv_t<T>; };
+		template <typename T> struct TContainerPointee<TNotNull<T*>> { using Type = std::remove_cv_t<T>; };
+		template <typename T> struct TContainerPointee<TObjectPtr<T>> { using Type = std::remove_cv_t<T>; };
+		template <typename T> struct TContainerPointee<TNotNull<TObjectPtr<T>>> { using Type = std::remove_cv_t<T>; };
+
+		// Resolves the container type to instantiate iterators for from a raw, not-null, or object pointer to a container.
+		template <typename TContainerPtr>
+		using TIterationContainerOf = TIterationContainer<typename TContainerPointee<std::remove_cvref_t<TContainerPtr>>::Type>;
 	}
 
-	template <typename ResolveType, bool SkipToNextMutable>
+	template <typename ResolveType, bool SkipToNextMutable, typename TContainer = UFaerieItemContainerBase>
 	class TIterator
 	{
 	public:
-		UE_REWRITE explicit TIterator(const TNotNull<const UFaerieItemContainerBase*> Container)
-		  : IteratorPtr(Private::CreateIteratorImpl<std::is_same_v<ResolveType, FFaerieAddress>>(Container))
+		UE_REWRITE explicit TIterator(const TNotNull<const TContainer*> Container)
+		  : IteratorPtr(Container)
 		{
 			LOG_ITERATOR_MESSAGE("TIterator::Ctor from Container")
 
@@ -98,19 +153,19 @@ namespace Faerie::Container
 
 			if constexpr (std::is_same_v<ResolveType, FEntryKey>)
 			{
-				return IteratorPtr->ResolveKey();
+				return IteratorPtr.Get()->ResolveKey();
 			}
 			else if constexpr (std::is_same_v<ResolveType, FFaerieAddress>)
 			{
-				return IteratorPtr->ResolveAddress();
+				return IteratorPtr.Get()->ResolveAddress();
 			}
 			else if constexpr (std::is_same_v<ResolveType, TNotNull<const UFaerieItem*>>)
 			{
-				return IteratorPtr->ResolveItem();
+				return IteratorPtr.Get()->ResolveItem();
 			}
 			else if constexpr (std::is_same_v<ResolveType, TNotNull<UFaerieItem*>>)
 			{
-				return IteratorPtr->ResolveItem()->MutateCast();
+				return IteratorPtr.Get()->ResolveItem()->MutateCast();
 			}
 			else
 			{
@@ -120,21 +175,21 @@ namespace Faerie::Container
 
 		void SkipInvalid()
 		{
-			while (static_cast<bool>(*this) && !IteratorPtr->ResolveItem()->CanMutate())
+			while (static_cast<bool>(*this) && !IteratorPtr.Get()->ResolveItem()->CanMutate())
 			{
-				IteratorPtr->Advance();
+				IteratorPtr.Get()->Advance();
 			}
 		}
 
-		[[nodiscard]] UE_REWRITE FEntryKey GetKey() const { return IteratorPtr->ResolveKey(); }
-		[[nodiscard]] UE_REWRITE FFaerieAddress GetAddress() const { return IteratorPtr->ResolveAddress(); }
-		[[nodiscard]] UE_REWRITE const UFaerieItem* GetItem() const { return IteratorPtr->ResolveItem(); }
+		[[nodiscard]] UE_REWRITE FEntryKey GetKey() const { return IteratorPtr.Get()->ResolveKey(); }
+		[[nodiscard]] UE_REWRITE FFaerieAddress GetAddress() const { return IteratorPtr.Get()->ResolveAddress(); }
+		[[nodiscard]] UE_REWRITE const UFaerieItem* GetItem() const { return IteratorPtr.Get()->ResolveItem(); }
 
 		UE_REWRITE void operator++()
 		{
 			LOG_ITERATOR_MESSAGE("TIterator::operator++");
 
-			IteratorPtr->Advance();
+			IteratorPtr.Get()->Advance();
 
 			if constexpr (SkipToNextMutable)
 			{
@@ -145,13 +200,13 @@ namespace Faerie::Container
 
 		UE_REWRITE explicit operator bool() const
 		{
-			LOG_ITERATOR_MESSAGE_FMT("TIterator::operator bool - returning '%hs'", IteratorPtr && IteratorPtr->IsValid() ? "true" : "false")
-			return IteratorPtr && IteratorPtr->IsValid();
+			LOG_ITERATOR_MESSAGE_FMT("TIterator::operator bool - returning '%hs'", IteratorPtr.Get() && IteratorPtr.Get()->IsValid() ? "true" : "false")
+			return IteratorPtr.Get() && IteratorPtr.Get()->IsValid();
 		}
 
 		[[nodiscard]] UE_REWRITE bool operator!=(Utils::EIteratorType) const
 		{
-			LOG_ITERATOR_MESSAGE_FMT("TIterator::operator!= (EIteratorType) - returning '%hs'", IteratorPtr && IteratorPtr->IsValid() ? "true" : "false")
+			LOG_ITERATOR_MESSAGE_FMT("TIterator::operator!= (EIteratorType) - returning '%hs'", IteratorPtr.Get() && IteratorPtr.Get()->IsValid() ? "true" : "false")
 
 			// As long as we are valid, then we have not ended.
 			return static_cast<bool>(*this);
@@ -161,7 +216,7 @@ namespace Faerie::Container
 		[[nodiscard]] UE_REWRITE Utils::EIteratorType end() const { return Utils::End; }
 
 	private:
-		TUniquePtr<IIterator> IteratorPtr;
+		Private::TIteratorStorage<TContainer, std::is_same_v<ResolveType, FFaerieAddress>> IteratorPtr;
 	};
 
 	// Typedef for the rather ungainly parameter for filter predicates.
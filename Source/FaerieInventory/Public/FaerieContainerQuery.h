@@ -5,7 +5,10 @@
 #include "FaerieContainerFilterTypes.h"
 #include "FaerieFunctionTemplates.h"
 #include "FaerieItemContainerStructs.h"
+#include "FaerieItemDataFilterMemo.h"
+#include "FaerieItemDataFilterProgram.h"
 #include "FaerieItemDataViewBase.h"
+#include "OrderStatisticTree.h"
 #include "UObject/Object.h"
 #include "FaerieContainerQuery.generated.h"
 
@@ -17,9 +20,31 @@ class UFaerieContainerQuery;
 using FFaerieViewPredicate = UFaerieFunctionTemplates::FFaerieViewPredicate;
 using FFaerieViewComparator = UFaerieFunctionTemplates::FFaerieViewComparator;
 
+namespace Faerie::Inventory
+{
+	class FEventLogBatch;
+}
+
 namespace Faerie::Container
 {
 	using FQueryEvent = TMulticastDelegate<void(const UFaerieContainerQuery*)>;
+
+	enum class EQueryResultChange : uint8
+	{
+		// The address was added to the results at the index.
+		Added,
+
+		// The address was removed from the results. The index is where it was before removal.
+		Removed,
+
+		// The address was edited, and kept its index.
+		Updated,
+
+		// The results were rebuilt from scratch. The address and index are unused.
+		Reset
+	};
+
+	using FQueryResultEvent = TMulticastDelegate<void(const UFaerieContainerQuery*, EQueryResultChange, FFaerieAddress, int32)>;
 }
 
 /**
@@ -31,7 +56,12 @@ class FAERIEINVENTORY_API UFaerieContainerQuery : public UObject
 	GENERATED_BODY()
 
 public:
+	//~ UObject
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+	//~ UObject
+
 	Faerie::Container::FQueryEvent::RegistrationType& GetQueryChangedEvent() { return OnQueryChanged; }
+	Faerie::Container::FQueryResultEvent::RegistrationType& GetLiveResultEvent() { return OnLiveResultChanged; }
 
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
 	bool IsSortBound() const;
@@ -45,6 +75,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
 	bool GetInvertSort() const { return InvertSort; }
 
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
+	bool GetMemoizeFilter() const { return MemoizeFilter; }
+
 	void SetFilter(Faerie::ItemData::FViewPredicate&& Predicate, const UObject* AssociatedUObject);
 
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
@@ -67,6 +100,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
 	void SetInvertSort(bool Invert);
 
+	/**
+	 * Remember the result of the filter object for each item, until the item is mutated. Only enable this for filters
+	 * whose result depends on nothing but the item stack, as results are not refreshed when anything else changes.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
+	void SetMemoizeFilter(bool Memoize);
+
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
 	void ResetFilter();
 
@@ -86,9 +126,55 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
 	bool IsAddressFiltered(const UFaerieItemContainerBase* Container, const FFaerieAddress Address) const;
 
+	/**
+	 * Bind this query to a container, to keep a live set of its addresses that pass the filter, in sort order.
+	 * Changes to the container are collected from its events extension, and applied by UpdateLiveResults, at a cost of
+	 * O(log n) per changed address. Changing the filter or sort rebuilds the results on the next update.
+	 * Returns false if live updates are unavailable, in which case the results are only built on request.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
+	bool BindToContainer(UFaerieItemContainerBase* Container, bool LiveUpdates = true);
+
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
+	void UnbindFromContainer();
+
+	// Apply pending changes to the live results, broadcasting a result event for each.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
+	void UpdateLiveResults();
+
+	// Rebuild the live results from scratch on the next update.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
+	void RequestLiveRebuild();
+
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
+	int32 GetNumLiveResults() const;
+
+	// Get the index of an address in the live results, or INDEX_NONE if it is not in them.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
+	int32 GetLiveResultIndex(FFaerieAddress Address) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
+	FFaerieAddress GetLiveResultAt(int32 Index) const;
+
+	// Read up to Count addresses from the live results, starting at Start.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Container Query")
+	void GetLiveResultRange(int32 Start, int32 Count, TArray<FFaerieAddress>& OutAddresses) const;
+
 protected:
 	bool CompareAddresses_Impl(TNotNull<const UFaerieItemContainerBase*> Container, const FFaerieAddress AddressA, const FFaerieAddress AddressB) const;
 	bool IsIteratorFiltered(Faerie::Container::FIteratorPtr Iterator) const;
+	void SortAddressesByKey(TNotNull<const UFaerieItemContainerBase*> Container, TArray<FFaerieAddress>& Addresses) const;
+	bool IsFilterThreadSafe() const;
+	void FilterAddressesInParallel(TNotNull<const UFaerieItemContainerBase*> Container, TArray<FFaerieAddress>& OutAddresses) const;
+
+private:
+	void NotifyQueryChanged();
+	bool ExecFilterObject(Faerie::ItemData::FViewPtr View) const;
+	bool ExecFilterObjectStack(const FFaerieItemStackView& View) const;
+	bool PassesFilter(TNotNull<const UFaerieItemContainerBase*> Container, FFaerieAddress Address) const;
+	int32 InsertLiveResult(TNotNull<const UFaerieItemContainerBase*> Container, FFaerieAddress Address);
+	void RebuildLiveResults();
+	void HandlePostEventBatch(TNotNull<const UFaerieItemContainerBase*> Container, const Faerie::Inventory::FEventLogBatch& Events);
 
 private:
 	// Filter object to keep alive.
@@ -106,4 +192,36 @@ private:
 
 	bool InvertFilter = false;
 	bool InvertSort = false;
+
+	// Set when FilterObject is the filter being run.
+	bool FilterByObject = false;
+
+	// FilterObject compiled into a program, when FilterByObject is set, filters are compiled, and FilterObject is part of
+	// an asset. Filters that the program calls into are kept alive by AddReferencedObjects.
+	Faerie::ItemData::FFilterProgram CompiledFilter;
+
+	// Set to memoize the results of FilterObject.
+	bool MemoizeFilter = false;
+
+	mutable Faerie::ItemData::FFilterMemo FilterMemo;
+
+	// Set when SortObject is a comparator that can extract sort keys.
+	bool SortByKey = false;
+
+	// Container that the live results are kept for.
+	UPROPERTY()
+	TWeakObjectPtr<UFaerieItemContainerBase> LiveContainer;
+
+	Faerie::Container::FQueryResultEvent OnLiveResultChanged;
+
+	// Addresses that pass the filter, in sort order.
+	TOrderStatisticTree<FFaerieAddress> LiveResults;
+
+	// Handles into LiveResults for each address in it.
+	TMap<FFaerieAddress, int32> LiveResultHandles;
+
+	// Addresses touched by container events since the last update.
+	TSet<FFaerieAddress> PendingLiveChanges;
+
+	bool LiveRebuildPending = false;
 };
\ No newline at end of file
@@ -0,0 +1,39 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Iris/Serialization/NetSerializer.h"
+#include "FaerieInventoryNetSerializers.generated.h"
+
+/*
+ * Iris serializers for the small inventory types that fill FInventoryContent and FFaerieReplicatedSimMap.
+ * The fast arrays themselves derive from FIrisFastArraySerializer, and use the native Iris fast array fragment, which
+ * keeps calling the PreReplicatedRemove/PostReplicatedAdd/PostReplicatedChange callbacks of their items.
+ * These give the per-item state the same packed encoding as the legacy NetSerialize functions.
+ */
+
+USTRUCT()
+struct FFaerieItemKeyNetSerializerConfig : public FNetSerializerConfig
+{
+	GENERATED_BODY()
+};
+
+USTRUCT()
+struct FKeyedStackNetSerializerConfig : public FNetSerializerConfig
+{
+	GENERATED_BODY()
+};
+
+USTRUCT()
+struct FFaerieAddressNetSerializerConfig : public FNetSerializerConfig
+{
+	GENERATED_BODY()
+};
+
+namespace UE::Net
+{
+	// Used for FEntryKey and FStackKey.
+	UE_NET_DECLARE_SERIALIZER(FFaerieItemKeyNetSerializer, FAERIEINVENTORY_API);
+	UE_NET_DECLARE_SERIALIZER(FKeyedStackNetSerializer, FAERIEINVENTORY_API);
+	UE_NET_DECLARE_SERIALIZER(FFaerieAddressNetSerializer, FAERIEINVENTORY_API);
+}
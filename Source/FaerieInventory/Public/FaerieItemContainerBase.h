@@ -61,6 +61,9 @@ protected:
 	virtual void OnItemMutated(TNotNull<const UFaerieItem*> Item, TNotNull<const UFaerieItemToken*> Token, FGameplayTag EditTag) override;
 	//~ IFaerieItemOwnerInterface
 
+	// Get the net condition group that an item's subobjects replicate in, or NAME_None if they replicate to everyone.
+	virtual FName GetItemNetGroup(const UFaerieItem* Item) const { return NAME_None; }
+
 public:
 	//~ IFaerieContainerExtensionInterface
 	virtual UItemContainerExtensionGroup* GetExtensionGroup() const override final;
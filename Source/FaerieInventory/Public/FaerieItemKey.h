@@ -65,6 +65,9 @@ namespace Faerie::Inventory
 	class TKeyGen
 	{
 	public:
+		// The position of a new or reset generator. The first key made is one past this.
+		static constexpr int32 InitialPosition = 100;
+
 		// Creates the next unique key for an entry.
 		[[nodiscard]] TKey NextKey()
 		{
@@ -79,10 +82,10 @@ namespace Faerie::Inventory
 
 		void Reset()
 		{
-			PreviousKey = 100;
+			PreviousKey = InitialPosition;
 		}
 
 	private:
-		int32 PreviousKey = 100;
+		int32 PreviousKey = InitialPosition;
 	};
 }
\ No newline at end of file
@@ -5,17 +5,23 @@
 #include "FaerieItemContainerBase.h"
 #include "ItemContainerEvent.h"
 #include "FaerieItemStack.h"
+#include "FaerieItemStorageIterators.h"
+#include "FaerieItemStorageLookup.h"
+#include "FaerieStoragePaging.h"
 #include "InventoryDataEnums.h"
 #include "InventoryDataStructs.h"
+#include "ItemStackProxy.h"
 
 #include "FaerieItemStorage.generated.h"
 
 struct FFaerieExtensionAllowsAdditionArgs;
+class APlayerController;
 class UFaerieItemStackProxy;
 
 namespace Faerie::Storage
 {
 	class FStorageDataAccess;
+	class FScopedTransaction;
 }
 
 /**
@@ -32,11 +38,18 @@ class FAERIEINVENTORY_API UFaerieItemStorage : public UFaerieItemContainerBase
 	// Allow iterators and filters to read our data.
 	friend Faerie::Storage::FStorageDataAccess;
 
+	// Allow transactions to defer our notifications.
+	friend Faerie::Storage::FScopedTransaction;
+
+	// Allow pages to hand their entries to us on clients.
+	friend UFaerieStoragePage;
+
 public:
 	//~ UObject
 	virtual void PostInitProperties() override;
 	virtual void PostDuplicate(EDuplicateMode::Type DuplicateMode) override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void GetReplicatedCustomConditionState(FCustomPropertyConditionState& OutActiveState) const override;
 	virtual void PostLoad() override;
 	//~ UObject
 
@@ -63,8 +76,8 @@ public:
 	virtual FFaerieItemStack Release(FFaerieAddress Address, int32 Copies) override;
 
 private:
-	virtual TUniquePtr<Faerie::Container::IIterator> CreateEntryIterator() const override;
-	virtual TUniquePtr<Faerie::Container::IIterator> CreateAddressIterator() const override;
+	virtual TUniquePtr<Faerie::Container::IIterator> CreateEntryIterator() const override final;
+	virtual TUniquePtr<Faerie::Container::IIterator> CreateAddressIterator() const override final;
 	virtual TUniquePtr<Faerie::Container::IIterator> CreateSingleEntryIterator(FEntryKey Key) const override;
 	//~ UFaerieItemContainerBase
 
@@ -77,6 +90,10 @@ protected:
 	virtual void OnItemMutated(TNotNull<const UFaerieItem*> Item, TNotNull<const UFaerieItemToken*> Token, FGameplayTag EditTag) override;
 	//~ IFaerieItemOwnerInterface
 
+	//~ UFaerieItemContainerBase
+	virtual FName GetItemNetGroup(const UFaerieItem* Item) const override;
+	//~ UFaerieItemContainerBase
+
 
 	/**------------------------------*/
 	/*	  INTERNAL IMPLEMENTATIONS	 */
@@ -90,6 +107,11 @@ private:
 
 	[[nodiscard]] UFaerieItemStackProxy* GetStackProxyImpl(FFaerieAddress Address) const;
 
+	[[nodiscard]] UFaerieItemStackProxy* GetLeasedStackProxyImpl(FFaerieAddress Address);
+
+	// Remove entries for proxies that have been garbage collected.
+	void SweepStaleStackProxies();
+
 	// Internal implementation for adding items.
 	[[nodiscard]] Faerie::Inventory::FEventData AddStackImplNoBroadcast(const FFaerieItemStack& InStack, bool ForceNewStack);
 	[[nodiscard]] Faerie::Inventory::FEventData AddStackImpl(const FFaerieItemStack& InStack, bool ForceNewStack);
@@ -101,10 +123,41 @@ private:
 
 	bool CanRemoveEntryImpl(const FInventoryEntry& Entry, FFaerieInventoryTag Reason) const;
 
+	// Rebuild the lookup index from scratch. Must be called whenever EntryMap is replaced without change notifications.
+	void RebuildLookupIndex();
+
 	void PostContentAdded(const FInventoryEntry& Entry);
 	void PreContentRemoved(const FInventoryEntry& Entry);
 	void PostContentChanged(const FInventoryEntry& Entry, FInventoryContent::EChangeType ChangeType, const TBitArray<>* EntryChangeMask);
 
+	// Update any stack proxies for this entry, and discard those for stacks that no longer exist.
+	void NotifyStackProxiesOfChange(const FInventoryEntry& Entry);
+
+	// Post events to extensions, or collect them if a transaction is open.
+	void PostEventImpl(const Faerie::Inventory::FEventData& Event, FFaerieInventoryTag Reason);
+	void PostEventBatchImpl(const Faerie::Inventory::FEventLogBatch& Batch);
+
+	void BeginTransaction();
+	void EndTransaction();
+
+	// Paged replication, server side. Pages mirror EntryMap while a paging actor is set.
+	[[nodiscard]] bool IsServerPaging() const;
+
+	// Paged replication, client side. Is this a copy of a paged storage, which only holds resident pages?
+	[[nodiscard]] bool IsPagingClient() const;
+	UFaerieStoragePage* Server_GetOrCreatePage(int32 Page);
+	void Server_UpdatePagedEntry(const FInventoryEntry& Entry, bool Added);
+	void Server_RemovePagedEntry(const FInventoryEntry& Entry);
+	void Server_RemovePageIfUnused(int32 Page);
+	void Server_RebuildPages();
+	void Server_ClearPages();
+
+	// Paged replication, client side. Applies the entries of a resident page to EntryMap.
+	void Client_ReceivePage(UFaerieStoragePage* Page);
+
+	// Does the index have any entries in this page?
+	[[nodiscard]] bool IsPageIndexed(int32 Page) const;
+
 
 	/**------------------------------*/
 	/*	  STORAGE API - ALL USERS    */
@@ -158,6 +211,29 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Storage|Key")
 	const UFaerieItem* GetEntryItem(FEntryKey Key) const;
 
+	/**
+	 * Get a proxy to an address, that the caller will hand back with ReleaseStackProxy when done with it.
+	 * Once every caller that acquired a proxy has released it, the proxy is recycled for the next request, instead of
+	 * being left for garbage collection. Use this over Proxy for anything that frequently opens and closes, like UI.
+	 * Leased proxies are never the same object that Proxy returns for the address.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Storage|Proxy")
+	FFaerieStackProxyLease AcquireStackProxy(FFaerieAddress Address);
+
+	/**
+	 * Acquire a proxy that is already leased, if it is a leased stack proxy of any storage. Lets holders of a generic item
+	 * proxy keep it from being recycled while they use it. Returns an invalid lease for any other kind of proxy, as those
+	 * are never recycled.
+	 */
+	static FFaerieStackProxyLease AcquireExistingStackProxy(const FFaerieItemProxy& Proxy);
+
+	/**
+	 * Hand back a lease returned by AcquireStackProxy or AcquireExistingStackProxy, and reset it. The caller must not use the proxy afterward.
+	 * Returns false if the lease was stale, i.e., its proxy has already been released and recycled.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Storage|Proxy")
+	bool ReleaseStackProxy(UPARAM(ref) FFaerieStackProxyLease& Lease);
+
 	UFUNCTION(BlueprintCallable, Category = "Storage|Permissions")
 	bool CanAddStack(FFaerieItemStackView Stack, EFaerieStorageAddStackBehavior AddStackBehavior) const;
 
@@ -179,6 +255,46 @@ public:
 		UPARAM(meta = (Categories = "Fae.Inventory.Removal")) FFaerieInventoryTag Reason) const;
 
 
+	/**-----------------------------*/
+	/*	 PAGED REPLICATION API		*/
+	/**-----------------------------*/
+
+	// Does this storage only replicate an index of its entries, and the full entries of pages that clients request?
+	UFUNCTION(BlueprintCallable, Category = "Storage|Paging")
+	bool UsesPagedReplication() const { return PagedReplication; }
+
+	// Get the page that an entry belongs to. Pages are ranges of consecutive keys, so an entry never changes page.
+	UFUNCTION(BlueprintCallable, Category = "Storage|Paging")
+	int32 GetPageOfKey(FEntryKey Key) const;
+
+	// Get the keys and copies of every entry, including those in pages that are not resident on this client.
+	const FFaerieStorageIndex& GetPageIndex() const { return PageIndex; }
+
+	// Retrieve the number of entries in storage, including those in pages that are not resident on this client.
+	UFUNCTION(BlueprintCallable, Category = "Storage|Paging")
+	int32 GetIndexedEntryCount() const;
+
+	// Get the number of pages covered by the index, i.e., one past the page of the last key.
+	UFUNCTION(BlueprintCallable, Category = "Storage|Paging")
+	int32 GetIndexedPageCount() const;
+
+	// Get the pages holding a range of entries, by their position in the index.
+	UFUNCTION(BlueprintCallable, Category = "Storage|Paging")
+	void GetPagesInIndexRange(int32 First, int32 Count, TArray<int32>& OutPages) const;
+
+	// Are the full entries of this page available on this client? Always true for the server, or without paging.
+	UFUNCTION(BlueprintCallable, Category = "Storage|Paging")
+	bool IsPageResident(int32 Page) const;
+
+	// Add or remove a page from the entries on this client. Removing a page removes its entries from this storage until it
+	// is made resident again. Use UFaerieInventoryClient::ViewStoragePages instead of calling this directly, as it also
+	// tells the server which pages to send.
+	void Client_SetPageResident(int32 Page, bool Resident);
+
+	// Start or stop replicating pages to a player. Authority only.
+	void Server_SetPagesRelevant(APlayerController* Player, TConstArrayView<int32> InPages, bool Relevant);
+
+
 	/**---------------------------------*/
 	/*	 STORAGE API - AUTHORITY ONLY   */
 	/**---------------------------------*/
@@ -194,8 +310,15 @@ public:
 	// Add an item stack into storage, and return the full data about the change.
 	void AddItemStack(const FFaerieItemStack& ItemStack, EFaerieStorageAddStackBehavior AddStackBehavior, TValueOrError<Faerie::Inventory::FEventData, FText>& OutResult);
 
+	/**
+	 * Add many item stacks into storage at once. Stacks of the same item are grouped, and the whole batch is tested
+	 * against extensions with a single GroupTest. If the group is refused, stacks are tested and added individually.
+	 */
 	void AddItemStacks(TConstArrayView<FFaerieItemStack> ItemStacks, EFaerieStorageAddStackBehavior AddStackBehavior);
 
+private:
+	void AddItemStacksIndividually(TConstArrayView<FFaerieItemStack> ItemStacks, EFaerieStorageAddStackBehavior AddStackBehavior);
+
 protected:
 	// Add an item stack into storage.
 	UFUNCTION(BlueprintCallable, Category = "Storage")
@@ -270,14 +393,73 @@ public:
 	/*	 VARIABLES	*/
 	/**-------------*/
 private:
-	// Our internal data containing the contents of the storage.
+	// Our internal data containing the contents of the storage. Not replicated when paged.
 	UPROPERTY(Replicated)
 	FInventoryContent EntryMap;
 
+	/**
+	 * Replicate only a lightweight index of entries to clients, and the full entries of pages that each client requests
+	 * through a UFaerieInventoryClient. Meant for very large storages, like banks, that clients only view part of at a
+	 * time. Must be set before the storage begins replicating.
+	 */
+	UPROPERTY(EditAnywhere, Replicated, Category = "Replication")
+	bool PagedReplication = false;
+
+	// Number of consecutive entry keys in each page.
+	UPROPERTY(EditAnywhere, Replicated, Category = "Replication", meta = (ClampMin = 1, EditCondition = "PagedReplication"))
+	int32 PageSize = 64;
+
+	// Index of every entry. Only replicated when paged.
+	UPROPERTY(Replicated)
+	FFaerieStorageIndex PageIndex;
+
+	// Page objects by page number. On the server, only pages with entries, or players viewing them. On clients, only pages
+	// that have been received.
+	UPROPERTY(Transient)
+	TMap<int32, TObjectPtr<UFaerieStoragePage>> Pages;
+
+	// The actor that pages are registered to as subobjects. Only set on the server, while paged.
+	TWeakObjectPtr<AActor> PagingActor;
+
+	// Pages whose entries are in EntryMap on this client.
+	TSet<int32> ResidentPages;
+
 	// Locally stored proxies per entry stack.
 	// These properties are transient, mainly so that editor code that accesses them doesn't need to worry about Caches
 	// being left around. Using weak pointers here is intentional. We don't want this storage to keep these alive. They
 	// should be stored in a strong pointer by whatever requested them, and once nothing needs the proxies, they will die.
 	UPROPERTY(Transient)
 	TMap<FFaerieAddress, TWeakObjectPtr<UFaerieItemStackProxy>> LocalStackProxies;
+
+	// Proxies currently held by leases. These are kept apart from LocalStackProxies, so that nothing but a lease can
+	// reach a proxy that will be recycled. Kept alive by the storage until their last lease is released.
+	UPROPERTY(Transient)
+	TMap<FFaerieAddress, TObjectPtr<UFaerieItemStackProxy>> LeasedStackProxies;
+
+	// Released proxies, waiting to be bound to a new address. These are kept alive by the storage.
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UFaerieItemStackProxy>> StackProxyPool;
+
+	// Size that LocalStackProxies must reach before it is next swept for stale entries.
+	int32 StackProxySweepThreshold = 0;
+
+	// Secondary index from items to the entries that contain them. Accelerates FindEntry, which would otherwise have to
+	// walk the entire EntryMap, calling CompareWith on each item. Kept in sync by the content change notifications.
+	Faerie::Storage::FEntryLookupIndex LookupIndex;
+
+	// State of open Faerie::Storage::FScopedTransactions.
+	struct FTransactionState
+	{
+		uint32 Depth = 0;
+
+		// Events waiting to be posted, grouped by type, in the order that each type first occurred.
+		TArray<TPair<FFaerieInventoryTag, TArray<Faerie::Inventory::FEventData>>> PendingEvents;
+
+		// Entries that were edited, whose stack proxies need to be notified.
+		TSet<FEntryKey> PendingChanges;
+
+		TOptional<FInventoryContent::FDeferredRemovalScope> DeferredRemoval;
+		TOptional<FInventoryContent::FDeferredDirtyScope> DeferredDirty;
+	};
+	FTransactionState Transaction;
 };
\ No newline at end of file
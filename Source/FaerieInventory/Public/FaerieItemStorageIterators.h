@@ -111,6 +111,7 @@ namespace Faerie::Storage
 	public:
 		FIterator_SingleEntry(const FInventoryEntry& Entry);
 		FIterator_SingleEntry(TNotNull<const UFaerieItemStorage*> Storage, const FEntryKey Key);
+		// Index is physical, in [0, FInventoryContent::NumSlots()), and must not be a tombstone.
 		FIterator_SingleEntry(TNotNull<const UFaerieItemStorage*> Storage, const int32 Index);
 
 		FFaerieAddress operator*() const
@@ -208,3 +209,26 @@ namespace Faerie::Storage
 		FIterator_SingleEntry Inner;
 	};
 }
+
+namespace Faerie::Container::Private
+{
+	// When a container is statically known to be a storage, its iterator is held inline, and, being final, is called without
+	// virtual dispatch.
+	template <bool IterateAddresses>
+	class TIteratorStorage<UFaerieItemStorage, IterateAddresses>
+	{
+		using FIteratorType = std::conditional_t<IterateAddresses,
+			Storage::FIterator_AllAddresses_ForInterface,
+			Storage::FIterator_AllEntries_ForInterface>;
+
+	public:
+		UE_REWRITE explicit TIteratorStorage(const TNotNull<const UFaerieItemStorage*> Container)
+		  : Inner(Container) {}
+
+		[[nodiscard]] UE_REWRITE FIteratorType* Get() const { return &Inner; }
+
+	private:
+		// Mutable to match the heap-allocated version, which can be advanced through a const pointer.
+		mutable FIteratorType Inner;
+	};
+}
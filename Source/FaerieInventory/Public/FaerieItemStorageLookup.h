@@ -0,0 +1,62 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemContainerStructs.h"
+
+class UFaerieItem;
+
+namespace Faerie::Storage
+{
+	/**
+	 * Secondary index over the entries of a UFaerieItemStorage, mapping items back to the key of the entry that holds
+	 * them. Items are indexed by raw pointer, and immutable items are additionally bucketed by a content hash, so that
+	 * finding an entry to stack into only has to run CompareWith on items that share a hash.
+	 * This is never serialized or replicated. Owners must keep it in sync with their content, or rebuild it.
+	 */
+	class FAERIEINVENTORY_API FEntryLookupIndex
+	{
+	public:
+		/**
+		 * Calculates the hash used to bucket an item. Only primary identifier tokens contribute to the hash, and the
+		 * result is independent of token order. Two items that pass CompareWith with the Default comparison flags only
+		 * produce the same hash if their primary identifier tokens keep GetTokenHashImpl in agreement with
+		 * CompareWithImpl. The built-in tokens do. A custom token that does not will have equal items fail to stack.
+		 */
+		[[nodiscard]] static uint32 MakeContentHash(TNotNull<const UFaerieItem*> Item);
+
+		// Can this item ever pass CompareWith(Default) against an item other than itself?
+		[[nodiscard]] static bool IsContentIndexable(TNotNull<const UFaerieItem*> Item);
+
+		void Add(FEntryKey Key, TNotNull<const UFaerieItem*> Item);
+		void Remove(FEntryKey Key);
+		void Reset();
+
+		// Re-index an existing key, used when the item it points to may have changed.
+		void Update(FEntryKey Key, TNotNull<const UFaerieItem*> Item);
+
+		[[nodiscard]] FEntryKey FindByPointer(const UFaerieItem* Item) const;
+
+		/**
+		 * Finds the lowest key whose item passes CompareWith(Default) against this item. CompareWith is only called on
+		 * items that share a content hash, so every hit is confirmed, but an item whose tokens hash inconsistently is missed.
+		 */
+		[[nodiscard]] FEntryKey FindEquivalent(TNotNull<const UFaerieItem*> Item) const;
+
+		UE_REWRITE int32 Num() const { return Records.Num(); }
+
+	private:
+		// Gathers all keys whose item shares a content hash with this item. Keys are returned in ascending order.
+		void FindContentCandidates(TNotNull<const UFaerieItem*> Item, TArray<FEntryKey, TInlineAllocator<4>>& OutKeys) const;
+
+		struct FIndexedItem
+		{
+			const UFaerieItem* Item = nullptr;
+			TOptional<uint32> ContentHash;
+		};
+
+		TMap<FEntryKey, FIndexedItem> Records;
+		TMap<const UFaerieItem*, FEntryKey> ByPointer;
+		TMultiMap<uint32, FEntryKey> ByContentHash;
+	};
+}
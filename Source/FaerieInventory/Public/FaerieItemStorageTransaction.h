@@ -0,0 +1,32 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Misc/NotNull.h"
+
+class UFaerieItemStorage;
+
+namespace Faerie::Storage
+{
+	/**
+	 * Groups a series of edits to a storage, such as a take, split, and merge, so that their side effects happen once.
+	 * While any transaction is open on a storage:
+	 * - Extension events are collected instead of posted. When the outermost transaction closes, one FEventLogBatch is
+	 *   posted per event type, in the order that each type first occurred.
+	 * - Stack proxies are notified of edits once per entry when the transaction closes.
+	 * - Entries are marked dirty for replication once per entry when the transaction closes.
+	 * - Removed entries are tombstoned, and compacted out when the transaction closes.
+	 * Extensions do not see any events until the transaction closes, so permission checks made inside a transaction
+	 * see extension state from before it began.
+	 * Transactions may be nested. Only the outermost one has any effect.
+	 */
+	class FAERIEINVENTORY_API FScopedTransaction : FNoncopyable
+	{
+	public:
+		explicit FScopedTransaction(TNotNull<UFaerieItemStorage*> Storage);
+		~FScopedTransaction();
+
+	private:
+		TNotNull<UFaerieItemStorage*> Storage;
+	};
+}
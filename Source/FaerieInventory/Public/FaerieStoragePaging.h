@@ -0,0 +1,114 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "BinarySearchOptimizedArray.h"
+#include "FaerieFastArraySerializer.h"
+#include "FaerieFastArraySerializerHack.h"
+#include "InventoryDataStructs.h"
+#include "NetSupportedObject.h"
+#include "FaerieStoragePaging.generated.h"
+
+class UFaerieItemStorage;
+
+/**
+ * One row of the lightweight index that storages using paged replication send to every client.
+ */
+USTRUCT(BlueprintType)
+struct FFaerieStorageIndexEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	FFaerieStorageIndexEntry() = default;
+
+	FFaerieStorageIndexEntry(const FEntryKey Key, const int32 Copies)
+	  : Key(Key),
+		Copies(Copies) {}
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "StorageIndexEntry")
+	FEntryKey Key;
+
+	// Total copies in all stacks of the entry.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "StorageIndexEntry")
+	int32 Copies = 0;
+};
+
+/**
+ * The keys and copy counts of every entry in a paged storage, in key order.
+ */
+USTRUCT()
+struct FFaerieStorageIndex : public FFaerieFastArraySerializer
+#if CPP
+							 , public TBinarySearchOptimizedArray<FFaerieStorageIndex, FFaerieStorageIndexEntry>
+#endif
+{
+	GENERATED_BODY()
+
+	friend TBinarySearchOptimizedArray;
+
+private:
+	UPROPERTY(VisibleAnywhere, Category = "StorageIndex")
+	TArray<FFaerieStorageIndexEntry> Entries;
+
+	// Enables TBinarySearchOptimizedArray
+	UE_REWRITE TArray<FFaerieStorageIndexEntry>& GetArray() { return Entries; }
+
+public:
+	TConstArrayView<FFaerieStorageIndexEntry> GetView() const { return Entries; }
+	UE_REWRITE int32 Num() const { return Entries.Num(); }
+
+	void SetCopies(FEntryKey Key, int32 Copies);
+	void RemoveKey(FEntryKey Key);
+	void Reset();
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return Faerie::Hacks::FastArrayDeltaSerialize<FFaerieStorageIndexEntry, FFaerieStorageIndex>(Entries, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FFaerieStorageIndex> : public TStructOpsTypeTraitsBase2<FFaerieStorageIndex>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ * The full entries of one page of a storage using paged replication. Pages are replicated as subobjects in their own
+ * net condition group, so each client only receives the pages it has asked for.
+ */
+UCLASS(Within = FaerieItemStorage)
+class UFaerieStoragePage : public UNetSupportedObject
+{
+	GENERATED_BODY()
+
+	friend UFaerieItemStorage;
+
+public:
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	int32 GetPageIndex() const { return PageIndex; }
+	TConstArrayView<FInventoryEntry> GetEntries() const { return Entries; }
+
+	// The net condition group that clients join to receive this page.
+	FName GetNetGroup() const { return NetGroup; }
+
+private:
+	UFUNCTION()
+	void OnRep_Entries();
+
+	// Entries is push based, so the server must call this after every change to it.
+	void MarkEntriesDirty();
+
+	UPROPERTY(Replicated)
+	int32 PageIndex = INDEX_NONE;
+
+	// Entries in this page, in key order.
+	UPROPERTY(ReplicatedUsing = "OnRep_Entries")
+	TArray<FInventoryEntry> Entries;
+
+	FName NetGroup;
+};
@@ -37,8 +37,30 @@ struct FKeyedStack
 	{
 		return Key == Other.Key && Stack == Other.Stack;
 	}
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FKeyedStack> : public TStructOpsTypeTraitsBase2<FKeyedStack>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
 };
 
+namespace Faerie::Inventory::Net
+{
+	// Write or read an int32 zigzag encoded, and packed into as few bytes as its magnitude needs.
+	FAERIEINVENTORY_API void SerializePackedInt(FArchive& Ar, int32& Value);
+
+	// Write or read the stacks of an entry. Each key is sent as the difference from the previous, starting from the
+	// position of a new TKeyGen, so keys made in order take a byte each. Copies are packed. A single stack, which is the
+	// common case, is marked with one bit instead of an array count.
+	FAERIEINVENTORY_API bool SerializeStacks(FArchive& Ar, TArray<FKeyedStack>& Stacks);
+}
+
 struct FInventoryContent;
 class UFaerieItem;
 
@@ -57,6 +79,9 @@ struct FInventoryEntry : public FFastArraySerializerItem
 	FInventoryEntry() = default;
 	FInventoryEntry(FFaerieItemStackView InStack, FEntryKey EntryKey, TArray<FFaerieAddress>& OutNewAddresses);
 
+	// Create an entry where each amount in StackCopies is added as its own new stack(s), as if by AddToNewStacks.
+	FInventoryEntry(const UFaerieItem* Item, FEntryKey EntryKey, TConstArrayView<int32> StackCopies, TArray<FFaerieAddress>& OutNewAddresses);
+
 private:
 	// Unique key to identify this entry.
 	UPROPERTY(VisibleAnywhere, Category = "InventoryEntry")
@@ -75,11 +100,18 @@ private:
 	// Internal count of how many stacks we've made. Used to track key creation. Only valid on the server.
 	Faerie::Inventory::TKeyGen<FStackKey> KeyGen;
 
+	// Set when this entry has been removed during a deferred removal scope, but not yet compacted out of the array.
+	// Only ever true on the server.
+	bool bTombstone = false;
+
 	int32 GetStackIndex(FStackKey InKey) const;
 	const FKeyedStack* GetStackPtr(FStackKey InKey) const;
 
 	void UpdateCachedStackLimit();
 
+	// Split an amount into as many new stacks as the limit requires.
+	void EmplaceNewStacks(int32 Amount, TArray<FFaerieAddress>& OutNewAddresses);
+
 public:
 	UE_REWRITE FEntryKey GetKey() const { return Key; }
 	UE_REWRITE const UFaerieItem* GetItem() const { return ItemObject; }
@@ -106,6 +138,7 @@ public:
 	// Gets a view of the item and stack
 	FFaerieItemStackView ToItemStackView() const;
 
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
 	void PostSerialize(const FArchive& Ar);
 	void PostScriptConstruct();
 
@@ -177,6 +210,7 @@ struct TStructOpsTypeTraits<FInventoryEntry> : public TStructOpsTypeTraitsBase2<
 {
 	enum
 	{
+		WithNetSerializer = true,
 		WithPostSerialize = true,
 		WithPostScriptConstruct = true,
 	};
@@ -187,6 +221,13 @@ class UFaerieItemStorage;
 /**
  * FInventoryContent is a Fast Array, containing all FInventoryEntries for an inventory. Lookup is O(Log(n)), as FEntryKeys
  * are used to keep Entries in numeric order, allowing for binary-search accelerated accessors.
+ * While a FDeferredRemovalScope is open, removed entries are left in place as tombstones, which lookup and iteration
+ * skip. They are compacted out in a single pass once the scope closes and nothing holds the WriteLock, so that removing
+ * many entries does not shift the array once per removal. Tombstones never outlive these scopes, or the WriteLock, so
+ * they are never serialized or replicated.
+ * Counts and indices come in two kinds. Num() counts live entries only, while index-based access (GetElementAt,
+ * GetKeyAt, FindNextLiveIndex) uses physical indices in [0, NumSlots()), which may land on a tombstone. Never pair
+ * Num() with an index.
  */
 USTRUCT()
 struct FInventoryContent : public FFaerieFastArraySerializer
@@ -215,6 +256,34 @@ private:
 	// Is writing to Entries locked? Enabled while ItemHandles are active.
 	mutable uint32 WriteLock = 0;
 
+	// Direct lookup from FEntryKey to index in Entries. Keys are issued sequentially by the owning storage's KeyGen, so
+	// this replaces binary search for most lookups. Never serialized, and rebuilt on demand.
+	mutable FDenseKeyTable KeyTable;
+
+	// Number of tombstoned entries in Entries.
+	int32 NumTombstones = 0;
+
+	// Number of open FDeferredRemovalScopes.
+	uint32 DeferredRemovalDepth = 0;
+
+	// Compact early, once at least this many entries are tombstones...
+	static constexpr int32 MinTombstonesToCompact = 32;
+
+	// ...and they make up at least this fraction of Entries.
+	static constexpr float MaxTombstoneRatio = 0.5f;
+
+	// Compacts if there are tombstones, no scopes are open, and nothing is iterating.
+	void ConditionalCompact();
+
+	// Entries that need to be marked dirty once the last FDeferredDirtyScope closes.
+	TSet<FEntryKey> PendingDirtyKeys;
+
+	// Number of open FDeferredDirtyScopes.
+	uint32 DeferredDirtyDepth = 0;
+
+	// Calls MarkItemDirty, or if a FDeferredDirtyScope is open, defers it until the scope closes.
+	void MarkEntryDirty(FInventoryEntry& Entry);
+
 public:
 	/**
 	 * Adds a new key and entry to the end of the Items array. Performs a quick check that the new key is sequentially
@@ -231,26 +300,97 @@ public:
 	 */
 	void AppendUnsafe(const FInventoryEntry& Entry);
 
+	/**
+	 * Bulk version of AppendUnsafe. All entries are moved in with a single reservation, and the array is sorted once
+	 * afterward, if required. Notifications are sent only once the array is back in order.
+	 */
+	void AppendUnsafe(TArray<FInventoryEntry>&& NewEntries);
+
 	/**
 	 * Performs a binary search to find where to insert this new key. Needed when Key is not guaranteed to be sequential.
 	 * @see Append
 	 */
 	void Insert(const FInventoryEntry& Entry);
 
+	/**
+	 * Removes the entry for this key. If a FDeferredRemovalScope is open, the entry is only tombstoned, and will be
+	 * compacted out later. Notifications are sent immediately either way.
+	 */
 	void Remove(FEntryKey Key);
 
-	UE_REWRITE bool IsEmpty() const { return Entries.IsEmpty(); }
+	/**
+	 * Physically removes all tombstoned entries in a single pass. This is called automatically, and only needs to be
+	 * called manually to reclaim tombstones early. Must not be called while WriteLock is held.
+	 */
+	void Compact();
+
+	/**
+	 * While any of these are alive, removal from the FInventoryContent is deferred. Use when removing many entries in
+	 * one go.
+	 */
+	struct FDeferredRemovalScope : FNoncopyable
+	{
+		explicit FDeferredRemovalScope(FInventoryContent& Content);
+		~FDeferredRemovalScope();
+
+	private:
+		FInventoryContent& Content;
+	};
+
+	/**
+	 * While any of these are alive, entries are not marked dirty for replication when added or edited. Instead, each
+	 * touched entry is marked once, when the last scope closes. Entries added during the scope will not have a
+	 * ReplicationID until then.
+	 */
+	struct FDeferredDirtyScope : FNoncopyable
+	{
+		explicit FDeferredDirtyScope(FInventoryContent& Content);
+		~FDeferredDirtyScope();
+
+	private:
+		FInventoryContent& Content;
+	};
+
+	UE_REWRITE bool IsEmpty() const { return Num() == 0; }
+
+	// The number of live entries. Does not include tombstones. Not a bound for index-based access, see NumSlots.
+	UE_REWRITE int32 Num() const { return Entries.Num() - NumTombstones; }
+
+	// The number of physical slots, including tombstones. Index-based access is valid for [0, NumSlots()).
+	UE_REWRITE int32 NumSlots() const { return Entries.Num(); }
 
-	UE_REWRITE int32 Num() const { return Entries.Num(); }
+	UE_REWRITE bool HasTombstones() const { return NumTombstones > 0; }
+
+	// Finds the first index at or after StartIndex that is not a tombstone, or INDEX_NONE. Use this instead of assuming
+	// that every index below Num() is a live entry.
+	int32 FindNextLiveIndex(int32 StartIndex) const;
 
 	// Low-level access to the WriteLock. Used to prevent added/removing data while iterating.
 	void LockWriteAccess() const;
 	void UnlockWriteAccess() const;
 	UE_REWRITE UFaerieItemStorage* GetOuterItemStorage() const { return ChangeListener; }
 
+	// Enables the dense key table in TBinarySearchOptimizedArray
+	UE_REWRITE FDenseKeyTable& GetDenseKeyTable() const { return KeyTable; }
+
+	// Enables tombstones in TBinarySearchOptimizedArray
+	UE_REWRITE bool IsTombstone(const FInventoryEntry& Entry) const { return Entry.bTombstone; }
+
 	UE_REWRITE bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
 	{
-		return Faerie::Hacks::FastArrayDeltaSerialize<FInventoryEntry, FInventoryContent>(Entries, DeltaParms, *this);
+		const bool Result = Faerie::Hacks::FastArrayDeltaSerialize<FInventoryEntry, FInventoryContent>(Entries, DeltaParms, *this);
+
+		// Replication may have added, removed, or reordered entries.
+		if (DeltaParms.Reader)
+		{
+			KeyTable.Invalidate();
+		}
+		else
+		{
+			ensureMsgf(!HasTombstones(), TEXT("Tombstoned entries were serialized. A FDeferredRemovalScope must have been left open!"));
+		}
+
+		return Result;
 	}
 
 	enum EChangeType
@@ -276,8 +416,38 @@ public:
 	void PostEntryReplicatedChange_Server(const FInventoryEntry& Entry, EChangeType ChangeType, const TBitArray<>& ChangeMask) const;
 	void PostEntryReplicatedChange_Client(const FInventoryEntry& Entry) const;
 
-	// Only const iteration is allowed.
-	using TRangedForConstIterator = TArray<FInventoryEntry>::RangedForConstIteratorType;
+	// Only const iteration is allowed. Tombstones are skipped.
+	struct TRangedForConstIterator
+	{
+		TRangedForConstIterator(const FInventoryEntry* InPtr, const FInventoryEntry* InEnd)
+		  : Ptr(InPtr), End(InEnd)
+		{
+			SkipTombstones();
+		}
+
+		UE_REWRITE const FInventoryEntry& operator*() const { return *Ptr; }
+
+		TRangedForConstIterator& operator++()
+		{
+			++Ptr;
+			SkipTombstones();
+			return *this;
+		}
+
+		[[nodiscard]] UE_REWRITE bool operator!=(const TRangedForConstIterator& Other) const { return Ptr != Other.Ptr; }
+
+	private:
+		void SkipTombstones()
+		{
+			while (Ptr != End && Ptr->bTombstone)
+			{
+				++Ptr;
+			}
+		}
+
+		const FInventoryEntry* Ptr;
+		const FInventoryEntry* End;
+	};
 	TRangedForConstIterator begin() const;
 	TRangedForConstIterator end() const;
 };
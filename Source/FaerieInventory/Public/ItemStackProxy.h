@@ -20,6 +20,28 @@ namespace Faerie::Inventory
 }
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFaerieStackProxyEvent, UFaerieItemStackProxy*, Proxy, FFaerieInventoryTag, Event);
 
+/*
+ * A stack proxy acquired from its storage, that must be handed back to UFaerieItemStorage::ReleaseStackProxy when done.
+ * Proxies are rebound to other addresses when recycled, which invalidates any leases still held on their old binding.
+ * Leased proxies are kept apart from the ones returned by UFaerieItemStorage::Proxy, so the only way to reach one is
+ * through a lease. Holders must not keep Proxy past releasing the lease.
+ */
+USTRUCT(BlueprintType)
+struct FAERIEINVENTORY_API FFaerieStackProxyLease
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "StackProxyLease")
+	TObjectPtr<UFaerieItemStackProxy> Proxy;
+
+	// The binding of Proxy that this lease was made for.
+	uint32 Binding = 0;
+
+	UFaerieItemStorage* GetStorage() const;
+
+	bool IsValid() const;
+};
+
 /*
  * Class for a proxy to an address in a UFaerieItemStorage.
  * Proxies can be created predictively. When this is the case, ItemVersion will equal -1.
@@ -30,6 +52,7 @@ class UFaerieItemStackProxy : public UObject, public IFaerieItemDataProxy
 	GENERATED_BODY()
 
 	friend UFaerieItemStorage;
+	friend FFaerieStackProxyLease;
 
 public:
 	//~ IFaerieItemDataProxy
@@ -60,6 +83,9 @@ protected:
 	void NotifyUpdate();
 	void NotifyRemoval();
 
+	// Clear all bindings and state, so this proxy can be pooled by its storage and bound to another address.
+	void Unbind();
+
 	bool VerifyStatus() const;
 
 	// Broadcast when this proxy is first initialized, or receives an update.
@@ -87,4 +113,14 @@ protected:
 
 private:
 	Faerie::Inventory::FStackProxyEvent OnProxyEvent;
+
+	// Number of times this proxy has been acquired from its storage, and not yet released.
+	int32 AcquireCount = 0;
+
+	// Incremented each time this proxy is unbound. Leases made for an earlier binding are stale.
+	uint32 Binding = 0;
+
+	// Set for proxies that are only handed out through leases. Only these are pooled. Proxies returned by
+	// UFaerieItemStorage::Proxy are never recycled, as there is no way to tell when their holders are done with them.
+	bool Leased = false;
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "BasicItemDataComparators.h"
+#include "FaerieItem.h"
+#include "Tokens/FaerieInfoToken.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(BasicItemDataComparators)
+
+using namespace Faerie;
+
+bool UComparatorRule_Name::Exec(const ItemData::FViewPtr ViewA, const ItemData::FViewPtr ViewB) const
+{
+	return ExtractSortKey(ViewA) < ExtractSortKey(ViewB);
+}
+
+ItemData::FSortKey UComparatorRule_Name::ExtractSortKey(const ItemData::FViewPtr View) const
+{
+	ItemData::FSortKey Key;
+	if (const UFaerieItem* Item = View->ResolveItem();
+		IsValid(Item))
+	{
+		if (const UFaerieInfoToken* Info = Item->GetToken<UFaerieInfoToken>())
+		{
+			Key.String = Info->GetItemName().ToString();
+		}
+	}
+	return Key;
+}
+
+bool UComparatorRule_LastModified::Exec(const ItemData::FViewPtr ViewA, const ItemData::FViewPtr ViewB) const
+{
+	return ExtractSortKey(ViewA) < ExtractSortKey(ViewB);
+}
+
+ItemData::FSortKey UComparatorRule_LastModified::ExtractSortKey(const ItemData::FViewPtr View) const
+{
+	ItemData::FSortKey Key;
+	if (const UFaerieItem* Item = View->ResolveItem();
+		IsValid(Item))
+	{
+		Key.Integer = Item->GetLastModified().GetTicks();
+	}
+	return Key;
+}
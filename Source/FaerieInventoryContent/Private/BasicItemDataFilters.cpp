@@ -1,7 +1,9 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "BasicItemDataFilters.h"
+#include "Algo/AllOf.h"
 #include "FaerieItem.h"
+#include "FaerieItemDataFilterProgram.h"
 #include "Tokens/FaerieStackLimiterToken.h"
 #include "Tokens/FaerieStaticReferenceToken.h"
 #include "Tokens/FaerieTagToken.h"
@@ -12,6 +14,11 @@
 
 using namespace Faerie;
 
+void UFilterRule_Literal::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitLiteral(true);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_LogicalOr::GetMutabilityStatus() const
 {
@@ -58,6 +65,16 @@ bool UFilterRule_LogicalOr::Exec(const FFaerieItemStackView View) const
 	return false;
 }
 
+bool UFilterRule_LogicalOr::IsThreadSafe() const
+{
+	return Algo::AllOf(Rules, [](const TObjectPtr<UFaerieItemDataFilter>& Rule) { return IsValid(Rule) && Rule->IsThreadSafe(); });
+}
+
+void UFilterRule_LogicalOr::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitOr(Rules);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_LogicalAnd::GetMutabilityStatus() const
 {
@@ -105,6 +122,16 @@ bool UFilterRule_LogicalAnd::Exec(const FFaerieItemStackView View) const
 	return true;
 }
 
+bool UFilterRule_LogicalAnd::IsThreadSafe() const
+{
+	return Algo::AllOf(Rules, [](const TObjectPtr<UFaerieItemDataFilter>& Rule) { return IsValid(Rule) && Rule->IsThreadSafe(); });
+}
+
+void UFilterRule_LogicalAnd::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitAnd(Rules);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_Condition::GetMutabilityStatus() const
 {
@@ -124,6 +151,17 @@ bool UFilterRule_Condition::Exec(const FFaerieItemStackView View) const
 	return FalseBranch;
 }
 
+bool UFilterRule_Condition::IsThreadSafe() const
+{
+	return (!ConditionRule || ConditionRule->IsThreadSafe()) &&
+		   (!TrueBranch || TrueBranch->IsThreadSafe());
+}
+
+void UFilterRule_Condition::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitSelect(ConditionRule, TrueBranch, FalseBranch);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_Ternary::GetMutabilityStatus() const
 {
@@ -144,6 +182,18 @@ bool UFilterRule_Ternary::Exec(const FFaerieItemStackView View) const
 	return FalseBranch->Exec(View);
 }
 
+bool UFilterRule_Ternary::IsThreadSafe() const
+{
+	return (!ConditionRule || ConditionRule->IsThreadSafe()) &&
+		   (!TrueBranch || TrueBranch->IsThreadSafe()) &&
+		   (!FalseBranch || FalseBranch->IsThreadSafe());
+}
+
+void UFilterRule_Ternary::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitSelect(ConditionRule, TrueBranch, FalseBranch);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_LogicalNot::GetMutabilityStatus() const
 {
@@ -160,6 +210,16 @@ bool UFilterRule_LogicalNot::Exec(const FFaerieItemStackView View) const
 	return !InvertedRule->Exec(View);
 }
 
+bool UFilterRule_LogicalNot::IsThreadSafe() const
+{
+	return IsValid(InvertedRule) && InvertedRule->IsThreadSafe();
+}
+
+void UFilterRule_LogicalNot::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitNot(InvertedRule);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_Mutability::GetMutabilityStatus() const
 {
@@ -172,6 +232,11 @@ bool UFilterRule_Mutability::Exec(const FFaerieItemStackView View) const
 	return View.Item->CanMutate() == RequireMutable;
 }
 
+void UFilterRule_Mutability::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitMutability(RequireMutable);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_MatchTemplate::GetMutabilityStatus() const
 {
@@ -202,6 +267,29 @@ bool UFilterRule_MatchTemplate::Exec(const FFaerieItemStackView View) const
 	return false;
 }
 
+bool UFilterRule_MatchTemplate::IsThreadSafe() const
+{
+	if (IsValid(Template))
+	{
+		const UFaerieItemDataFilter* Pattern = Template->GetPattern();
+		return IsValid(Pattern) && Pattern->IsThreadSafe();
+	}
+	return true;
+}
+
+void UFilterRule_MatchTemplate::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	// Inline the template's pattern.
+	if (IsValid(Template))
+	{
+		Compiler.EmitFilter(Template->GetPattern());
+	}
+	else
+	{
+		Compiler.EmitLiteral(false);
+	}
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_HasTokens::GetMutabilityStatus() const
 {
@@ -269,37 +357,25 @@ bool UFilterRule_HasTokens::ExecWithLog(const FFaerieItemStackView View, ItemDat
 
 bool UFilterRule_HasTokens::Exec(const FFaerieItemStackView View) const
 {
-	TArray<TSubclassOf<UFaerieItemToken>> TokenClassesCopy = TokenClasses;
-
 	const UFaerieItem* Item = View.Item.Get();
 	if (!IsValid(Item))
 	{
 		return false;
 	}
 
-	for (auto&& Tokens = Item->GetOwnedTokens();
-		const TObjectPtr<UFaerieItemToken>& Token : Tokens)
+	// Tokens of an invalid class can never be found.
+	if (!Algo::AllOf(TokenClasses, [](const TSubclassOf<UFaerieItemToken>& Class) { return IsValid(Class); }))
 	{
-		if (!IsValid(Token)) continue;
-
-		TokenClassesCopy.RemoveAllSwap([Token](const TSubclassOf<UFaerieItemToken>& TokenClass)
-			{
-				return Token->IsA(TokenClass);
-			});
+		return false;
 	}
 
-	if (IncludeDefaultReferences)
-	{
-		for (auto It = TokenClassesCopy.CreateIterator(); It; ++It)
-		{
-			if (Token::GetReferencedToken(*Item, *It, Token::Tags::TokenReferenceDefaults))
-			{
-				It.RemoveCurrent();
-			}
-		}
-	}
+	return Item->HasTokens(Token::FClassMask::ForClasses(TokenClasses),
+		IncludeDefaultReferences ? Token::Tags::TokenReferenceDefaults : FGameplayTag());
+}
 
-	return TokenClassesCopy.IsEmpty();
+void UFilterRule_HasTokens::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitHasTokens(TokenClasses, IncludeDefaultReferences);
 }
 
 #if WITH_EDITOR
@@ -336,6 +412,13 @@ bool UFilterRule_Copies::Exec(const FFaerieItemStackView View) const
 	}
 }
 
+void UFilterRule_Copies::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	// ECopiesCompareOperator is declared in the same order as EFilterCompare.
+	static_assert(static_cast<uint8>(ECopiesCompareOperator::NotEqual) == static_cast<uint8>(ItemData::EFilterCompare::NotEqual));
+	Compiler.EmitCompareCopies(static_cast<ItemData::EFilterCompare>(Operator), AmountToCompare);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_StackLimit::GetMutabilityStatus() const
 {
@@ -358,39 +441,57 @@ EItemDataMutabilityStatus UFilterRule_StackLimit::GetMutabilityStatus() const
 }
 #endif
 
-bool UFilterRule_StackLimit::Exec(const FFaerieItemStackView View) const
+namespace Faerie::Filters
 {
-	if (const int32 Limit = UFaerieStackLimiterToken::GetItemStackLimit(View.Item.Get());
-		Limit == ItemData::UnlimitedStack)
+	static bool CompareStackLimit(const FFaerieItemStackView& View, const EStackCompareOperator Operator, const int32 AmountToCompare)
 	{
-		switch (Operator)
+		if (const int32 Limit = UFaerieStackLimiterToken::GetItemStackLimit(View.Item.Get());
+			Limit == ItemData::UnlimitedStack)
 		{
-		case EStackCompareOperator::Less:			return false;
-		case EStackCompareOperator::LessOrEqual:	return false;
-		case EStackCompareOperator::Greater:		return true;
-		case EStackCompareOperator::GreaterOrEqual:	return true;
-		case EStackCompareOperator::Equal:			return false;
-		case EStackCompareOperator::NotEqual:		return true;
-		case EStackCompareOperator::HasLimit:		return false;
-		case EStackCompareOperator::HasNoLimit:		return true;
-		default: return false;
+			switch (Operator)
+			{
+			case EStackCompareOperator::Less:			return false;
+			case EStackCompareOperator::LessOrEqual:	return false;
+			case EStackCompareOperator::Greater:		return true;
+			case EStackCompareOperator::GreaterOrEqual:	return true;
+			case EStackCompareOperator::Equal:			return false;
+			case EStackCompareOperator::NotEqual:		return true;
+			case EStackCompareOperator::HasLimit:		return false;
+			case EStackCompareOperator::HasNoLimit:		return true;
+			default: return false;
+			}
 		}
-	}
-	else
-	{
-		switch (Operator)
+		else
 		{
-		case EStackCompareOperator::Less:			return Limit < AmountToCompare;
-		case EStackCompareOperator::LessOrEqual:	return Limit <= AmountToCompare;
-		case EStackCompareOperator::Greater:		return Limit > AmountToCompare;
-		case EStackCompareOperator::GreaterOrEqual:	return Limit >= AmountToCompare;
-		case EStackCompareOperator::Equal:			return Limit == AmountToCompare;
-		case EStackCompareOperator::NotEqual:		return Limit != AmountToCompare;
-		case EStackCompareOperator::HasLimit:		return true;
-		case EStackCompareOperator::HasNoLimit:		return false;
-		default: return false;
+			switch (Operator)
+			{
+			case EStackCompareOperator::Less:			return Limit < AmountToCompare;
+			case EStackCompareOperator::LessOrEqual:	return Limit <= AmountToCompare;
+			case EStackCompareOperator::Greater:		return Limit > AmountToCompare;
+			case EStackCompareOperator::GreaterOrEqual:	return Limit >= AmountToCompare;
+			case EStackCompareOperator::Equal:			return Limit == AmountToCompare;
+			case EStackCompareOperator::NotEqual:		return Limit != AmountToCompare;
+			case EStackCompareOperator::HasLimit:		return true;
+			case EStackCompareOperator::HasNoLimit:		return false;
+			default: return false;
+			}
 		}
 	}
+
+	static bool CompareStackLimitNative(const FFaerieItemStackView& View, const uint8 Operator, const int32 AmountToCompare)
+	{
+		return CompareStackLimit(View, static_cast<EStackCompareOperator>(Operator), AmountToCompare);
+	}
+}
+
+bool UFilterRule_StackLimit::Exec(const FFaerieItemStackView View) const
+{
+	return Filters::CompareStackLimit(View, Operator, AmountToCompare);
+}
+
+void UFilterRule_StackLimit::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitNative(&Filters::CompareStackLimitNative, static_cast<uint8>(Operator), AmountToCompare);
 }
 
 bool UFilterRule_GameplayTagAny::Exec(const FFaerieItemStackView View) const
@@ -402,6 +503,11 @@ bool UFilterRule_GameplayTagAny::Exec(const FFaerieItemStackView View) const
 	return false;
 }
 
+void UFilterRule_GameplayTagAny::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitTagsAny(Tags);
+}
+
 bool UFilterRule_GameplayTagAll::Exec(const FFaerieItemStackView View) const
 {
 	if (const UFaerieTagToken* TagToken = View.Item->GetToken<UFaerieTagToken>())
@@ -411,4 +517,9 @@ bool UFilterRule_GameplayTagAll::Exec(const FFaerieItemStackView View) const
 	return false;
 }
 
+void UFilterRule_GameplayTagAll::Compile(ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitTagsAll(Tags);
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
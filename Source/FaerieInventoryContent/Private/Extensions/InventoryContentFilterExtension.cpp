@@ -13,7 +13,11 @@ EEventExtensionResponse UInventoryContentFilterExtension::AllowsAddition(const T
 	{
 		for (auto&& View : Views)
 		{
-			if (!Filter->Exec(View))
+			const bool Passed = MemoizeFilter ?
+				FilterMemo.Exec(Filter, View, [this, &View] { return Filter->Exec(View); }) :
+				Filter->Exec(View);
+
+			if (!Passed)
 			{
 				return EEventExtensionResponse::Disallowed;
 			}
@@ -1,10 +1,48 @@
 // Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "UI/FaerieItemStackWidgetBase.h"
+#include "FaerieItemStorage.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieItemStackWidgetBase)
 
 void UFaerieItemStackWidgetBase::SetInventoryWidget(UFaerieStorageWidgetBase* Widget)
 {
 	InventoryWidget = Widget;
+}
+
+void UFaerieItemStackWidgetBase::SetStack(UFaerieItemStorage* Storage, const FFaerieAddress Address)
+{
+	ReleaseStack();
+
+	if (IsValid(Storage))
+	{
+		StackLease = Storage->AcquireStackProxy(Address);
+		LocalCache = StackLease.Proxy;
+	}
+}
+
+void UFaerieItemStackWidgetBase::ReleaseStack()
+{
+	if (LocalCache == StackLease.Proxy)
+	{
+		LocalCache = nullptr;
+	}
+
+	if (UFaerieItemStorage* Storage = StackLease.GetStorage())
+	{
+		Storage->ReleaseStackProxy(StackLease);
+	}
+	StackLease = FFaerieStackProxyLease();
+}
+
+void UFaerieItemStackWidgetBase::NativeDestruct()
+{
+	ReleaseStack();
+	Super::NativeDestruct();
+}
+
+void UFaerieItemStackWidgetBase::NativeOnEntryReleased()
+{
+	ReleaseStack();
+	IUserListEntry::NativeOnEntryReleased();
 }
\ No newline at end of file
@@ -7,7 +7,6 @@
 
 #include "FaerieInventoryContentLog.h"
 #include "FaerieContainerQuery.h"
-#include "Extensions/ItemContainerExtensionEvents.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieStorageWidgetBase)
 
@@ -24,8 +23,8 @@ UFaerieStorageWidgetBase::UFaerieStorageWidgetBase(const FObjectInitializer& Obj
 
 bool UFaerieStorageWidgetBase::Initialize()
 {
-	// Request Resort after any change to our Query Object.
-	StorageQuery->GetQueryChangedEvent().AddWeakLambda(this, [this](auto){ RequestQuery(); });
+	// Mirror changes to the query's live results.
+	StorageQuery->GetLiveResultEvent().AddUObject(this, &ThisClass::HandleLiveResultChanged);
 
 	return Super::Initialize();
 }
@@ -51,12 +50,7 @@ void UFaerieStorageWidgetBase::NativeTick(const FGeometry& MyGeometry, const flo
 {
 	Super::NativeTick(MyGeometry, InDeltaTime);
 
-	if (NeedsNewQuery)
-	{
-		StorageQuery->QueryAllAddresses(ItemStorage.Get(), SortedAndFilteredAddresses);
-		NeedsReDisplay = true;
-		NeedsNewQuery = false;
-	}
+	StorageQuery->UpdateLiveResults();
 
 	if (NeedsReDisplay)
 	{
@@ -67,89 +61,48 @@ void UFaerieStorageWidgetBase::NativeTick(const FGeometry& MyGeometry, const flo
 
 void UFaerieStorageWidgetBase::Reset()
 {
-	SortedAndFilteredAddresses.Empty();
 	if (IsValid(StorageQuery))
 	{
+		StorageQuery->UnbindFromContainer();
 		StorageQuery->SetInvertSort(false);
 		StorageQuery->SetInvertFilter(false);
 	}
-
-	if (ItemStorage.IsValid())
-	{
-		if (auto EventsExtension = Extensions::Get<UItemContainerExtensionEvents>(ItemStorage.Get(), false))
-		{
-			EventsExtension->GetOnPostEventBatch().RemoveAll(this);
-		}
-	}
+	SortedAndFilteredAddresses.Empty();
 
 	OnReset();
 
 	ItemStorage = nullptr;
 }
 
-void UFaerieStorageWidgetBase::OnPostEventBatch(const TNotNull<const UFaerieItemContainerBase*> Container,
-	const Inventory::FEventLogBatch& Events)
+void UFaerieStorageWidgetBase::HandleLiveResultChanged(const UFaerieContainerQuery* Query,
+	const Container::EQueryResultChange Change, const FFaerieAddress Address, const int32 Index)
 {
-	if (Container != ItemStorage) return;
-
-	// If we are going to perform a full query next frame anyway, then this is pointless.
-	if (NeedsNewQuery)
-	{
-		return;
-	}
-
-	// @todo do we need a way to customize this value
-	if (Events.Data.Num() > 1)
+	switch (Change)
 	{
-		RequestQuery();
-		return;
-	}
-
-	if (Events.IsAdditionEvent())
-	{
-		for (auto&& Event : Events.Data)
-        {
-            for (auto&& Address : Event.AddressesTouched)
-            {
-            	const int32 Index = AddToSortOrder(Address, true);
-            	if (Index != INDEX_NONE)
-            	{
-            		OnAddressAdded(Address, Index);
-            	}
-            }
-        }
-	}
-	else if (Events.IsRemovalEvent())
-	{
-		for (auto&& Event : Events.Data)
+	case Container::EQueryResultChange::Added:
+		SortedAndFilteredAddresses.Insert(Address, Index);
+		if (!NeedsReDisplay)
 		{
-			for (auto&& Address : Event.AddressesTouched)
-            {
-            	const int32 Index = SortedAndFilteredAddresses.Find(Address);
-            	SortedAndFilteredAddresses.RemoveAt(Index);
-            	OnAddressRemoved(Address, Index);
-            }
+			OnAddressAdded(Address, Index);
 		}
-	}
-	else
-	{
-		check(Events.IsEditEvent())
-
-		for (auto&& Event : Events.Data)
+		break;
+	case Container::EQueryResultChange::Removed:
+		SortedAndFilteredAddresses.RemoveAt(Index);
+		if (!NeedsReDisplay)
+		{
+			OnAddressRemoved(Address, Index);
+		}
+		break;
+	case Container::EQueryResultChange::Updated:
+		if (!NeedsReDisplay)
 		{
-			for (auto&& Address : Event.AddressesTouched)
-            {
-            	const int32 Index = AddToSortOrder(Address, false);
-            	if (Index != INDEX_NONE)
-            	{
-            		OnAddressAdded(Address, Index);
-            	}
-            	else
-            	{
-            		OnAddressUpdated(Address, INDEX_NONE);
-            	}
-            }
+			OnAddressUpdated(Address, Index);
 		}
+		break;
+	case Container::EQueryResultChange::Reset:
+		Query->GetLiveResultRange(0, Query->GetNumLiveResults(), SortedAndFilteredAddresses);
+		NeedsReDisplay = true;
+		break;
 	}
 }
 
@@ -174,27 +127,15 @@ void UFaerieStorageWidgetBase::InitWithInventory(UFaerieItemStorage* Storage)
 	{
 		ItemStorage = Storage;
 
-		if (EnableUpdateEvents)
+		// Binding the query loads in entries that should be initially displayed on the next tick.
+		if (!StorageQuery->BindToContainer(Storage, EnableUpdateEvents) && EnableUpdateEvents)
 		{
-			auto EventsExtension = Extensions::Get<UItemContainerExtensionEvents>(Storage, false);
-			if (!IsValid(EventsExtension))
-			{
-				UE_LOG(LogFaerieInventoryContent, Error,
-					TEXT("Storage Widget failed to find Events Extension. Dynamic updates disabled! Please add a Extension Events object to '%s' or disable EnableUpdateEvents"),
-					*Storage->GetPathName())
-			}
-			else
-			{
-				EventsExtension->GetOnPostEventBatch().AddUObject(this, &ThisClass::OnPostEventBatch);
-			}
+			UE_LOG(LogFaerieInventoryContent, Error,
+				TEXT("Storage Widget failed to find Events Extension. Dynamic updates disabled! Please add a Extension Events object to '%s' or disable EnableUpdateEvents"),
+				*Storage->GetPathName())
 		}
 
-		//ItemStorage->GetOnAddressEvent().AddUObject(this, &ThisClass::HandleAddressEvent);
-
 		OnInitWithInventory();
-
-		// Load in entries that should be initially displayed
-		NeedsNewQuery = true;
 	}
 }
 
@@ -255,7 +196,7 @@ int32 UFaerieStorageWidgetBase::AddToSortOrder(const FFaerieAddress Address, con
 
 void UFaerieStorageWidgetBase::RequestQuery()
 {
-	NeedsNewQuery = true;
+	StorageQuery->RequestLiveRebuild();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,35 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemDataComparator.h"
+
+#include "BasicItemDataComparators.generated.h"
+
+/**
+ * Sorts items by the name in their info token. Items without one sort first.
+ */
+UCLASS(meta = (DisplayName = "Name"))
+class UComparatorRule_Name : public UFaerieItemDataComparator
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool Exec(Faerie::ItemData::FViewPtr ViewA, Faerie::ItemData::FViewPtr ViewB) const override;
+	virtual bool HasSortKey() const override { return true; }
+	virtual Faerie::ItemData::FSortKey ExtractSortKey(Faerie::ItemData::FViewPtr View) const override;
+};
+
+/**
+ * Sorts items by when they were last modified, oldest first.
+ */
+UCLASS(meta = (DisplayName = "Last Modified"))
+class UComparatorRule_LastModified : public UFaerieItemDataComparator
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool Exec(Faerie::ItemData::FViewPtr ViewA, Faerie::ItemData::FViewPtr ViewB) const override;
+	virtual bool HasSortKey() const override { return true; }
+	virtual Faerie::ItemData::FSortKey ExtractSortKey(Faerie::ItemData::FViewPtr View) const override;
+};
@@ -18,6 +18,8 @@ class UFilterRule_Literal : public UFaerieItemDataFilter
 
 public:
 	virtual bool Exec(FFaerieItemStackView View) const override { return true; }
+	virtual bool IsThreadSafe() const override { return true; }
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 };
 
 /**
@@ -35,6 +37,8 @@ public:
 
 	virtual bool ExecWithLog(FFaerieItemStackView View, Faerie::ItemData::FFilterLogger& Logger) const override;
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override;
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Instanced, Category = "LogicalOr")
@@ -56,6 +60,8 @@ public:
 
 	virtual bool ExecWithLog(FFaerieItemStackView View, Faerie::ItemData::FFilterLogger& Logger) const override;
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override;
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Instanced, Category = "LogicalAnd")
@@ -76,6 +82,8 @@ public:
 #endif
 
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override;
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Instanced, Category = "Condition")
@@ -103,6 +111,8 @@ public:
 #endif
 
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override;
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Instanced, Category = "Ternary")
@@ -129,6 +139,8 @@ public:
 #endif
 
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override;
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Instanced, Category = "LogicalNot")
@@ -149,6 +161,8 @@ public:
 #endif
 
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override { return true; }
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	// Enable to require a mutable entry. Leave disabled to only allow immutable entries.
@@ -171,6 +185,8 @@ public:
 
 	virtual bool ExecWithLog(const FFaerieItemStackView View, Faerie::ItemData::FFilterLogger& Logger) const override;
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override;
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "MatchTemplate", meta = (AllowAbstract))
@@ -195,6 +211,8 @@ public:
 
 	virtual bool ExecWithLog(const FFaerieItemStackView View, Faerie::ItemData::FFilterLogger& Logger) const override;
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override { return true; }
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "HasTokens", meta = (AllowAbstract = "true"))
@@ -230,6 +248,8 @@ public:
 #endif
 
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override { return true; }
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "CompareCopies")
@@ -267,6 +287,8 @@ public:
 #endif
 
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override { return true; }
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "CompareLimit")
@@ -291,6 +313,8 @@ public:
 #endif
 
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override { return true; }
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GameplayTagAny")
@@ -311,6 +335,8 @@ public:
 #endif
 
 	virtual bool Exec(FFaerieItemStackView View) const override;
+	virtual bool IsThreadSafe() const override { return true; }
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GameplayTagAll")
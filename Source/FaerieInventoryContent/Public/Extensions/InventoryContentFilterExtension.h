@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "FaerieItemDataFilterMemo.h"
 #include "ItemContainerExtensionBase.h"
 
 #include "InventoryContentFilterExtension.generated.h"
@@ -25,4 +26,12 @@ protected:
 	// Filter used to determine if an item can be contained in the inventory
 	UPROPERTY(EditAnywhere, Category = "Config", meta = (DisplayThumbnail = false))
 	TObjectPtr<UFaerieItemDataFilter> Filter;
+
+	// Remember the result of the filter for each item, until the item is mutated. Only enable this if the filter's
+	// result depends on nothing but the item stack.
+	UPROPERTY(EditAnywhere, Category = "Config")
+	bool MemoizeFilter = false;
+
+private:
+	mutable Faerie::ItemData::FFilterMemo FilterMemo;
 };
\ No newline at end of file
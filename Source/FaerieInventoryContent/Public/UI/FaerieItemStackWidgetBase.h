@@ -4,10 +4,12 @@
 
 #include "Blueprint/IUserObjectListEntry.h"
 #include "Blueprint/UserWidget.h"
+#include "FaerieItemContainerStructs.h"
+#include "ItemStackProxy.h"
 #include "FaerieItemStackWidgetBase.generated.h"
 
 class UFaerieStorageWidgetBase;
-class UFaerieItemStackProxy;
+class UFaerieItemStorage;
 
 /**
  * Responsible for displaying a single inventory entry in an entry list widget.
@@ -21,10 +23,34 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|ItemStackWidget")
 	void SetInventoryWidget(UFaerieStorageWidgetBase* Widget);
 
+	/**
+	 * Acquire a proxy for the stack to display into LocalCache, releasing any previous one. The proxy is released when
+	 * this widget is destructed or released by its list, so it can be recycled for the next entry.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Faerie|ItemStackWidget")
+	void SetStack(UFaerieItemStorage* Storage, FFaerieAddress Address);
+
+	// Release the proxy in LocalCache, if it was acquired by SetStack.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|ItemStackWidget")
+	void ReleaseStack();
+
 protected:
+	//~ UUserWidget
+	virtual void NativeDestruct() override;
+	//~ UUserWidget
+
+	//~ IUserListEntry
+	virtual void NativeOnEntryReleased() override;
+	//~ IUserListEntry
+
 	UPROPERTY(BlueprintReadOnly, Category = "ItemStackWidget")
 	TObjectPtr<UFaerieStorageWidgetBase> InventoryWidget;
 
 	UPROPERTY(BlueprintReadWrite, Category = "ItemStackWidget")
 	TObjectPtr<UFaerieItemStackProxy> LocalCache;
+
+private:
+	// Lease on LocalCache, when it was acquired by SetStack.
+	UPROPERTY()
+	FFaerieStackProxyLease StackLease;
 };
\ No newline at end of file
@@ -9,6 +9,11 @@
 class UFaerieContainerQuery;
 class UInventoryUIActionContainer;
 
+namespace Faerie::Container
+{
+	enum class EQueryResultChange : uint8;
+}
+
 /**
  *
  */
@@ -28,7 +33,7 @@ public:
 protected:
 	virtual void Reset();
 
-	void OnPostEventBatch(TNotNull<const UFaerieItemContainerBase*> Container, const Faerie::Inventory::FEventLogBatch& Events);
+	void HandleLiveResultChanged(const UFaerieContainerQuery* Query, Faerie::Container::EQueryResultChange Change, FFaerieAddress Address, int32 Index);
 
 public:
 	// Set the inventory that will be used when this widget is constructed.
@@ -49,7 +54,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|StorageWidget")
 	int32 AddToSortOrder(FFaerieAddress Address, bool WarnIfAlreadyExists);
 
-	// Flag this widget to re-query its content next frame.
+	// Flag this widget to re-query its content next frame. This is only needed if the storage is not sending update events.
 	UFUNCTION(BlueprintCallable, Category = "Faerie|StorageWidget")
 	void RequestQuery();
 
@@ -97,6 +102,5 @@ protected:
 	TWeakObjectPtr<UFaerieItemStorage> ItemStorage;
 
 private:
-	bool NeedsNewQuery = false;
 	bool NeedsReDisplay = false;
 };
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "FaerieItem.h"
 #include "Squirrel.h"
 #include "Tokens/FaerieInfoToken.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeRWLock.h"
 #include "UObject/TextProperty.h"
 #include "UObject/PropertyOptional.h"
 
@@ -13,6 +15,12 @@
 
 namespace Faerie::Hash
 {
+	static bool UseHashPlans = true;
+	static FAutoConsoleVariableRef CVarUseHashPlans(
+		TEXT("fae.Hash.UsePlans"),
+		UseHashPlans,
+		TEXT("Hash native structs and classes by property using cached hashing plans, instead of walking their properties on every call."));
+
 	[[nodiscard]] uint32 Combine(const uint32 A, const uint32 B)
 	{
 		return Squirrel::HashCombine(A, B);
@@ -147,16 +155,273 @@ namespace Faerie::Hash
 		return Hash;
 	}
 
+	namespace Private
+	{
+		enum class EHashOpKind : uint8
+		{
+			// Scalars, which may be hashed in runs.
+			Bool,
+			Byte,
+			Int32,
+			Int64,
+			Float,
+			Double,
+
+			Name,
+			String,
+			Text,
+
+			// A native struct, hashed by its own plan.
+			Struct,
+
+			// Anything else is handed to HashFProperty.
+			Generic
+		};
+
+		struct FHashPlan;
+
+		struct FHashOp
+		{
+			EHashOpKind Kind = EHashOpKind::Generic;
+
+			// For scalars, the number of properties of this kind that are laid out back to back, starting at Offset.
+			int32 Count = 1;
+
+			int32 Offset = 0;
+
+			// The property to hash, for Generic ops.
+			const FProperty* Property = nullptr;
+
+			// The plan for the struct, for Struct ops.
+			const FHashPlan* StructPlan = nullptr;
+		};
+
+		/**
+		 * The properties of a struct or class, flattened into a list of operations that reproduce HashProps exactly.
+		 * Scalar properties that follow one another in memory, and in iteration order, are merged into a single run. Each
+		 * value in a run is still combined into the hash individually, so results match those of HashProps.
+		 */
+		struct FHashPlan
+		{
+			TArray<FHashOp> Ops;
+		};
+
+		// Only native types have a fixed layout for the lifetime of the process. Blueprint types can be recompiled or
+		// garbage collected, so they are always hashed by walking their properties.
+		bool HasNativeLayout(const UStruct* Struct)
+		{
+			if (const UClass* Class = Cast<UClass>(Struct))
+			{
+				return Class->HasAnyClassFlags(CLASS_Native);
+			}
+			if (const UScriptStruct* ScriptStruct = Cast<UScriptStruct>(Struct))
+			{
+				return (ScriptStruct->StructFlags & STRUCT_Native) != 0;
+			}
+			return false;
+		}
+
+		int32 GetScalarSize(const EHashOpKind Kind)
+		{
+			switch (Kind)
+			{
+			case EHashOpKind::Bool: return sizeof(bool);
+			case EHashOpKind::Byte: return sizeof(uint8);
+			case EHashOpKind::Int32: return sizeof(int32);
+			case EHashOpKind::Int64: return sizeof(int64);
+			case EHashOpKind::Float: return sizeof(float);
+			case EHashOpKind::Double: return sizeof(double);
+			default: return 0;
+			}
+		}
+
+		// This must classify properties in the same order as HashFProperty, so each op hashes what it would.
+		EHashOpKind ClassifyProperty(const FProperty* Property)
+		{
+			if (Property->IsA<FBoolProperty>()) return EHashOpKind::Bool;
+			if (Property->IsA<FByteProperty>() || Property->IsA<FEnumProperty>()) return EHashOpKind::Byte;
+			if (Property->IsA<FIntProperty>()) return EHashOpKind::Int32;
+			if (Property->IsA<FInt64Property>()) return EHashOpKind::Int64;
+			if (Property->IsA<FFloatProperty>()) return EHashOpKind::Float;
+			if (Property->IsA<FDoubleProperty>()) return EHashOpKind::Double;
+			if (Property->IsA<FNameProperty>()) return EHashOpKind::Name;
+			if (Property->IsA<FStrProperty>()) return EHashOpKind::String;
+			if (Property->IsA<FTextProperty>()) return EHashOpKind::Text;
+			if (const FStructProperty* AsStruct = CastField<FStructProperty>(Property);
+				AsStruct && HasNativeLayout(AsStruct->Struct))
+			{
+				return EHashOpKind::Struct;
+			}
+			return EHashOpKind::Generic;
+		}
+
+		class FHashPlanCache
+		{
+		public:
+			const FHashPlan* FindOrBuild(const UStruct* Struct, const bool IncludeSuper)
+			{
+				if (!HasNativeLayout(Struct))
+				{
+					return nullptr;
+				}
+
+				const FKey Key(Struct, IncludeSuper);
+
+				{
+					FReadScopeLock ReadLock(Lock);
+					if (const TUniquePtr<FHashPlan>* Plan = Plans.Find(Key))
+					{
+						return Plan->Get();
+					}
+				}
+
+				FWriteScopeLock WriteLock(Lock);
+				return FindOrBuild_Locked(Key);
+			}
+
+		private:
+			using FKey = TPair<const UStruct*, bool>;
+
+			const FHashPlan* FindOrBuild_Locked(const FKey& Key)
+			{
+				// Another thread may have built this plan while we waited for the lock.
+				if (const TUniquePtr<FHashPlan>* Existing = Plans.Find(Key))
+				{
+					return Existing->Get();
+				}
+
+				// Plans are heap allocated, so pointers to them stay valid as the map grows.
+				FHashPlan* Plan = Plans.Add(Key, MakeUnique<FHashPlan>()).Get();
+
+				for (TFieldIterator<FProperty> PropIt(Key.Key, Key.Value ? EFieldIterationFlags::IncludeSuper : EFieldIterationFlags::None); PropIt; ++PropIt)
+				{
+					const FProperty* Property = *PropIt;
+					if (!Property)
+					{
+						continue;
+					}
+
+					const EHashOpKind Kind = ClassifyProperty(Property);
+					const int32 Offset = Property->GetOffset_ForInternal();
+
+					// Extend the previous op if this property continues its run.
+					if (const int32 Size = GetScalarSize(Kind);
+						Size > 0 && !Plan->Ops.IsEmpty())
+					{
+						FHashOp& Last = Plan->Ops.Last();
+						if (Last.Kind == Kind && Last.Offset + Last.Count * Size == Offset)
+						{
+							Last.Count++;
+							continue;
+						}
+					}
+
+					FHashOp& Op = Plan->Ops.AddDefaulted_GetRef();
+					Op.Kind = Kind;
+					Op.Offset = Offset;
+
+					switch (Kind)
+					{
+					case EHashOpKind::Struct:
+						Op.StructPlan = FindOrBuild_Locked(FKey(CastFieldChecked<FStructProperty>(Property)->Struct, true));
+						break;
+					case EHashOpKind::Generic:
+						Op.Property = Property;
+						break;
+					default:
+						break;
+					}
+				}
+
+				return Plan;
+			}
+
+			FRWLock Lock;
+			TMap<FKey, TUniquePtr<FHashPlan>> Plans;
+		};
+
+		FHashPlanCache& GetHashPlanCache()
+		{
+			static FHashPlanCache Cache;
+			return Cache;
+		}
+
+		template <typename T>
+		void HashRun(uint32& Hash, const uint8* Ptr, const int32 Count)
+		{
+			const T* Values = reinterpret_cast<const T*>(Ptr);
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Hash = Combine(GetTypeHash(Values[i]), Hash); // GetTypeHash is deterministic for scalars
+			}
+		}
+
+		uint32 ExecutePlan(const FHashPlan& Plan, const void* Container)
+		{
+			const uint8* Base = static_cast<const uint8*>(Container);
+			uint32 Hash = 0;
+
+			for (const FHashOp& Op : Plan.Ops)
+			{
+				const uint8* Ptr = Base + Op.Offset;
+				switch (Op.Kind)
+				{
+				case EHashOpKind::Bool: HashRun<bool>(Hash, Ptr, Op.Count); break;
+				case EHashOpKind::Byte: HashRun<uint8>(Hash, Ptr, Op.Count); break;
+				case EHashOpKind::Int32: HashRun<int32>(Hash, Ptr, Op.Count); break;
+				case EHashOpKind::Int64: HashRun<int64>(Hash, Ptr, Op.Count); break;
+				case EHashOpKind::Float: HashRun<float>(Hash, Ptr, Op.Count); break;
+				case EHashOpKind::Double: HashRun<double>(Hash, Ptr, Op.Count); break;
+				case EHashOpKind::Name:
+					Hash = Combine(TextKeyUtil::HashString(reinterpret_cast<const FName*>(Ptr)->ToString()), Hash);
+					break;
+				case EHashOpKind::String:
+					Hash = Combine(TextKeyUtil::HashString(*reinterpret_cast<const FString*>(Ptr)), Hash);
+					break;
+				case EHashOpKind::Text:
+					Hash = Combine(TextKeyUtil::HashString(reinterpret_cast<const FText*>(Ptr)->BuildSourceString()), Hash);
+					break;
+				case EHashOpKind::Struct:
+					Hash = Combine(ExecutePlan(*Op.StructPlan, Ptr), Hash);
+					break;
+				case EHashOpKind::Generic:
+					Hash = Combine(HashFProperty(Container, Op.Property), Hash);
+					break;
+				}
+			}
+
+			return Hash;
+		}
+	}
+
 	uint32 HashStructByProps(const void* Ptr, const UScriptStruct* Struct, const bool IncludeSuper)
 	{
 		check(Ptr);
 		check(Struct);
+
+		if (UseHashPlans)
+		{
+			if (const Private::FHashPlan* Plan = Private::GetHashPlanCache().FindOrBuild(Struct, IncludeSuper))
+			{
+				return Private::ExecutePlan(*Plan, Ptr);
+			}
+		}
+
 		return HashProps(Ptr, Struct, IncludeSuper);
 	}
 
 	uint32 HashObjectByProps(const UObject* Obj, const bool IncludeSuper)
 	{
 		check(Obj);
+
+		if (UseHashPlans)
+		{
+			if (const Private::FHashPlan* Plan = Private::GetHashPlanCache().FindOrBuild(Obj->GetClass(), IncludeSuper))
+			{
+				return Private::ExecutePlan(*Plan, Obj);
+			}
+		}
+
 		return HashProps(Obj, Obj->GetClass(), IncludeSuper);
 	}
 
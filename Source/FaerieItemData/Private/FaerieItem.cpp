@@ -3,7 +3,11 @@
 #include "FaerieItem.h"
 #include "FaerieItemToken.h"
 #include "AssetLoadFlagFixer.h"
+#include "Async/UniqueLock.h"
 #include "FaerieItemDataLog.h"
+#include "FaerieHashStatics.h"
+#include "FaerieItemAsset.h"
+#include "FaerieItemMutationBatch.h"
 #include "FaerieItemTokenFilter.h"
 #include "FaerieItemTokenFilterTypes.h"
 #include "Net/UnrealNetwork.h"
@@ -27,6 +31,15 @@ namespace Faerie::Token::Tags
 static FDateTime EditorStartupTime = FDateTime::UtcNow();
 #endif
 
+namespace Faerie::ItemData
+{
+	static bool CopyOnWriteTokens = true;
+	static FAutoConsoleVariableRef CVarCopyOnWriteTokens(
+		TEXT("fae.Item.CopyOnWriteTokens"),
+		CopyOnWriteTokens,
+		TEXT("Let duplicates of static items share mutable tokens that allow it, until the duplicate is first mutated."));
+}
+
 using namespace Faerie;
 
 void UFaerieItem::PostInitProperties()
@@ -60,6 +73,12 @@ void UFaerieItem::PostLoad()
 	// Items loaded from disk in shipping builds don't need to re-cache this.
 	CacheTokenMutability();
 #endif
+
+	// Items that cannot change might as well have their token cache ready before anything asks for it.
+	if (!IsDataMutable())
+	{
+		BuildTokenCache();
+	}
 }
 
 void UFaerieItem::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -98,31 +117,47 @@ void UFaerieItem::GetReplicatedCustomConditionState(FCustomPropertyConditionStat
 	}
 }
 
+void UFaerieItem::PostRepNotifies()
+{
+	Super::PostRepNotifies();
+
+	// Tokens may have been replaced by replication.
+	InvalidateTokenCache();
+	MutationVersion++;
+}
+
+bool UFaerieItem::IsNameStableForNetworking() const
+{
+	// An asset recreates its item when saved, which clears the load flags, but the item keeps the same path in the asset.
+	// Clients can always resolve it from their own copy of the asset, so it must never be treated as a dynamic object.
+	if (IsAssetItem())
+	{
+		return GetOuter()->IsNameStableForNetworking();
+	}
+	return Super::IsNameStableForNetworking();
+}
+
+#if WITH_EDITOR
+void UFaerieItem::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	InvalidateTokenCache();
+	MutationVersion++;
+}
+#endif
+
 const UFaerieItemToken* UFaerieItem::GetTokenImpl(const TSubclassOf<UFaerieItemToken>& ValidatedClass, const FGameplayTag ReferenceTag) const
 {
-	// GetOwnedToken Logic
-	for (auto&& Token : Tokens)
+	if (const UFaerieItemToken* Token = GetOwnedTokenImpl(ValidatedClass))
 	{
-		if (IsValid(Token) && Token.IsA(ValidatedClass))
-		{
-			if (Token.IsA(ValidatedClass))
-			{
-				return Token;
-			}
-		}
+		return Token;
 	}
 
-	// Fallback on trying to get a referenced token. Iterate in reverse for now (since static references are usually placed at the end.
-	// @todo control with a cvar or replace with order sorted tokens...
-	for (int32 i = Tokens.Num() - 1; i >= 0; --i)
+	// Fallback on trying to get a referenced token.
+	if (const UFaerieItem* Reference = GetReferencedItemImpl(ReferenceTag))
 	{
-		if (const UFaerieStaticReferenceToken* ReferenceToken = Cast<UFaerieStaticReferenceToken>(Tokens[i]))
-		{
-			if (auto&& Reference = ReferenceToken->GetReferencedItem(ReferenceTag, false))
-			{
-				return Reference->GetOwnedToken(ValidatedClass);
-			}
-		}
+		return Reference->GetOwnedTokenImpl(ValidatedClass);
 	}
 
 	return nullptr;
@@ -135,6 +170,8 @@ UFaerieItemToken* UFaerieItem::GetMutableTokenImpl(const TSubclassOf<UFaerieItem
 		return nullptr;
 	}
 
+	MaterializeSharedTokens();
+
 	for (auto&& Token : Tokens)
 	{
 		if (IsValid(Token) &&
@@ -150,15 +187,130 @@ UFaerieItemToken* UFaerieItem::GetMutableTokenImpl(const TSubclassOf<UFaerieItem
 
 const UFaerieItemToken* UFaerieItem::GetOwnedTokenImpl(const TSubclassOf<UFaerieItemToken>& ValidatedClass) const
 {
-	for (auto&& Token : Tokens)
+	if (!TokenCacheBuilt.load(std::memory_order_acquire))
 	{
-		if (IsValid(Token) && Token.IsA(ValidatedClass))
+		BuildTokenCache();
+	}
+
+	return TokenCache.OwnedTokens.FindRef(ValidatedClass.Get());
+}
+
+const Faerie::Token::FClassMask& UFaerieItem::GetOwnedTokenClasses() const
+{
+	if (!TokenCacheBuilt.load(std::memory_order_acquire))
+	{
+		BuildTokenCache();
+	}
+
+	return TokenCache.OwnedClasses;
+}
+
+bool UFaerieItem::HasTokens(const Token::FClassMask& Classes, const FGameplayTag ReferenceTag) const
+{
+	const Token::FClassMask& OwnedClasses = GetOwnedTokenClasses();
+	if (OwnedClasses.ContainsAll(Classes))
+	{
+		return true;
+	}
+
+	if (ReferenceTag.IsValid())
+	{
+		if (const UFaerieItem* Reference = GetReferencedItemImpl(ReferenceTag))
 		{
-			return Token;
+			return OwnedClasses.ContainsAll(Classes, Reference->GetOwnedTokenClasses());
 		}
 	}
 
-	return nullptr;
+	return false;
+}
+
+const UFaerieItem* UFaerieItem::GetReferencedItemImpl(const FGameplayTag ReferenceTag) const
+{
+	if (!TokenCacheBuilt.load(std::memory_order_acquire))
+	{
+		BuildTokenCache();
+	}
+
+	if (TokenCache.ReferenceTokens.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	UE::TUniqueLock Lock(TokenCacheMutex);
+
+	if (auto&& Memo = TokenCache.ReferencedItems.FindByPredicate(
+		[ReferenceTag](const TPair<FGameplayTag, const UFaerieItem*>& Pair)
+		{
+			return Pair.Key == ReferenceTag;
+		}))
+	{
+		return Memo->Value;
+	}
+
+	const UFaerieItem* Reference = nullptr;
+	for (const UFaerieStaticReferenceToken* ReferenceToken : TokenCache.ReferenceTokens)
+	{
+		Reference = ReferenceToken->GetReferencedItem(ReferenceTag, false);
+		if (Reference)
+		{
+			break;
+		}
+	}
+
+	TokenCache.ReferencedItems.Emplace(ReferenceTag, Reference);
+	return Reference;
+}
+
+void UFaerieItem::BuildTokenCache() const
+{
+	UE::TUniqueLock Lock(TokenCacheMutex);
+
+	// Another thread may have built the cache while we were waiting.
+	if (TokenCacheBuilt.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	TokenCache = FTokenCache();
+
+	for (const UFaerieItemToken* Token : Tokens)
+	{
+		if (!IsValid(Token))
+		{
+			continue;
+		}
+
+		TokenCache.OwnedClasses |= Faerie::Token::FClassMask::ForClass(Token->GetClass());
+
+		// Map the token to its class, and every super class that an earlier token hasn't already claimed.
+		for (const UClass* Class = Token->GetClass(); Class != UFaerieItemToken::StaticClass(); Class = Class->GetSuperClass())
+		{
+			if (TokenCache.OwnedTokens.Contains(Class))
+			{
+				// If this class is claimed, its super classes are as well.
+				break;
+			}
+			TokenCache.OwnedTokens.Add(Class, Token);
+		}
+	}
+
+	// Search static references in reverse, since they are usually placed at the end.
+	for (int32 i = Tokens.Num() - 1; i >= 0; --i)
+	{
+		if (const UFaerieStaticReferenceToken* ReferenceToken = Cast<UFaerieStaticReferenceToken>(Tokens[i]))
+		{
+			TokenCache.ReferenceTokens.Add(ReferenceToken);
+		}
+	}
+
+	TokenCacheBuilt.store(true, std::memory_order_release);
+}
+
+void UFaerieItem::InvalidateTokenCache()
+{
+	UE::TUniqueLock Lock(TokenCacheMutex);
+	TokenCacheBuilt.store(false, std::memory_order_relaxed);
+	TokenCache = FTokenCache();
 }
 
 UFaerieItem* UFaerieItem::CreateNewInstance(const TConstArrayView<UFaerieItemToken*> Tokens, const EFaerieItemInstancingMutability Mutability)
@@ -241,10 +393,24 @@ UFaerieItem* UFaerieItem::CreateDuplicate(const EFaerieItemInstancingMutability
 	Duplicate->Tokens.Reserve(Tokens.Num());
 	for (const TObjectPtr<UFaerieItemToken>& Token : Tokens)
 	{
-		// Mutable tokens must be duplicated.
 		if (Token->IsMutable())
 		{
-			Duplicate->Tokens.Add(Utils::DuplicateObjectFromDiskForReplication(Token.Get(), Duplicate));
+			// Mutable tokens from a static item can be shared until the duplicate asks to mutate them. Their name must
+			// be stable, so that clients can resolve them without the token replicating as a subobject.
+			if (ItemData::CopyOnWriteTokens &&
+				Token->AllowsCopyOnWrite() &&
+				Token->IsNameStableForNetworking() &&
+				IsValid(Token->GetOuterItem()) &&
+				!Token->GetOuterItem()->IsInstanceMutable())
+			{
+				Duplicate->Tokens.Add(ConstCast(Token));
+				Duplicate->HasSharedTokens = true;
+			}
+			// Otherwise, mutable tokens must be duplicated.
+			else
+			{
+				Duplicate->Tokens.Add(Utils::DuplicateObjectFromDiskForReplication(Token.Get(), Duplicate));
+			}
 		}
 		// Immutable tokens can be referenced from the asset directly.
 		else
@@ -261,6 +427,40 @@ UFaerieItem* UFaerieItem::CreateDuplicate(const EFaerieItemInstancingMutability
 	return Duplicate;
 }
 
+void UFaerieItem::MaterializeSharedTokens()
+{
+	if (!HasSharedTokens)
+	{
+		return;
+	}
+	HasSharedTokens = false;
+
+	TArray<UFaerieItemToken*, TInlineAllocator<4>> Materialized;
+	for (TObjectPtr<UFaerieItemToken>& Token : Tokens)
+	{
+		if (IsValid(Token) && Token->IsMutable() && Token->GetOuterItem() != this)
+		{
+			Token = Utils::DuplicateObjectFromDiskForReplication(Token.Get(), this);
+			Materialized.Add(Token);
+		}
+	}
+
+	if (Materialized.IsEmpty())
+	{
+		return;
+	}
+
+	// The content of the tokens is unchanged, so MutationVersion is left alone, but the token objects are new.
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Tokens, this);
+	InvalidateTokenCache();
+
+	// Owners need to learn about the new tokens, so they can be registered for replication.
+	for (const UFaerieItemToken* MaterializedToken : Materialized)
+	{
+		(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, MaterializedToken, Token::Tags::TokenAdd);
+	}
+}
+
 const UFaerieItemToken* UFaerieItem::GetTokenAtIndex(const int32 Index) const
 {
 	if (!Tokens.IsValidIndex(Index))
@@ -369,6 +569,12 @@ bool UFaerieItem::CompareWith(const TNotNull<const UFaerieItem*> Other, const EF
 		return false;
 	}
 
+	// Matching content hashes don't prove the items are equal, but differing ones prove they aren't.
+	if (GetContentHash() != Other->GetContentHash())
+	{
+		return false;
+	}
+
 	// Resort to comparing all tokens. Since most tokens don't implement CompareWith, fallback on hashing the objects.
 	TArray<TObjectPtr<UFaerieItemToken>> TokensA = Tokens;
 	TArray<TObjectPtr<UFaerieItemToken>> TokensB = Other->Tokens;
@@ -413,6 +619,30 @@ bool UFaerieItem::CompareWith(const TNotNull<const UFaerieItem*> Other, const EF
 	return true;
 }
 
+uint32 UFaerieItem::GetContentHash() const
+{
+	if (const uint64 Cached = CachedContentHash.load(std::memory_order_relaxed);
+		static_cast<uint32>(Cached >> 32) == MutationVersion)
+	{
+		return static_cast<uint32>(Cached);
+	}
+
+	// Hashes are combined in sorted order, so this matches the order-independent token matching done by CompareWith.
+	TArray<uint32> TokenHashes;
+	TokenHashes.Reserve(Tokens.Num());
+	for (auto&& Token : Tokens)
+	{
+		if (IsValid(Token))
+		{
+			TokenHashes.Add(Token->GetTokenHash());
+		}
+	}
+	const uint32 ContentHash = Hash::CombineHashes(TokenHashes).Hash;
+
+	CachedContentHash.store((static_cast<uint64>(MutationVersion) << 32) | ContentHash, std::memory_order_relaxed);
+	return ContentHash;
+}
+
 UFaerieItem* UFaerieItem::MutateCast() const
 {
 	if (CanMutate())
@@ -462,6 +692,8 @@ bool UFaerieItem::AddToken(UFaerieItemToken* Token)
 
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Tokens, this);
 	Tokens.Add(Token);
+	InvalidateTokenCache();
+	MutationVersion++;
 
 	(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, Token, Token::Tags::TokenAdd);
 	return true;
@@ -488,6 +720,8 @@ bool UFaerieItem::RemoveToken(const UFaerieItemToken* Token)
 	if (!!Tokens.Remove(ConstCast(ObjectPtrWrap(Token))))
 	{
 		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Tokens, this);
+		InvalidateTokenCache();
+		MutationVersion++;
 
 		LastModified = FDateTime::UtcNow();
 		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, LastModified, this);
@@ -551,6 +785,8 @@ bool UFaerieItem::ReplaceToken(const UFaerieItemToken* Old, UFaerieItemToken* Ne
 
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Tokens, this);
 	Tokens[Index] = New;
+	InvalidateTokenCache();
+	MutationVersion++;
 
 	(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, Old, Token::Tags::TokenRemove);
 	(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, New, Token::Tags::TokenAdd);
@@ -594,6 +830,8 @@ int32 UFaerieItem::RemoveTokensByClass(const TSubclassOf<UFaerieItemToken> Class
 		}))
 	{
 		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Tokens, this);
+		InvalidateTokenCache();
+		MutationVersion++;
 
 		LastModified = FDateTime::UtcNow();
 		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, LastModified, this);
@@ -611,13 +849,16 @@ int32 UFaerieItem::RemoveTokensByClass(const TSubclassOf<UFaerieItemToken> Class
 
 TArray<UFaerieItemToken*> UFaerieItem::GetAllTokens() const
 {
+	// Blueprint can mutate the tokens it gets from here, so they cannot be shared.
+	const_cast<ThisClass*>(this)->MaterializeSharedTokens();
 	return Tokens;
 }
 
 bool UFaerieItem::FindToken(const TSubclassOf<UFaerieItemToken> Class, UFaerieItemToken*& FoundToken) const
 {
 	// @Note: BP doesn't understand const-ness, but since UFaerieItemToken does not have a BP accessible API that can
-	// mutate it, it's perfectly safe.
+	// mutate it, it's perfectly safe. Mutable tokens do have BP accessible mutators, so they cannot be shared.
+	const_cast<ThisClass*>(this)->MaterializeSharedTokens();
 	FoundToken = const_cast<UFaerieItemToken*>(GetToken(Class));
 	return FoundToken != nullptr;
 }
@@ -637,12 +878,23 @@ bool UFaerieItem::CanMutate() const
 	return EnumHasAllFlags(MutabilityFlags, EFaerieItemMutabilityFlags::InstanceMutability | EFaerieItemMutabilityFlags::TokenMutability);
 }
 
+bool UFaerieItem::IsAssetItem() const
+{
+	const UObject* Outer = GetOuter();
+	return Outer && Outer->IsA<UFaerieItemAsset>();
+}
+
 void UFaerieItem::OnTokenEdited(const UFaerieItemToken* Token)
 {
 	check(CanMutate())
+	MutationVersion++;
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, LastModified, this);
 	LastModified = FDateTime::UtcNow();
-	(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, Token, Token::Tags::TokenGenericPropertyEdit);
+
+	if (!Token::Private::FMutationQueue::TryDefer(this, Token))
+	{
+		(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, Token, Token::Tags::TokenGenericPropertyEdit);
+	}
 }
 
 void UFaerieItem::CacheTokenMutability()
@@ -91,6 +91,8 @@ void UFaerieItemAsset::PreSave(FObjectPreSaveContext SaveContext)
 			}
 		}
 	}
+	Item->InvalidateTokenCache();
+	Item->MutationVersion++;
 #endif
 
 	Super::PreSave(SaveContext);
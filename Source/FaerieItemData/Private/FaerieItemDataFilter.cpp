@@ -1,6 +1,7 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieItemDataFilter.h"
+#include "FaerieItemDataFilterProgram.h"
 #include "FaerieItemDataViewBase.h"
 #include "FaerieItemDataViewWrapper.h"
 
@@ -29,3 +30,8 @@ bool UFaerieItemDataFilter::ExecView(Faerie::ItemData::FViewPtr View) const
 {
 	return Exec(View->ResolveView());
 }
+
+void UFaerieItemDataFilter::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitCall(this);
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemDataFilterMemo.h"
+#include "FaerieItem.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_STATS_GROUP(TEXT("FaerieFilterMemo"), STATGROUP_FaerieFilterMemo, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hits"), STAT_FilterMemo_Hits, STATGROUP_FaerieFilterMemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Misses"), STAT_FilterMemo_Misses, STATGROUP_FaerieFilterMemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flushes"), STAT_FilterMemo_Flushes, STATGROUP_FaerieFilterMemo);
+
+namespace Faerie::ItemData
+{
+	static int32 FilterMemoCapacity = 4096;
+	static FAutoConsoleVariableRef CVarFilterMemoCapacity(
+		TEXT("fae.Filter.MemoCapacity"),
+		FilterMemoCapacity,
+		TEXT("The maximum number of results each filter memo keeps before it is flushed."));
+
+	bool FFilterMemo::Exec(const UObject* Filter, const FFaerieItemStackView& View, const TFunctionRef<bool()> Eval)
+	{
+		const UFaerieItem* Item = View.Item.Get();
+		if (!IsValid(Item))
+		{
+			return Eval();
+		}
+
+		const FKey Key{ Filter, Item, View.Copies };
+		const uint32 MutationVersion = Item->GetMutationVersion();
+
+		{
+			FReadScopeLock ReadLock(Lock);
+			if (const FResult* Result = Results.Find(Key);
+				Result && Result->MutationVersion == MutationVersion)
+			{
+				Hits.fetch_add(1, std::memory_order_relaxed);
+				INC_DWORD_STAT(STAT_FilterMemo_Hits);
+				return Result->Passed;
+			}
+		}
+
+		Misses.fetch_add(1, std::memory_order_relaxed);
+		INC_DWORD_STAT(STAT_FilterMemo_Misses);
+
+		const bool Passed = Eval();
+
+		FWriteScopeLock WriteLock(Lock);
+		if (Results.Num() >= FilterMemoCapacity)
+		{
+			Results.Reset();
+			INC_DWORD_STAT(STAT_FilterMemo_Flushes);
+		}
+
+		// Results for an older version of the item are overwritten here, so each stack only ever has one entry.
+		Results.Add(Key, { MutationVersion, Passed });
+		return Passed;
+	}
+
+	void FFilterMemo::Reset()
+	{
+		FWriteScopeLock WriteLock(Lock);
+		Results.Reset();
+	}
+
+	int32 FFilterMemo::Num() const
+	{
+		FReadScopeLock ReadLock(Lock);
+		return Results.Num();
+	}
+}
@@ -0,0 +1,339 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemDataFilterProgram.h"
+#include "Algo/StableSort.h"
+#include "FaerieItem.h"
+#include "FaerieItemDataFilter.h"
+#include "FaerieItemToken.h"
+#include "Tokens/FaerieTagToken.h"
+#include "UObject/Package.h"
+
+namespace Faerie::ItemData
+{
+	FFilterProgram FFilterProgram::Compile(const UFaerieItemDataFilter* Filter)
+	{
+		FFilterProgram Program;
+		FFilterCompiler Compiler(Program);
+		Compiler.EmitFilter(Filter);
+
+		if (Program.Uncompilable)
+		{
+			Program.Reset();
+		}
+		return Program;
+	}
+
+	bool FFilterProgram::CanCompile(const UFaerieItemDataFilter* Filter)
+	{
+		// Filters made at runtime live in the transient package, and may be edited after compiling.
+		const UPackage* Package = Filter->GetPackage();
+		return Package != GetTransientPackage() && !Package->HasAnyFlags(RF_Transient);
+	}
+
+	void FFilterProgram::Reset()
+	{
+		Instructions.Reset();
+		TokenMasks.Reset();
+		TagContainers.Reset();
+		NativeFunctions.Reset();
+		Filters.Reset();
+		Uncompilable = false;
+	}
+
+	void FFilterProgram::AddReferencedObjects(FReferenceCollector& Collector)
+	{
+		Collector.AddReferencedObjects(Filters);
+	}
+
+	bool FFilterProgram::Exec(const FFaerieItemStackView& View) const
+	{
+		const UFaerieItem* Item = View.Item.Get();
+		bool Result = false;
+
+		const FFilterInstruction* Data = Instructions.GetData();
+		const int32 NumInstructions = Instructions.Num();
+		for (int32 i = 0; i < NumInstructions; ++i)
+		{
+			const FFilterInstruction& Instruction = Data[i];
+			switch (Instruction.Op)
+			{
+			case EFilterOp::Literal:
+				Result = Instruction.Operand != 0;
+				break;
+			case EFilterOp::Not:
+				Result = !Result;
+				break;
+			case EFilterOp::Jump:
+				i += Instruction.Operand;
+				break;
+			case EFilterOp::JumpIfTrue:
+				if (Result) i += Instruction.Operand;
+				break;
+			case EFilterOp::JumpIfFalse:
+				if (!Result) i += Instruction.Operand;
+				break;
+			case EFilterOp::Mutability:
+				Result = IsValid(Item) && Item->CanMutate() == (Instruction.Operand != 0);
+				break;
+			case EFilterOp::CompareCopies:
+				Result = CompareFilterValues(static_cast<EFilterCompare>(Instruction.Mode), View.Copies, Instruction.Operand);
+				break;
+			case EFilterOp::HasTokens:
+				Result = HasTokens(Item, Instruction);
+				break;
+			case EFilterOp::TagsAny:
+			case EFilterOp::TagsAll:
+				if (const UFaerieTagToken* TagToken = IsValid(Item) ? Item->GetToken<UFaerieTagToken>() : nullptr)
+				{
+					const FGameplayTagContainer& Tags = TagContainers[Instruction.Index];
+					Result = Instruction.Op == EFilterOp::TagsAny ? TagToken->GetTags().HasAny(Tags) : TagToken->GetTags().HasAll(Tags);
+				}
+				else
+				{
+					Result = false;
+				}
+				break;
+			case EFilterOp::CallNative:
+				Result = NativeFunctions[Instruction.Index](View, Instruction.Mode, Instruction.Operand);
+				break;
+			case EFilterOp::CallFilter:
+				// Filters can be cleared by the reference collector if they are explicitly destroyed.
+				Result = Filters[Instruction.Index] ? Filters[Instruction.Index]->Exec(View) : false;
+				break;
+			default:
+				checkNoEntry();
+			}
+		}
+
+		return Result;
+	}
+
+	bool FFilterProgram::HasTokens(const UFaerieItem* Item, const FFilterInstruction& Instruction) const
+	{
+		if (!IsValid(Item))
+		{
+			return false;
+		}
+
+		const FGameplayTag ReferenceTag = Instruction.Mode != 0 ? Token::Tags::TokenReferenceDefaults : FGameplayTag();
+		return Item->HasTokens(TokenMasks[Instruction.Index], ReferenceTag);
+	}
+
+	FFilterCompiler::FFilterCompiler(FFilterProgram& Program)
+	  : Program(Program),
+		Current(&Program.Instructions) {}
+
+	void FFilterCompiler::Emit(const FFilterInstruction& Instruction)
+	{
+		Current->Add(Instruction);
+	}
+
+	void FFilterCompiler::EmitFilter(const UFaerieItemDataFilter* Filter)
+	{
+		if (IsValid(Filter))
+		{
+			if (!FFilterProgram::CanCompile(Filter))
+			{
+				Program.Uncompilable = true;
+			}
+			Filter->Compile(*this);
+		}
+		else
+		{
+			EmitLiteral(false);
+		}
+	}
+
+	void FFilterCompiler::EmitLiteral(const bool Value)
+	{
+		Emit({ EFilterOp::Literal, 0, Value });
+	}
+
+	void FFilterCompiler::EmitMutability(const bool RequireMutable)
+	{
+		Emit({ EFilterOp::Mutability, 0, RequireMutable });
+	}
+
+	void FFilterCompiler::EmitCompareCopies(const EFilterCompare Compare, const int32 Amount)
+	{
+		Emit({ EFilterOp::CompareCopies, static_cast<uint8>(Compare), Amount });
+	}
+
+	void FFilterCompiler::EmitHasTokens(const TConstArrayView<TSubclassOf<UFaerieItemToken>> Classes, const bool IncludeDefaultReferences)
+	{
+		// Tokens of an invalid class can never be found.
+		for (const TSubclassOf<UFaerieItemToken>& Class : Classes)
+		{
+			if (!IsValid(Class))
+			{
+				EmitLiteral(false);
+				return;
+			}
+		}
+
+		const int32 Index = Program.TokenMasks.Add(Token::FClassMask::ForClasses(Classes));
+		Emit({ EFilterOp::HasTokens, IncludeDefaultReferences, Classes.Num(), Index });
+	}
+
+	void FFilterCompiler::EmitTagsAny(const FGameplayTagContainer& Tags)
+	{
+		Emit({ EFilterOp::TagsAny, 0, 0, Program.TagContainers.Add(Tags) });
+	}
+
+	void FFilterCompiler::EmitTagsAll(const FGameplayTagContainer& Tags)
+	{
+		Emit({ EFilterOp::TagsAll, 0, 0, Program.TagContainers.Add(Tags) });
+	}
+
+	void FFilterCompiler::EmitNative(const FNativeFilterFunction Function, const uint8 Mode, const int32 Operand)
+	{
+		check(Function);
+		Emit({ EFilterOp::CallNative, Mode, Operand, Program.NativeFunctions.AddUnique(Function) });
+	}
+
+	void FFilterCompiler::EmitCall(const UFaerieItemDataFilter* Filter)
+	{
+		check(Filter);
+		Emit({ EFilterOp::CallFilter, 0, 0, Program.Filters.AddUnique(Filter) });
+	}
+
+	void FFilterCompiler::EmitNot(const UFaerieItemDataFilter* Filter)
+	{
+		EmitFilter(Filter);
+		Emit({ EFilterOp::Not });
+	}
+
+	void FFilterCompiler::EmitAnd(const TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Filters)
+	{
+		EmitJunction(Filters, EFilterOp::JumpIfFalse, true);
+	}
+
+	void FFilterCompiler::EmitOr(const TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Filters)
+	{
+		EmitJunction(Filters, EFilterOp::JumpIfTrue, false);
+	}
+
+	void FFilterCompiler::EmitSelect(const UFaerieItemDataFilter* Condition, const UFaerieItemDataFilter* TrueBranch, const UFaerieItemDataFilter* FalseBranch)
+	{
+		if (!IsValid(Condition))
+		{
+			EmitLiteral(false);
+			return;
+		}
+		EmitSelectFragments(CompileFragment(Condition), CompileFragment(TrueBranch), CompileFragment(FalseBranch));
+	}
+
+	void FFilterCompiler::EmitSelect(const UFaerieItemDataFilter* Condition, const UFaerieItemDataFilter* TrueBranch, const bool FalseValue)
+	{
+		if (!IsValid(Condition))
+		{
+			EmitLiteral(false);
+			return;
+		}
+		EmitSelectFragments(CompileFragment(Condition), CompileFragment(TrueBranch), LiteralFragment(FalseValue));
+	}
+
+	FFilterCompiler::FFragment FFilterCompiler::CompileFragment(const UFaerieItemDataFilter* Filter)
+	{
+		FFragment Fragment;
+		FFragment* Outer = Current;
+		Current = &Fragment;
+		EmitFilter(Filter);
+		Current = Outer;
+		return Fragment;
+	}
+
+	FFilterCompiler::FFragment FFilterCompiler::LiteralFragment(const bool Value)
+	{
+		FFragment Fragment;
+		Fragment.Add({ EFilterOp::Literal, 0, Value });
+		return Fragment;
+	}
+
+	void FFilterCompiler::EmitJunction(const TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Filters, const EFilterOp ShortCircuit, const bool EmptyResult)
+	{
+		if (Filters.IsEmpty())
+		{
+			EmitLiteral(EmptyResult);
+			return;
+		}
+
+		TArray<TPair<int32, FFragment>> Fragments;
+		Fragments.Reserve(Filters.Num());
+		for (const TObjectPtr<UFaerieItemDataFilter>& Filter : Filters)
+		{
+			FFragment Fragment = CompileFragment(Filter);
+			Fragments.Emplace(EstimateCost(Fragment), MoveTemp(Fragment));
+		}
+
+		// The result of an And/Or doesn't depend on the order of its children, so run the cheapest first, to give them
+		// the chance to short-circuit the rest.
+		Algo::StableSortBy(Fragments, [](const TPair<int32, FFragment>& Fragment) { return Fragment.Key; });
+
+		// Every child but the last short-circuits to the end of the junction.
+		FFragment Junction;
+		TArray<int32, TInlineAllocator<8>> Jumps;
+		for (int32 i = 0; i < Fragments.Num(); ++i)
+		{
+			Junction.Append(Fragments[i].Value);
+			if (i < Fragments.Num() - 1)
+			{
+				Jumps.Add(Junction.Add({ ShortCircuit }));
+			}
+		}
+
+		for (const int32 Jump : Jumps)
+		{
+			Junction[Jump].Operand = Junction.Num() - Jump - 1;
+		}
+
+		Current->Append(Junction);
+	}
+
+	void FFilterCompiler::EmitSelectFragments(const FFragment& Condition, const FFragment& TrueBranch, const FFragment& FalseBranch)
+	{
+		Current->Append(Condition);
+		Emit({ EFilterOp::JumpIfFalse, 0, TrueBranch.Num() + 1 });
+		Current->Append(TrueBranch);
+		Emit({ EFilterOp::Jump, 0, FalseBranch.Num() });
+		Current->Append(FalseBranch);
+	}
+
+	int32 FFilterCompiler::EstimateCost(const FFragment& Fragment)
+	{
+		// Rough relative costs. Checks on the stack itself are nearly free, token lookups hit the item's token cache, and
+		// calls into filter objects may run anything, including Blueprint.
+		int32 Cost = 0;
+		for (const FFilterInstruction& Instruction : Fragment)
+		{
+			switch (Instruction.Op)
+			{
+			case EFilterOp::Literal:
+			case EFilterOp::Not:
+			case EFilterOp::Jump:
+			case EFilterOp::JumpIfTrue:
+			case EFilterOp::JumpIfFalse:
+				break;
+			case EFilterOp::Mutability:
+			case EFilterOp::CompareCopies:
+				Cost += 1;
+				break;
+			case EFilterOp::TagsAny:
+			case EFilterOp::TagsAll:
+				Cost += 4;
+				break;
+			case EFilterOp::HasTokens:
+				Cost += 2;
+				break;
+			case EFilterOp::CallNative:
+				Cost += 8;
+				break;
+			case EFilterOp::CallFilter:
+				Cost += 64;
+				break;
+			default: ;
+			}
+		}
+		return Cost;
+	}
+}
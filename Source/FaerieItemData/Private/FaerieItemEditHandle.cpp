@@ -9,6 +9,10 @@
 FFaerieItemEditHandle::FFaerieItemEditHandle(const UFaerieItem* InItem)
 {
 	Item = InItem->MutateCast();
+	if (Item.IsValid())
+	{
+		Item->MaterializeSharedTokens();
+	}
 }
 
 FFaerieItemEditHandle::FFaerieItemEditHandle(const IFaerieItemDataProxy* InProxy)
@@ -19,6 +23,10 @@ FFaerieItemEditHandle::FFaerieItemEditHandle(const IFaerieItemDataProxy* InProxy
 		return;
 	}
 	Item = ItemObject->MutateCast();
+	if (Item.IsValid())
+	{
+		Item->MaterializeSharedTokens();
+	}
 }
 
 bool FFaerieItemEditHandle::IsValid() const
@@ -0,0 +1,127 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemMutationBatch.h"
+#include "FaerieItem.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+
+namespace Faerie::Token
+{
+	static bool DeferMutationNotifies = false;
+	static FAutoConsoleVariableRef CVarDeferMutationNotifies(
+		TEXT("fae.Item.DeferMutationNotifies"),
+		DeferMutationNotifies,
+		TEXT("Collect token edits made outside of a mutation batch, and notify item owners once per item at the end of the frame."));
+
+	namespace Private
+	{
+		int32 FMutationQueue::BatchDepth = 0;
+
+		// Edited items, in the order they were first edited, and the tokens edited in each, in the order they were edited.
+		using FEditedTokens = TArray<TWeakObjectPtr<const UFaerieItemToken>, TInlineAllocator<1>>;
+		static TMap<TWeakObjectPtr<UFaerieItem>, FEditedTokens> PendingMutations;
+
+		// Find a token to report an item edit with. Edited tokens may have been removed since, and collected.
+		static const UFaerieItemToken* FindNotifyToken(const UFaerieItem* Item, const FEditedTokens& EditedTokens)
+		{
+			for (const TWeakObjectPtr<const UFaerieItemToken>& Token : EditedTokens)
+			{
+				if (Token.IsValid())
+				{
+					return Token.Get();
+				}
+			}
+
+			// The edit is still merged into the item, so report it with any token the item still has.
+			for (const UFaerieItemToken* Token : Item->GetOwnedTokens())
+			{
+				if (IsValid(Token))
+				{
+					return Token;
+				}
+			}
+			return nullptr;
+		}
+
+		static FDelegateHandle EndFrameHandle;
+
+		bool FMutationQueue::TryDefer(const TNotNull<UFaerieItem*> Item, const TNotNull<const UFaerieItemToken*> Token)
+		{
+			if (!IsInGameThread())
+			{
+				return false;
+			}
+
+			if (BatchDepth == 0)
+			{
+				if (!DeferMutationNotifies)
+				{
+					return false;
+				}
+
+				if (!EndFrameHandle.IsValid())
+				{
+					EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FMutationQueue::Flush);
+				}
+			}
+
+			// Items without an owner have no one to notify.
+			if (!Item->NotifyOwnerOfSelfMutation.IsBound())
+			{
+				return true;
+			}
+
+			PendingMutations.FindOrAdd(static_cast<UFaerieItem*>(Item)).AddUnique(static_cast<const UFaerieItemToken*>(Token));
+			return true;
+		}
+
+		void FMutationQueue::Flush()
+		{
+			// Owners may edit items in response, so loop until nothing new was deferred.
+			while (!PendingMutations.IsEmpty())
+			{
+				auto Mutations = MoveTemp(PendingMutations);
+				PendingMutations.Reset();
+
+				for (auto&& Mutation : Mutations)
+				{
+					UFaerieItem* Item = Mutation.Key.Get();
+					if (!IsValid(Item))
+					{
+						continue;
+					}
+
+					// If the item has no tokens left, owners have already been told about each removal.
+					const UFaerieItemToken* Token = FindNotifyToken(Item, Mutation.Value);
+					if (!Token)
+					{
+						continue;
+					}
+
+					(void)Item->NotifyOwnerOfSelfMutation.ExecuteIfBound(Item, Token, Tags::TokenGenericPropertyEdit);
+				}
+			}
+		}
+	}
+
+	FScopedMutationBatch::FScopedMutationBatch()
+	{
+		check(IsInGameThread());
+		Private::FMutationQueue::BatchDepth++;
+	}
+
+	FScopedMutationBatch::~FScopedMutationBatch()
+	{
+		check(Private::FMutationQueue::BatchDepth > 0);
+		if (--Private::FMutationQueue::BatchDepth == 0)
+		{
+			Private::FMutationQueue::Flush();
+		}
+	}
+
+	void FlushDeferredMutations()
+	{
+		check(IsInGameThread());
+		Private::FMutationQueue::Flush();
+	}
+}
@@ -41,11 +41,41 @@ void UFaerieItemToken::PostCDOCompiled(const FPostCDOCompiledContext& Context)
 }
 #endif
 
+void UFaerieItemToken::PostRepNotifies()
+{
+	Super::PostRepNotifies();
+
+	// Replicated edits don't go through EditToken, so tell our item that its data has changed. The item's token cache
+	// memoizes what reference tokens resolve to, so it must be dropped as well.
+	if (const UFaerieItem* Item = GetOuterItem())
+	{
+		UFaerieItem* MutableItem = const_cast<UFaerieItem*>(Item);
+		MutableItem->InvalidateTokenCache();
+		MutableItem->MutationVersion++;
+	}
+}
+
+bool UFaerieItemToken::IsNameStableForNetworking() const
+{
+	// Tokens of an asset's item are recreated along with it, and are as stable as it is.
+	if (const UFaerieItem* Item = Cast<UFaerieItem>(GetOuter());
+		Item && Item->IsAssetItem())
+	{
+		return Item->IsNameStableForNetworking();
+	}
+	return Super::IsNameStableForNetworking();
+}
+
 bool UFaerieItemToken::IsMutable() const
 {
 	return false;
 }
 
+bool UFaerieItemToken::AllowsCopyOnWrite() const
+{
+	return false;
+}
+
 bool UFaerieItemToken::CompareWithImpl(const UFaerieItemToken* Other) const
 {
 	return true;
@@ -114,6 +144,13 @@ UFaerieItemToken* UFaerieItemToken::MutateCast() const
 {
 	if (IsMutable())
 	{
+		// Mutable tokens still referenced from a static item are shared by its copy-on-write duplicates, and must not
+		// be edited in place.
+		if (const UFaerieItem* OuterItem = GetOuterItem();
+			IsValid(OuterItem) && !OuterItem->IsInstanceMutable())
+		{
+			return nullptr;
+		}
 		return const_cast<ThisClass*>(this);
 	}
 	return nullptr;
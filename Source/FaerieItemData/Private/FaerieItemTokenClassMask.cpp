@@ -0,0 +1,140 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemTokenClassMask.h"
+#include "FaerieItemToken.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/ObjectKey.h"
+
+namespace Faerie::Token
+{
+	namespace Private
+	{
+		// Assigns each token class a bit, and stores the flattened mask of its hierarchy.
+		class FClassMaskRegistry
+		{
+		public:
+			static FClassMaskRegistry& Get()
+			{
+				static FClassMaskRegistry Registry;
+				return Registry;
+			}
+
+			const FClassMask& FindOrAdd(const UClass* Class)
+			{
+				const TObjectKey<UClass> Key(Class);
+
+				{
+					FReadScopeLock ReadLock(Lock);
+					if (const TUniquePtr<FClassMask>* Found = Masks.Find(Key))
+					{
+						return **Found;
+					}
+				}
+
+				// Register super classes first, so that their masks can be merged into this one.
+				const UClass* SuperClass = Class->GetSuperClass();
+				const FClassMask* SuperMask = Class != UFaerieItemToken::StaticClass() ? &FindOrAdd(SuperClass) : nullptr;
+
+				FWriteScopeLock WriteLock(Lock);
+
+				// Another thread may have registered the class while we were waiting.
+				if (const TUniquePtr<FClassMask>* Found = Masks.Find(Key))
+				{
+					return **Found;
+				}
+
+				// Masks are allocated separately, so that references to them stay valid as the map grows.
+				TUniquePtr<FClassMask> Mask = MakeUnique<FClassMask>();
+				if (SuperMask)
+				{
+					*Mask |= *SuperMask;
+				}
+				Mask->SetBit(NextIndex++);
+				return *Masks.Add(Key, MoveTemp(Mask));
+			}
+
+		private:
+			FRWLock Lock;
+			TMap<TObjectKey<UClass>, TUniquePtr<FClassMask>> Masks;
+			int32 NextIndex = 0;
+		};
+	}
+
+	const FClassMask& FClassMask::ForClass(const UClass* Class)
+	{
+		static const FClassMask Empty;
+
+		if (!IsValid(Class) || !Class->IsChildOf(UFaerieItemToken::StaticClass()))
+		{
+			return Empty;
+		}
+
+		return Private::FClassMaskRegistry::Get().FindOrAdd(Class);
+	}
+
+	bool FClassMask::ContainsAll(const FClassMask& Required) const
+	{
+		if (Required.Words.Num() > Words.Num())
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < Required.Words.Num(); ++i)
+		{
+			if ((Words[i] & Required.Words[i]) != Required.Words[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool FClassMask::ContainsAll(const FClassMask& Required, const FClassMask& Other) const
+	{
+		for (int32 i = 0; i < Required.Words.Num(); ++i)
+		{
+			if (((GetWord(i) | Other.GetWord(i)) & Required.Words[i]) != Required.Words[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool FClassMask::ContainsAny(const FClassMask& Other) const
+	{
+		const int32 NumWords = FMath::Min(Words.Num(), Other.Words.Num());
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			if (Words[i] & Other.Words[i])
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	FClassMask& FClassMask::operator|=(const FClassMask& Other)
+	{
+		if (Other.Words.Num() > Words.Num())
+		{
+			Words.SetNumZeroed(Other.Words.Num());
+		}
+
+		for (int32 i = 0; i < Other.Words.Num(); ++i)
+		{
+			Words[i] |= Other.Words[i];
+		}
+		return *this;
+	}
+
+	void FClassMask::SetBit(const int32 Index)
+	{
+		const int32 Word = Index / 64;
+		if (Word >= Words.Num())
+		{
+			Words.SetNumZeroed(Word + 1);
+		}
+		Words[Word] |= uint64(1) << (Index % 64);
+	}
+}
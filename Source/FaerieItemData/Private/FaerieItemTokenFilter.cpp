@@ -49,6 +49,11 @@ namespace Faerie::Token
 			Item->WriteLock--;
 		}
 
+		void FIteratorAccess::MaterializeSharedTokens(const TNotNull<const UFaerieItem*> Item)
+		{
+			const_cast<UFaerieItem*>(static_cast<const UFaerieItem*>(Item))->MaterializeSharedTokens();
+		}
+
 		void FIteratorAccess::HashCombineToken(const TNotNull<const UFaerieItemToken*> Token, uint32& Hash)
 		{
 			Hash = Hash::Combine(Hash, Token->GetTokenHash());
@@ -2,23 +2,28 @@
 
 #pragma once
 
+#include "Async/Mutex.h"
 #include "FaerieItemDataConcepts.h"
 #include "FaerieItemDataEnums.h"
+#include "FaerieItemTokenClassMask.h"
 #include "GameplayTagContainer.h"
 #include "NativeGameplayTags.h"
 #include "NetSupportedObject.h"
 #include "Templates/SubclassOf.h"
+#include <atomic>
 
 #include "FaerieItem.generated.h"
 
 class UFaerieItem;
 class UFaerieItemToken;
+class UFaerieStaticReferenceToken;
 
 namespace Faerie::Token
 {
 	namespace Private
 	{
 		class FIteratorAccess;
+		class FMutationQueue;
 	}
 
 	namespace Tags
@@ -44,6 +49,7 @@ class FAERIEITEMDATA_API UFaerieItem : public UNetSupportedObject
 	friend UFaerieItemToken;
 	friend class UFaerieItemAsset;
 	friend Faerie::Token::Private::FIteratorAccess;
+	friend Faerie::Token::Private::FMutationQueue;
 
 public:
 	//~ Begin UObject interface
@@ -52,6 +58,11 @@ public:
 	virtual void PostLoad() override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual void GetReplicatedCustomConditionState(FCustomPropertyConditionState& OutActiveState) const override;
+	virtual void PostRepNotifies() override;
+	virtual bool IsNameStableForNetworking() const override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 	//~ Emd UObject interface
 
 private:
@@ -59,6 +70,12 @@ private:
 	const UFaerieItemToken* GetOwnedTokenImpl(const TSubclassOf<UFaerieItemToken>& ValidatedClass) const;
 	UFaerieItemToken* GetMutableTokenImpl(const TSubclassOf<UFaerieItemToken>& ValidatedClass);
 
+	// Gets the item that tokens are borrowed from when not owned by this item, memoized per tag.
+	const UFaerieItem* GetReferencedItemImpl(FGameplayTag ReferenceTag) const;
+
+	void BuildTokenCache() const;
+	void InvalidateTokenCache();
+
 public:
 	// Creates a new faerie item object with the given tokens. These are instance-mutable by default.
 	static UFaerieItem* CreateNewInstance(TConstArrayView<UFaerieItemToken*> Tokens, EFaerieItemInstancingMutability Mutability = EFaerieItemInstancingMutability::Automatic);
@@ -67,8 +84,13 @@ public:
 	UFaerieItem* CreateInstance(EFaerieItemInstancingMutability Mutability = EFaerieItemInstancingMutability::Automatic) const;
 
 	// Creates a new faerie item object using this instance as a template. Duplicates are instance-mutable by default.
+	// Mutable tokens that allow copy-on-write are shared with a static template until the duplicate is first mutated.
 	UFaerieItem* CreateDuplicate(EFaerieItemInstancingMutability Mutability = EFaerieItemInstancingMutability::Automatic) const;
 
+	// Replaces any mutable tokens still shared with the template this item was duplicated from with owned copies.
+	// This is called before handing out mutable access to tokens, and does nothing once all tokens are owned.
+	void MaterializeSharedTokens();
+
 	// Gets a view of all owned tokens in this item.
 	TConstArrayView<TObjectPtr<UFaerieItemToken>> GetOwnedTokens() const { return Tokens; }
 
@@ -95,6 +117,12 @@ public:
 		return CastChecked<T>(GetOwnedTokenImpl(T::StaticClass()), ECastCheckedType::NullAllowed);
 	}
 
+	// Gets the classes of all owned tokens, and all of their super classes.
+	const Faerie::Token::FClassMask& GetOwnedTokenClasses() const;
+
+	// Are there tokens of every class in Classes? Tokens may be owned, or, if ReferenceTag is valid, referenced.
+	bool HasTokens(const Faerie::Token::FClassMask& Classes, FGameplayTag ReferenceTag = FGameplayTag()) const;
+
 	// Gets mutable access to an owned token, if this item allows mutation.
 	UFaerieItemToken* GetMutableToken(const TSubclassOf<UFaerieItemToken>& Class);
 
@@ -112,6 +140,13 @@ public:
 	static bool Compare(const UFaerieItem* A, const UFaerieItem* B, const EFaerieItemComparisonFlags Flags);
 	bool CompareWith(TNotNull<const UFaerieItem*> Other, const EFaerieItemComparisonFlags Flags) const;
 
+	// Gets a hash of the data in all owned tokens. Computed on demand, and cached until the mutation version changes.
+	uint32 GetContentHash() const;
+
+	// Gets a number that increases whenever tokens are added to, removed from, or edited on this item. This can be used
+	// as a cheap key to invalidate anything derived from the item's data.
+	uint32 GetMutationVersion() const { return MutationVersion; }
+
 
 	//~		C++ Item Mutation		~//
 
@@ -151,8 +186,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FaerieItem")
 	bool CanMutate() const;
 
+	// Is this the canonical item compiled into a UFaerieItemAsset? These are shared by all immutable instances of the
+	// asset, and are replicated by reference to the asset, never as a subobject.
+	bool IsAssetItem() const;
+
 protected:
-	// Called by our own tokens when they are edited.
+	// Called by our own tokens when they are edited. Owners may be notified later, see Faerie::Token::FScopedMutationBatch.
 	void OnTokenEdited(const UFaerieItemToken* Token);
 
 	void CacheTokenMutability();
@@ -184,6 +223,37 @@ private:
 	// Is writing to Tokens locked?
 	mutable uint32 WriteLock = 0;
 
+	// Are any mutable tokens in Tokens still owned by the template this item was duplicated from?
+	bool HasSharedTokens = false;
+
+	// Incremented whenever Tokens, or the data in a token, changes.
+	uint32 MutationVersion = 1;
+
+	// The last computed content hash in the low 32 bits, and the MutationVersion it was computed at in the high 32 bits.
+	mutable std::atomic<uint64> CachedContentHash { 0 };
+
+	// Lookup tables for GetToken. Built on first use, and discarded whenever Tokens changes.
+	struct FTokenCache
+	{
+		// The first owned token of each token class, and of each of their super classes.
+		TMap<const UClass*, const UFaerieItemToken*> OwnedTokens;
+
+		// The classes of all owned tokens, for checking several classes at once.
+		Faerie::Token::FClassMask OwnedClasses;
+
+		// Owned static reference tokens, in the order that they are searched.
+		TArray<const UFaerieStaticReferenceToken*, TInlineAllocator<1>> ReferenceTokens;
+
+		// Items found by searching ReferenceTokens, per reference tag. Filled in as tags are requested.
+		TArray<TPair<FGameplayTag, const UFaerieItem*>, TInlineAllocator<1>> ReferencedItems;
+	};
+	mutable FTokenCache TokenCache;
+
+	// Tokens may be looked up from multiple threads (e.g., by parallel query filters), so the cache is built under a
+	// lock, and then published with this flag. Once built, OwnedTokens and ReferenceTokens are read without locking.
+	mutable std::atomic<bool> TokenCacheBuilt { false };
+	mutable UE::FMutex TokenCacheMutex;
+
 protected:
 	UE_DEPRECATED(5.6, TEXT("Replaced by UFaerieItemDataLibrary::FindTokensByClass"))
 	UFUNCTION(BlueprintCallable, BlueprintPure = false, meta = (DeterminesOutputType = Class, DynamicOutputParam = FoundTokens, deprecated, DeprecationMessage = "Replaced by UFaerieItemDataLibrary::FindTokensByClass"))
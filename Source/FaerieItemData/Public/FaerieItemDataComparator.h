@@ -9,6 +9,24 @@
 namespace Faerie::ItemData
 {
 	class IViewBase;
+
+	/**
+	 * A precomputed key that orders item views. Keys are compared by Integer, then Number, then String.
+	 * Unused members can be left at their defaults.
+	 */
+	struct FSortKey
+	{
+		int64 Integer = 0;
+		double Number = 0.0;
+		FString String;
+
+		friend bool operator<(const FSortKey& A, const FSortKey& B)
+		{
+			if (A.Integer != B.Integer) return A.Integer < B.Integer;
+			if (A.Number != B.Number) return A.Number < B.Number;
+			return A.String < B.String;
+		}
+	};
 }
 
 struct FFaerieItemDataViewWrapper;
@@ -25,6 +43,15 @@ public:
 	virtual bool Exec(Faerie::ItemData::FViewPtr ViewA, Faerie::ItemData::FViewPtr ViewB) const
 		PURE_VIRTUAL(UFaerieItemDataComparator::Exec, return false; )
 
+	// Comparators that implement ExtractSortKey should override this to return true.
+	virtual bool HasSortKey() const { return false; }
+
+	/**
+	 * Get a key for a view, such that Exec(A, B) == ExtractSortKey(A) < ExtractSortKey(B). When sorting many views, this
+	 * allows each to be resolved once, and their keys compared, instead of comparing every pair of views.
+	 */
+	virtual Faerie::ItemData::FSortKey ExtractSortKey(Faerie::ItemData::FViewPtr View) const { return {}; }
+
 protected:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|ItemDataComparator", DisplayName = "Exec")
 	bool K2_Exec(const FFaerieItemDataViewWrapper& A, const FFaerieItemDataViewWrapper& B) const;
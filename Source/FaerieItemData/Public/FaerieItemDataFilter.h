@@ -13,6 +13,7 @@ struct FFaerieItemDataViewWrapper;
 namespace Faerie::ItemData
 {
 	class IViewBase;
+	class FFilterCompiler;
 
 	class FFilterLogger
 	{
@@ -46,4 +47,12 @@ public:
 	// Overlord that accepts a ViewBase pointer, typically from an iterator. If children implement this, they also need
 	// to implement the struct version as well.
 	virtual bool ExecView(Faerie::ItemData::FViewPtr View) const;
+
+	// Filters that only read item data, and never call into Blueprint, can return true to allow queries to run them on
+	// worker threads. Filters that run child filters should only return true if all of their children do.
+	virtual bool IsThreadSafe() const { return false; }
+
+	// Emit the instructions that run this filter in a compiled filter program. The default emits a call to Exec, so
+	// only filters that can be expressed by the built-in instructions, or by a native function, need to override this.
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const;
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemStackView.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/ObjectKey.h"
+
+namespace Faerie::ItemData
+{
+	/**
+	 * Remembers the results of running filters on item stacks. Results are keyed by filter, item, and copies, and are
+	 * reused for as long as the item's mutation version is unchanged, so results for immutable items never expire.
+	 * This is only correct for filters whose result depends on nothing but the stack, which is why it's opt-in.
+	 * Memory is bounded by fae.Filter.MemoCapacity. A full memo is flushed rather than evicting entries one by one.
+	 * Safe to use from multiple threads.
+	 */
+	class FAERIEITEMDATA_API FFilterMemo
+	{
+	public:
+		// Get the remembered result of Filter for View, or run Eval and remember its result.
+		bool Exec(const UObject* Filter, const FFaerieItemStackView& View, TFunctionRef<bool()> Eval);
+
+		void Reset();
+
+		[[nodiscard]] int32 Num() const;
+		[[nodiscard]] uint64 GetHits() const { return Hits.load(std::memory_order_relaxed); }
+		[[nodiscard]] uint64 GetMisses() const { return Misses.load(std::memory_order_relaxed); }
+
+	private:
+		struct FKey
+		{
+			TObjectKey<UObject> Filter;
+			TObjectKey<UFaerieItem> Item;
+			int32 Copies;
+
+			friend bool operator==(const FKey& A, const FKey& B)
+			{
+				return A.Filter == B.Filter && A.Item == B.Item && A.Copies == B.Copies;
+			}
+
+			friend uint32 GetTypeHash(const FKey& Key)
+			{
+				return HashCombineFast(HashCombineFast(GetTypeHash(Key.Filter), GetTypeHash(Key.Item)), ::GetTypeHash(Key.Copies));
+			}
+		};
+
+		struct FResult
+		{
+			uint32 MutationVersion;
+			bool Passed;
+		};
+
+		TMap<FKey, FResult> Results;
+		mutable FRWLock Lock;
+
+		std::atomic<uint64> Hits { 0 };
+		std::atomic<uint64> Misses { 0 };
+	};
+}
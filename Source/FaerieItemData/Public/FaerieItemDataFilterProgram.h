@@ -0,0 +1,174 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemStackView.h"
+#include "FaerieItemTokenClassMask.h"
+#include "GameplayTagContainer.h"
+
+class FReferenceCollector;
+class UFaerieItemDataFilter;
+class UFaerieItemToken;
+
+namespace Faerie::ItemData
+{
+	enum class EFilterOp : uint8
+	{
+		// Set the result to Operand.
+		Literal,
+
+		// Invert the result.
+		Not,
+
+		// Skip the next Operand instructions, always, or only when the result is true or false.
+		Jump,
+		JumpIfTrue,
+		JumpIfFalse,
+
+		// Check that the item's mutability is Operand.
+		Mutability,
+
+		// Compare the number of copies to Operand, using Mode as an EFilterCompare.
+		CompareCopies,
+
+		// Check for tokens of every class in TokenMasks[Index], which was built from Operand classes. Mode is set to include default references.
+		HasTokens,
+
+		// Check the item's tags against TagContainers[Index].
+		TagsAny,
+		TagsAll,
+
+		// Call NativeFunctions[Index], passing Mode and Operand.
+		CallNative,
+
+		// Call Exec on Filters[Index].
+		CallFilter
+	};
+
+	enum class EFilterCompare : uint8
+	{
+		Less,
+		LessOrEqual,
+		Greater,
+		GreaterOrEqual,
+		Equal,
+		NotEqual
+	};
+
+	[[nodiscard]] inline bool CompareFilterValues(const EFilterCompare Compare, const int32 A, const int32 B)
+	{
+		switch (Compare)
+		{
+		case EFilterCompare::Less:				return A < B;
+		case EFilterCompare::LessOrEqual:		return A <= B;
+		case EFilterCompare::Greater:			return A > B;
+		case EFilterCompare::GreaterOrEqual:	return A >= B;
+		case EFilterCompare::Equal:				return A == B;
+		case EFilterCompare::NotEqual:			return A != B;
+		default: return false;
+		}
+	}
+
+	// A native leaf rule. Mode and Operand are the parameters it was emitted with.
+	using FNativeFilterFunction = bool(*)(const FFaerieItemStackView& View, uint8 Mode, int32 Operand);
+
+	struct FFilterInstruction
+	{
+		EFilterOp Op = EFilterOp::Literal;
+		uint8 Mode = 0;
+		int32 Operand = 0;
+		int32 Index = 0;
+	};
+
+	/**
+	 * A filter tree flattened into an instruction array, so that it can be run as a single loop, without recursion, and
+	 * without virtual calls for rules that know how to compile themselves. The result of each rule is kept in a single
+	 * register, and And/Or/Not/Condition rules are implemented with jumps.
+	 * Rule parameters are copied into the program when it is compiled, so a program would never see later edits to its
+	 * filters. Because of this, only filters that belong to an asset are compiled, and are treated as read-only at
+	 * runtime. Programs for filters created at runtime, which may still be edited, e.g., by Blueprint, are left empty.
+	 * Owners must report the filters that a program calls into with AddReferencedObjects.
+	 */
+	class FAERIEITEMDATA_API FFilterProgram
+	{
+		friend class FFilterCompiler;
+
+	public:
+		// Compile a filter tree. Returns an empty program if any filter in it does not belong to an asset.
+		static FFilterProgram Compile(const UFaerieItemDataFilter* Filter);
+
+		// Can this filter be compiled? Its children may still prevent the tree from compiling.
+		static bool CanCompile(const UFaerieItemDataFilter* Filter);
+
+		[[nodiscard]] bool IsEmpty() const { return Instructions.IsEmpty(); }
+		[[nodiscard]] int32 Num() const { return Instructions.Num(); }
+
+		void Reset();
+
+		[[nodiscard]] bool Exec(const FFaerieItemStackView& View) const;
+
+		void AddReferencedObjects(FReferenceCollector& Collector);
+
+	private:
+		bool HasTokens(const UFaerieItem* Item, const FFilterInstruction& Instruction) const;
+
+		TArray<FFilterInstruction> Instructions;
+		TArray<Token::FClassMask> TokenMasks;
+		TArray<FGameplayTagContainer> TagContainers;
+		TArray<FNativeFilterFunction> NativeFunctions;
+		TArray<const UFaerieItemDataFilter*> Filters;
+
+		// Set while compiling, if a filter that cannot be compiled was found.
+		bool Uncompilable = false;
+	};
+
+	/**
+	 * Builds an FFilterProgram. Filters emit their instructions by overriding UFaerieItemDataFilter::Compile. Children of
+	 * And/Or rules are compiled separately, and reordered so that the cheapest run first.
+	 */
+	class FAERIEITEMDATA_API FFilterCompiler
+	{
+	public:
+		FFilterCompiler(FFilterProgram& Program);
+
+		// Compile a filter in place. Null filters always fail.
+		void EmitFilter(const UFaerieItemDataFilter* Filter);
+
+		void EmitLiteral(bool Value);
+		void EmitMutability(bool RequireMutable);
+		void EmitCompareCopies(EFilterCompare Compare, int32 Amount);
+		void EmitHasTokens(TConstArrayView<TSubclassOf<UFaerieItemToken>> Classes, bool IncludeDefaultReferences);
+		void EmitTagsAny(const FGameplayTagContainer& Tags);
+		void EmitTagsAll(const FGameplayTagContainer& Tags);
+		void EmitNative(FNativeFilterFunction Function, uint8 Mode, int32 Operand);
+
+		// Run a filter by calling its Exec. This is the fallback for filters that cannot compile themselves.
+		void EmitCall(const UFaerieItemDataFilter* Filter);
+
+		void EmitNot(const UFaerieItemDataFilter* Filter);
+		void EmitAnd(TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Filters);
+		void EmitOr(TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Filters);
+
+		// Run TrueBranch if Condition passes, otherwise FalseBranch.
+		void EmitSelect(const UFaerieItemDataFilter* Condition, const UFaerieItemDataFilter* TrueBranch, const UFaerieItemDataFilter* FalseBranch);
+
+		// Run TrueBranch if Condition passes, otherwise return FalseValue.
+		void EmitSelect(const UFaerieItemDataFilter* Condition, const UFaerieItemDataFilter* TrueBranch, bool FalseValue);
+
+	private:
+		using FFragment = TArray<FFilterInstruction>;
+
+		void Emit(const FFilterInstruction& Instruction);
+		FFragment CompileFragment(const UFaerieItemDataFilter* Filter);
+		FFragment LiteralFragment(bool Value);
+		void EmitJunction(TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Filters, EFilterOp ShortCircuit, bool EmptyResult);
+		void EmitSelectFragments(const FFragment& Condition, const FFragment& TrueBranch, const FFragment& FalseBranch);
+
+		static int32 EstimateCost(const FFragment& Fragment);
+
+		FFilterProgram& Program;
+
+		// The instructions currently being written to.
+		FFragment* Current;
+	};
+}
@@ -0,0 +1,41 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Misc/NotNull.h"
+
+class UFaerieItem;
+class UFaerieItemToken;
+
+namespace Faerie::Token
+{
+	/**
+	 * While any batch is open, token property edits don't notify item owners immediately. Instead, each edited item is
+	 * collected once, and owners are notified of one merged change per item when the outermost batch closes.
+	 * Token adds and removes are never deferred, as owners must register and unregister those tokens immediately.
+	 * Batches may only be opened on the game thread.
+	 */
+	class FAERIEITEMDATA_API FScopedMutationBatch : FNoncopyable
+	{
+	public:
+		FScopedMutationBatch();
+		~FScopedMutationBatch();
+	};
+
+	// Notify owners of all deferred token edits now.
+	FAERIEITEMDATA_API void FlushDeferredMutations();
+
+	namespace Private
+	{
+		class FMutationQueue
+		{
+		public:
+			// Defer notifying the owner of an item about an edit. Returns false if the owner must be notified now.
+			static bool TryDefer(TNotNull<UFaerieItem*> Item, TNotNull<const UFaerieItemToken*> Token);
+
+			static void Flush();
+
+			static int32 BatchDepth;
+		};
+	}
+}
@@ -44,12 +44,18 @@ public:
 #if WITH_EDITOR
 	virtual void PostCDOCompiled(const FPostCDOCompiledContext& Context) override;
 #endif
+	virtual void PostRepNotifies() override;
+	virtual bool IsNameStableForNetworking() const override;
 	//~ End UObject interface
 
 	// Can the data contained be this token by changed after initialization. This plays a major role in how items are
 	// handled. An item with *any* mutable data cannot be stacked.
 	virtual bool IsMutable() const;
 
+	// Can this mutable token be shared by the duplicates of a static item until one of them asks to mutate it? Tokens
+	// that own other objects, or register themselves anywhere, must not allow this. See UFaerieItem::CreateDuplicate.
+	virtual bool AllowsCopyOnWrite() const;
+
 protected:
 	/*
 	 * Compare the data of this token to another. Most of the time, there is no need to override this. This function is
@@ -59,6 +65,8 @@ protected:
 	 * or any token that explicitly is used to differentiate items when their primary identifiers match.
 	 * Further note that any token that is mutable is automatically dissimilar even if it is data-wise identical, so it
 	 * is meaningless to implement this in that case.
+	 * Primary identifier tokens that implement this must also implement GetTokenHashImpl, so that tokens that compare
+	 * equal hash equal. Storages find items to stack with by hash first, and will not stack items whose hashes differ.
 	 */
 	virtual bool CompareWithImpl(const UFaerieItemToken* Other) const;
 
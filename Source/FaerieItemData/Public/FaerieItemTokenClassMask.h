@@ -0,0 +1,70 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/Array.h"
+
+class UClass;
+
+namespace Faerie::Token
+{
+	namespace Private
+	{
+		class FClassMaskRegistry;
+	}
+
+	/**
+	 * A set of token classes, stored as bits. Each token class is assigned a bit by a global registry the first time it
+	 * is seen, and a class's mask includes the bits of all its super classes, so that IsA checks become bit tests, and
+	 * checking for several classes at once is a single AND.
+	 * Bit indices are assigned at runtime, and must not be saved or replicated.
+	 */
+	class FAERIEITEMDATA_API FClassMask
+	{
+		friend Private::FClassMaskRegistry;
+
+	public:
+		// Gets the mask containing a token class and all of its super classes. Invalid or non-token classes are empty.
+		static const FClassMask& ForClass(const UClass* Class);
+
+		// Gets a mask that requires all the given classes.
+		template <typename TClassRange>
+		static FClassMask ForClasses(const TClassRange& Classes)
+		{
+			FClassMask Mask;
+			for (auto&& Class : Classes)
+			{
+				Mask |= ForClass(Class);
+			}
+			return Mask;
+		}
+
+		[[nodiscard]] bool IsEmpty() const { return Words.IsEmpty(); }
+
+		void Reset() { Words.Reset(); }
+
+		// Does this mask contain every bit in Required?
+		[[nodiscard]] bool ContainsAll(const FClassMask& Required) const;
+
+		// Does the union of this mask and Other contain every bit in Required?
+		[[nodiscard]] bool ContainsAll(const FClassMask& Required, const FClassMask& Other) const;
+
+		// Does this mask contain any bit in Other?
+		[[nodiscard]] bool ContainsAny(const FClassMask& Other) const;
+
+		FClassMask& operator|=(const FClassMask& Other);
+
+		friend bool operator==(const FClassMask& A, const FClassMask& B) { return A.Words == B.Words; }
+
+	private:
+		void SetBit(int32 Index);
+
+		[[nodiscard]] uint64 GetWord(const int32 Index) const
+		{
+			return Words.IsValidIndex(Index) ? Words[Index] : 0;
+		}
+
+		// Trailing zero words are never stored, so masks can be compared directly.
+		TArray<uint64, TInlineAllocator<2>> Words;
+	};
+}
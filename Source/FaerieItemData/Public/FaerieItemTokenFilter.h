@@ -29,6 +29,8 @@ namespace Faerie::Token
 			static void AddWriteLock(TNotNull<const UFaerieItem*> Item);
 			static void RemoveWriteLock(TNotNull<const UFaerieItem*> Item);
 
+			static void MaterializeSharedTokens(TNotNull<const UFaerieItem*> Item);
+
 			static void HashCombineToken(TNotNull<const UFaerieItemToken*> Token, uint32& Hash);
 
 			static bool CompareTokenMasks(const TBitArray<>& MaskA, TNotNull<const UFaerieItem*> ItemA, const TBitArray<>& MaskB, TNotNull<const UFaerieItem*> ItemB);
@@ -328,6 +330,8 @@ namespace Faerie::Token
 	private:
 		[[nodiscard]] TArray<UFaerieItemToken*> BlueprintOnlyAccess(const TNotNull<const UFaerieItem*> Item) const
 		{
+			// Blueprint can mutate the tokens it gets from here, so they cannot be shared.
+			MaterializeSharedTokens(Item);
 			return Faerie::Utils::Cast<TArray<UFaerieItemToken*>>(Emit(Item));
 		}
 
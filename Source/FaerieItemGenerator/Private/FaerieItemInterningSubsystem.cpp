@@ -0,0 +1,98 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemInterningSubsystem.h"
+#include "FaerieItem.h"
+#include "FaerieItemStack.h"
+#include "UObject/UObjectGlobals.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieItemInterningSubsystem)
+
+using namespace Faerie;
+
+void UFaerieItemInterningSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ThisClass::PruneStaleItems);
+}
+
+void UFaerieItemInterningSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	InternedItems.Empty();
+
+	Super::Deinitialize();
+}
+
+const UFaerieItem* UFaerieItemInterningSubsystem::Intern(const UFaerieItem* Item)
+{
+	// Only runtime instances whose data cannot change are safe to share. Assets are already a single instance.
+	if (!IsValid(Item) ||
+		Item->IsDataMutable() ||
+		!Item->IsInstanceMutable())
+	{
+		return Item;
+	}
+
+	auto& Bucket = InternedItems.FindOrAdd(Item->GetContentHash());
+	for (const TWeakObjectPtr<const UFaerieItem>& Interned : Bucket)
+	{
+		const UFaerieItem* InternedItem = Interned.Get();
+		if (InternedItem == Item)
+		{
+			return Item;
+		}
+		if (IsValid(InternedItem) &&
+			InternedItem->CompareWith(Item, EFaerieItemComparisonFlags::CheckTokensOnly))
+		{
+			return InternedItem;
+		}
+	}
+
+	Bucket.Add(Item);
+	return Item;
+}
+
+void UFaerieItemInterningSubsystem::InternStacks(TArray<FFaerieItemStack>& Stacks)
+{
+	for (int32 i = 0; i < Stacks.Num(); ++i)
+	{
+		Stacks[i].Item = Intern(Stacks[i].Item);
+
+		// If an earlier stack has the same item, move our copies into it.
+		for (int32 j = 0; j < i; ++j)
+		{
+			if (Stacks[j].Item == Stacks[i].Item)
+			{
+				Stacks[j].Copies += Stacks[i].Copies;
+				Stacks.RemoveAt(i--);
+				break;
+			}
+		}
+	}
+}
+
+int32 UFaerieItemInterningSubsystem::GetNumInternedItems() const
+{
+	int32 Num = 0;
+	for (auto&& Bucket : InternedItems)
+	{
+		for (const TWeakObjectPtr<const UFaerieItem>& Interned : Bucket.Value)
+		{
+			Num += Interned.IsValid();
+		}
+	}
+	return Num;
+}
+
+void UFaerieItemInterningSubsystem::PruneStaleItems()
+{
+	for (auto It = InternedItems.CreateIterator(); It; ++It)
+	{
+		It.Value().RemoveAll([](const TWeakObjectPtr<const UFaerieItem>& Interned) { return !Interned.IsValid(); });
+		if (It.Value().IsEmpty())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
@@ -3,7 +3,18 @@
 
 #include "ItemCraftingRunner.h"
 #include "FaerieItemGenerationLog.h"
+#include "FaerieItemInterningSubsystem.h"
 #include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+
+namespace Faerie::Generation
+{
+	static bool InternImmutableItems = true;
+	static FAutoConsoleVariableRef CVarInternImmutableItems(
+		TEXT("fae.Generation.InternImmutableItems"),
+		InternImmutableItems,
+		TEXT("Replace immutable items output by crafting actions with a shared instance of any identical item."));
+}
 
 using namespace Faerie;
 
@@ -153,6 +164,17 @@ void UFaerieItemCraftingRunner::FinishActionImpl(FFaerieCraftingActionBase& Acti
 	}
 	else if (Result == EGenerationActionResult::Succeeded)
 	{
+		if (Generation::InternImmutableItems)
+		{
+			if (UWorld* World = GetWorld())
+			{
+				if (UFaerieItemInterningSubsystem* Interning = World->GetSubsystem<UFaerieItemInterningSubsystem>())
+				{
+					Interning->InternStacks(Action.ActionData.Stacks);
+				}
+			}
+		}
+
 		Action.OnCompletedCallback.ExecuteIfBound(Result, Action.ActionData);
 	}
 	else
@@ -1,6 +1,7 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "Upgrades/FaerieItemUpgradeConfig.h"
+#include "FaerieItemMutationBatch.h"
 #include "FaerieItemMutator.h"
 #include "ItemCraftingAction.h"
 
@@ -73,6 +74,9 @@ bool UFaerieItemUpgradeConfig::ApplyUpgrade(FFaerieCraftingActionData& Stacks, U
 	Context.Squirrel = Squirrel;
 	Context.Config = this;
 
+	// Mutators may edit many tokens per item, so notify owners once per item when done.
+	Faerie::Token::FScopedMutationBatch MutationBatch;
+
 	for (auto&& OperationStack : Stacks.Stacks)
 	{
 		if (OperationStack.Copies == 0)
@@ -0,0 +1,43 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "FaerieItemInterningSubsystem.generated.h"
+
+class UFaerieItem;
+struct FFaerieItemStack;
+
+/**
+ * Interns immutable runtime items by content, so that content-identical items share one instance. Shared instances
+ * use less memory, are fewer objects to replicate, and always stack with each other, even across containers.
+ * Only weak references are held, and references to destroyed items are cleaned up after each garbage collection.
+ */
+UCLASS()
+class FAERIEITEMGENERATOR_API UFaerieItemInterningSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Gets the interned instance of an item with the same content, or interns this item if there is none yet.
+	// Items that can be mutated are never interned, and are always returned as is.
+	const UFaerieItem* Intern(const UFaerieItem* Item);
+
+	// Interns the item in each stack, and merges stacks that end up sharing an item.
+	void InternStacks(TArray<FFaerieItemStack>& Stacks);
+
+	// Gets the number of live interned items.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|ItemInterning")
+	int32 GetNumInternedItems() const;
+
+private:
+	void PruneStaleItems();
+
+	// Interned items, by content hash. Items that collide on hash but differ in content share a bucket.
+	TMap<uint32, TArray<TWeakObjectPtr<const UFaerieItem>, TInlineAllocator<1>>> InternedItems;
+
+	FDelegateHandle PostGarbageCollectHandle;
+};
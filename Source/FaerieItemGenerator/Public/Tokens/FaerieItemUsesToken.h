@@ -53,6 +53,7 @@ public:
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	virtual bool IsMutable() const override { return true; }
+	virtual bool AllowsCopyOnWrite() const override { return true; }
 
 	int32 GetMaxUses() const { return MaxUses; }
 	int32 GetUsesRemaining() const { return UsesRemaining; }